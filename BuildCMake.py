@@ -15,6 +15,10 @@ class CMakeConfig(BT.CMake):
         super(CMakeConfig, self).__init__("GameZ")
         self.define["HLSLCC_DYNLIB"] = True
         self.define["COMPRESS_MESH_FILE"] = True
+        # scheduler histograms and tracing, see Engine/Core/Scheduler/Stats.h
+        self.define["Z_SCHED_STATS"] = False
+        # math backend 0 scalar, 1 sse, 2 avx, from the compiler flags when off. see Engine/Core/Math/Simd.h
+        self.define["Z_MATH_SIMD"] = False
         # custom
         self.qt5_option = {
             "enable": True,
@@ -112,6 +116,92 @@ class TestSched(BT.Module):
         self.DEPS = ["Engine"]
         self.vsfolder = "Test"
 
+class BenchSched(BT.Module):
+    def __init__(self):
+        super(BenchSched, self).__init__("BenchSched", BT.EXECUTABLE)
+        self.SOURCE = ["Test/BenchSched.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestSchedPriority(BT.Module):
+    def __init__(self):
+        super(TestSchedPriority, self).__init__("TestSchedPriority", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestSchedPriority.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestSchedStats(BT.Module):
+    def __init__(self):
+        super(TestSchedStats, self).__init__("TestSchedStats", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestSchedStats.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class BenchSchedSuite(BT.Module):
+    def __init__(self):
+        super(BenchSchedSuite, self).__init__("BenchSchedSuite", BT.EXECUTABLE)
+        self.SOURCE = ["Test/BenchSchedSuite.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestTopology(BT.Module):
+    def __init__(self):
+        super(TestTopology, self).__init__("TestTopology", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestTopology.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestFuture(BT.Module):
+    def __init__(self):
+        super(TestFuture, self).__init__("TestFuture", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestFuture.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestTaskGraph(BT.Module):
+    def __init__(self):
+        super(TestTaskGraph, self).__init__("TestTaskGraph", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestTaskGraph.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestParallel(BT.Module):
+    def __init__(self):
+        super(TestParallel, self).__init__("TestParallel", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestParallel.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestMath(BT.Module):
+    def __init__(self):
+        super(TestMath, self).__init__("TestMath", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestMath.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class BenchMath(BT.Module):
+    def __init__(self):
+        super(BenchMath, self).__init__("BenchMath", BT.EXECUTABLE)
+        self.SOURCE = ["Test/BenchMath.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class BenchMathSuite(BT.Module):
+    def __init__(self):
+        super(BenchMathSuite, self).__init__("BenchMathSuite", BT.EXECUTABLE)
+        self.SOURCE = ["Test/BenchMathSuite.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+
+class TestCo(BT.Module):
+    def __init__(self):
+        super(TestCo, self).__init__("TestCo", BT.EXECUTABLE)
+        self.SOURCE = ["Test/TestCo.cc"]
+        self.DEPS = ["Engine"]
+        self.vsfolder = "Test"
+        # coroutines, engine itself stays c++17
+        self.cxx_standard = 20
+
 
  
 
@@ -135,6 +225,18 @@ build_targets = [
     BuildTool(),
     # Tests
     TestSched(),
+    BenchSched(),
+    TestCo(),
+    TestSchedPriority(),
+    TestSchedStats(),
+    BenchSchedSuite(),
+    TestTopology(),
+    TestFuture(),
+    TestTaskGraph(),
+    TestParallel(),
+    TestMath(),
+    BenchMath(),
+    BenchMathSuite(),
 
 ]
 
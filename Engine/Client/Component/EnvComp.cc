@@ -30,7 +30,7 @@ void EnvComp::SetSky(std::string shader, std::string texPath) {
 	Image* img = Image::Load(texPath);
 	RHITexture* tex = GDevice->CreateTexture2D(img->GetFormat(), img->GetWidth(), img->GetHeight(), 1, img->GetData());
 	mSkyItem->Material->SetParameter("tSkyTexture", tex);
-	mSkyItem->WorldMatrix = math::Matrix4F::Identity;
+	mSkyItem->WorldMatrix = math::Affine3x4::Identity;
 }
 
 
@@ -1,6 +1,7 @@
 #include "PrimitiveComp.h"
 #include <Client/Entity/IEntity.h>
 #include <Client/Main/App.h>
+#include <Client/Main/Director.h>
 #include <Util/Luaconf/Luaconf.h>
 #include <Util/Mesh/ZMeshLoader.h>
 #include <Util/Mesh/MeshGenerator.h>
@@ -14,7 +15,9 @@ namespace z {
 namespace lc = luaconf;
 
 PrimitiveComp::PrimitiveComp() :
-	mIsDrawBoundBox(true)
+	mIsDrawBoundBox(true),
+	mPickTriangles{},
+	mPickTriangleNum(0)
 {
 }
 
@@ -64,6 +67,7 @@ bool PrimitiveComp::LoadFromFile(std::string file) {
 
 
 	UpdateBoundBox();
+	CreateBoundBoxItem();
 	return true;
 }
 
@@ -127,42 +131,101 @@ void PrimitiveComp::CollectRender(SceneCollection* collection) {
 	}
 
 	// draw bound box
-	if (mIsDrawBoundBox) {
-		if (mBoundBoxRenderItem == nullptr) {
-			mBoundBoxRenderItem = new RenderItem();
-			mBoundBoxRenderItem->RenderSet = RENDER_SET_EDITOR;
-			mBoundBoxRenderItem->Material = MaterialManager::GetMaterialInstance("EditorAxis");
-			mBoundBoxRenderItem->Material->SetFillMode(RS_FILL_WIREFRAME);
-			mBoundBoxRenderItem->Material->SetCullMode(RS_CULL_NONE);
-			mBoundBoxRenderItem->Material->SetParameter("Color", math::Vector3F(1.0f, 1.0f, 0.0f).value, 3);
-			math::Vector3F range = mBoundBox.MaxP - mBoundBox.MinP;
-			mBoundBoxRenderItem->Mesh = MeshGenerator::CreateBox(range.x, range.y, range.z, 0);
-			mBoundBoxRenderItem->SetMeshIndexGroup(0);
-			mBoundBoxRenderItem->WorldMatrix = math::Matrix4F::Identity;
-		}
+	if (mIsDrawBoundBox && mBoundBoxRenderItem) {
 		// offset
 		math::Vector3F range = mBoundBox.MaxP - mBoundBox.MinP;
 		range = range / 2.f + mBoundBox.MinP;
-		mBoundBoxRenderItem->WorldMatrix = math::MatrixTransform(range) * mOwner->GetWorldTransform();
+		mBoundBoxRenderItem->WorldMatrix = math::Affine3x4(math::MatrixTransform(range)) * mOwner->GetWorldTransform();
 		collection->PushRenderItem(mBoundBoxRenderItem);
 
 	}
 
 }
 
+math::Box PrimitiveComp::GetWorldBoundBox() {
+	if (mBoundBox.MinP.x > mBoundBox.MaxP.x) {
+		return mBoundBox;
+	}
+	return math::TransformBox(mOwner->GetWorldTransform(), mBoundBox);
+}
+
 void PrimitiveComp::UpdateBoundBox() {
 	uint32_t count = mRenderMesh->GetVertexCount();
-	math::Vector3F pos;
-	for (uint32_t i = 0; i < count; i++) {
-		mRenderMesh->GetVertex(SEMANTIC_POSITION, i, pos);
-		mBoundBox.Union(pos);
-
-	}
+	RenderMesh* mesh = mRenderMesh;
+	math::Box box = sched::ParallelReduce(GDirector->GetParallelScheduler(), 0, count, math::Box(),
+		[mesh](size_t begin, size_t end, math::Box box) {
+			// positions gathered to soa blocks, bounded a simd width at a time
+			const size_t block = 256;
+			float x[block], y[block], z[block];
+			math::SoAVector3F soa{ x, y, z };
+			for (size_t i = begin; i < end; i += block) {
+				uint32_t num = (uint32_t)std::min(block, end - i);
+				mesh->GetVertices(SEMANTIC_POSITION, (uint32_t)i, num, soa);
+				math::ComputeBounds(soa, num, box);
+			}
+			return box;
+		},
+		[](math::Box a, const math::Box& b) {
+			a.Union(b);
+			return a;
+		});
+	mBoundBox.Union(box);
 	Log<LWARN>() << mBoundBox;
 }
 
+// made at load rather than on first collect, collect may run on a worker
+// while the last frame renders (see Director::SetPipelined)
+void PrimitiveComp::CreateBoundBoxItem() {
+	mBoundBoxRenderItem = new RenderItem();
+	mBoundBoxRenderItem->RenderSet = RENDER_SET_EDITOR;
+	mBoundBoxRenderItem->Material = MaterialManager::GetMaterialInstance("EditorAxis");
+	mBoundBoxRenderItem->Material->SetFillMode(RS_FILL_WIREFRAME);
+	mBoundBoxRenderItem->Material->SetCullMode(RS_CULL_NONE);
+	mBoundBoxRenderItem->Material->SetParameter("Color", math::Vector3F(1.0f, 1.0f, 0.0f).value, 3);
+	math::Vector3F range = mBoundBox.MaxP - mBoundBox.MinP;
+	mBoundBoxRenderItem->Mesh = MeshGenerator::CreateBox(range.x, range.y, range.z, 0);
+	mBoundBoxRenderItem->SetMeshIndexGroup(0);
+	mBoundBoxRenderItem->WorldMatrix = math::Affine3x4::Identity;
+}
+
 bool PrimitiveComp::IsIntersectRay(const math::Vector3F& rayStart, const math::Vector3F& rayDir) {
-	return true;
+	float t = math::K_MAXFLOAT;
+	return IntersectRay(math::Ray(rayStart, rayDir), t);
+}
+
+bool PrimitiveComp::IntersectRay(const math::Ray& ray, float& t) {
+	float boxT = t;
+	if (mRenderMesh == nullptr || !math::IntersectBox(ray, mBoundBox, boxT)) {
+		return false;
+	}
+	if (mPickData.empty()) {
+		UpdatePickTriangles();
+	}
+	size_t index;
+	return math::IntersectTriangles(ray, mPickTriangles, mPickTriangleNum, t, index);
+}
+
+void PrimitiveComp::UpdatePickTriangles() {
+	// every index group drawn from vertex group 0, as the render items do
+	mPickTriangleNum = 0;
+	for (uint32_t i = 0; i < mRenderMesh->GetIndexGroupNum(); i++) {
+		mPickTriangleNum += mRenderMesh->GetIndexCount(i) / 3;
+	}
+	size_t num = mPickTriangleNum;
+	// one more, so meshes without triangles aren't gathered again each pick
+	mPickData.resize(num * 9 + 1);
+	float* data = mPickData.data();
+	auto soa = [data, num](size_t first) {
+		return math::SoAVector3F{ data + first * num, data + (first + 1) * num, data + (first + 2) * num };
+	};
+	mPickTriangles = math::SoATriangleF{ soa(0), soa(3), soa(6) };
+
+	size_t first = 0;
+	for (uint32_t i = 0; i < mRenderMesh->GetIndexGroupNum(); i++) {
+		uint32_t groupNum = mRenderMesh->GetIndexCount(i) / 3;
+		mRenderMesh->GetTriangles(i, 0, 0, groupNum, mPickTriangles.Offset(first));
+		first += groupNum;
+	}
 }
 
 
@@ -23,6 +23,11 @@ public:
 	RHITexture* LoadTextureFile(std::string file);
 
 	bool IsIntersectRay(const math::Vector3F& rayStart, const math::Vector3F& rayDir);
+	// nearest hit of a ray in mesh space nearer than t, sets t
+	bool IntersectRay(const math::Ray& ray, float& t);
+
+	// bound box in world space, empty when there is no mesh
+	math::Box GetWorldBoundBox();
 
 	void CollectRender(SceneCollection*) override;
 
@@ -33,6 +38,13 @@ private:
 	RefCountPtr<RenderItem> mBoundBoxRenderItem;
 
 	void UpdateBoundBox();
+	void CreateBoundBoxItem();
+
+	// triangles for picking, gathered on the first pick
+	std::vector<float> mPickData;
+	math::SoATriangleF mPickTriangles;
+	size_t mPickTriangleNum;
+	void UpdatePickTriangles();
 
 
 	RefCountPtr<RenderMesh> mRenderMesh;
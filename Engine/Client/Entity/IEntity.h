@@ -15,7 +15,7 @@ public:
 	}
 
 	// transform opertion
-	void SetLocalTransform(const math::Matrix4F& transform) {
+	void SetLocalTransform(const math::Affine3x4& transform) {
 		mLocalTransform.SetTransform(transform);
 	}
 
@@ -31,7 +31,7 @@ public:
 		mLocalTransform.SetRotator(rotator);
 	}
 
-	math::Matrix4F GetLocalTransform() {
+	math::Affine3x4 GetLocalTransform() {
 		return mLocalTransform.GetTransform();
 	}
 
@@ -47,7 +47,7 @@ public:
 		return mLocalTransform.GetScale();
 	}
 
-	math::Matrix4F GetWorldTransform() {
+	math::Affine3x4 GetWorldTransform() {
 		// use local transoform now
 		return mLocalTransform.GetTransform();
 
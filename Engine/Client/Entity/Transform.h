@@ -18,35 +18,46 @@ class Transform {
 public:
 	Transform() : 
 		mPosition(math::Vector3F::Zero), 
-		mScale(math::Vector3F::Identity),
-		mRotation(math::Matrix4F::Identity) {
+		mScale(math::Vector3F::Identity) {
 	}
 
-	void SetTransform(const math::Matrix4F& t) {
+	// t has to be rotation * scale + translation, no shear
+	void SetTransform(const math::Affine3x4& t) {
 		mPosition = { t[0][3], t[1][3], t[2][3] };
 		mScale = {
 			math::GetLength(math::Vector3F(t[0][0], t[1][0], t[2][0])),
-			math::GetLength(math::Vector3F(t[0][0], t[1][0], t[2][0])),
-			math::GetLength(math::Vector3F(t[0][0], t[1][0], t[2][0])),
+			math::GetLength(math::Vector3F(t[0][1], t[1][1], t[2][1])),
+			math::GetLength(math::Vector3F(t[0][2], t[1][2], t[2][2])),
 		};
-		mRotation = {
+		math::Matrix4F rotation = {
 			{math::Vector3F{t[0][0], t[0][1], t[0][2]} / mScale, 0},
 			{math::Vector3F{t[1][0], t[1][1], t[1][2]} / mScale, 0},
 			{math::Vector3F{t[2][0], t[2][1], t[2][2]} / mScale, 0},
 			{0, 0, 0, 1}
 		};
-
+		mRotation = math::Quaternion::FromMatrix(rotation);
 	}
 
-	math::Matrix4F GetTransform() {
-		return math::Matrix4F{
-			{ math::Vector3F(mRotation[0]) * mScale, mPosition.x },
-			{ math::Vector3F(mRotation[1]) * mScale, mPosition.y },
-			{ math::Vector3F(mRotation[2]) * mScale, mPosition.z },
-			{ 0, 0, 0, 1}
+	math::Affine3x4 GetTransform() const {
+		math::Matrix4F r = mRotation.ToMatrix();
+		return math::Affine3x4{
+			{ math::Vector3F(r[0]) * mScale, mPosition.x },
+			{ math::Vector3F(r[1]) * mScale, mPosition.y },
+			{ math::Vector3F(r[2]) * mScale, mPosition.z }
 		};
 	}
 
+	/* this, then parent: the world transform of a child. exact with uniform
+	   parent scale, a non uniform one on a rotated child would need shear
+	*/
+	Transform operator* (const Transform& parent) const {
+		Transform r;
+		r.mScale = mScale * parent.mScale;
+		r.mRotation = mRotation * parent.mRotation;
+		r.mPosition = parent.mRotation.Rotate(mPosition * parent.mScale) + parent.mPosition;
+		return r;
+	}
+
 	void SetPostion(const math::Vector3F& pos) {
 		mPosition = pos;
 	}
@@ -56,36 +67,34 @@ public:
 	}
 
 	void SetRotator(math::Vector3F rotator) {
-		mRotation = math::Matrix4F::Identity;
-		mRotation = mRotation * math::MatrixRotationY(rotator.y) * math::MatrixRotationX(rotator.x) * math::MatrixRotationZ(rotator.z);
+		mRotation = math::Quaternion::FromRotator(rotator);
 	}
 
-	math::Vector3F GetPosition() {
+	void SetRotation(const math::Quaternion& rotation) {
+		mRotation = rotation;
+	}
+
+	math::Vector3F GetPosition() const {
 		return mPosition;
 	}
 
-	math::Vector3F GetRotator() {
-		math::Vector3F euler;
-		euler.x = std::asinf(mRotation[2][1]);
-		if (std::cosf(euler.x) > 0.0001) {
-			euler.y = -std::atan2f(mRotation[2][0], mRotation[2][2]);
-			euler.z = -std::atan2f(mRotation[0][1], mRotation[1][1]);
-		} else {
-			// when x = 90 degree, rotar y is loss, just set to zero 
-			euler.y = 0.0f;
-			euler.z = std::atan2f(mRotation[1][0], mRotation[0][0]);
-		}
-		return euler;
+	math::Vector3F GetRotator() const {
+		return mRotation.ToRotator();
+	}
+
+	math::Quaternion GetRotation() const {
+		return mRotation;
 	}
 
-	math::Vector3F GetScale() {
+	math::Vector3F GetScale() const {
 		return mScale;
 	}
 
 private:
+	// 40 bytes
 	math::Vector3F mPosition;
+	math::Quaternion mRotation;
 	math::Vector3F mScale;
-	math::Matrix4F mRotation;
 };
 
 }
\ No newline at end of file
@@ -34,6 +34,15 @@ public:
 		mEnableEditorUI = enable;
 	}
 
+	// pipelined frames (see Director::SetPipelined), set before Init
+	bool IsFramePipelined() {
+		return mFramePipelined;
+	}
+
+	void SetFramePipelined(bool pipelined) {
+		mFramePipelined = pipelined;
+	}
+
     EditorUI* GetUIManager() {
 		return &mUI;
 	}
@@ -52,6 +61,7 @@ protected:
 
 	FilePath mRootPath;
 	bool mEnableEditorUI;
+	bool mFramePipelined{ false };
 
     EditorUI mUI;
 };
@@ -5,21 +5,34 @@
 #include <Client/Scene/Camera.h>
 #include <Client/Editor/CameraController.h>
 #include <thread>
-#include <chrono> 
+#include <chrono>
+#include <algorithm>
 
 namespace z {
 Director* GDirector = nullptr;
 
 Director::Director() {
 	InitializeSingleton<Director>(GDirector, this);
+	// main thread helps while it waits for the frame, so one less worker.
+	// before the scene, loading runs parallel loops
+	int workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	mWorker.reset(new sched::ThreadWorker(workers, sched::SERVICE_WORK_STEALING));
+	mWorker->Run();
+	mParallel.reset(new sched::ParallelScheduler(mWorker.get()));
+
 	// size will changed when on resize called later
 	mRenderer = new Renderer();
 
 	LoadScene(GApp->GetContentPath() / "Test/Scene/test.scene");
 	SetCameraController(new CameraController());
+	mPipelined = GApp->IsFramePipelined();
+	BuildFrameGraph();
 }
 
 Director::~Director() {
+	mFrameGraph.reset();
+	mParallel.reset();
+	mWorker.reset();
 	FinalizeSingleton<Director>(GDirector, this);
 }
 
@@ -34,21 +47,63 @@ void Director::LoadScene(const std::string& scnFile) {
 }
 
 
+void Director::SetPipelined(bool pipelined) {
+	if (mPipelined != pipelined) {
+		mPipelined = pipelined;
+		BuildFrameGraph();
+	}
+}
+
+void Director::BuildFrameGraph() {
+	mFrameGraph.reset(new sched::TaskGraph(mWorker.get(), sched::PRIORITY_CRITICAL));
+	mFrameGraph->SetName("frame");
+
+	/* input --> camera --> collect --> render
+	         \-> scene  -/
+	   input and render stay on the main thread: window events, the device and ui.
+	   pipelined, render draws the last frame's collection and has no inputs, it
+	   overlaps simulating this frame, collect runs on a worker then
+	*/
+	sched::TaskNodeId input = mFrameGraph->AddNode("input", []() {
+		GInput->Dispatch();
+	}, true);
+	sched::TaskNodeId camera = mFrameGraph->AddNode("camera", [this]() {
+		mCameraController->Apply();
+	});
+	sched::TaskNodeId scene = mFrameGraph->AddNode("scene", [this]() {
+		mCurScene->Tick();
+	});
+	sched::TaskNodeId collect = mFrameGraph->AddNode("collect", [this]() {
+		mRenderer->Tick();
+		if (!mPipelined) {
+			mRenderer->SwapCollection();
+		}
+	}, !mPipelined);
+	sched::TaskNodeId render = mFrameGraph->AddNode("render", [this]() {
+		mRenderer->Render();
+	}, true);
+
+	mFrameGraph->AddEdge(input, camera);
+	mFrameGraph->AddEdge(input, scene);
+	mFrameGraph->AddEdge(camera, collect);
+	mFrameGraph->AddEdge(scene, collect);
+	if (!mPipelined) {
+		mFrameGraph->AddEdge(collect, render);
+	}
+	CHECK(mFrameGraph->Build(), "Frame graph has a cycle.");
+}
+
 void Director::FrameTick() {
 	// begin
 	BeginFrame();
-	// handle input
-	GInput->Dispatch();
-	// object tick
-	mCameraController->Apply();
-	mCurScene->Tick();
-
-	// render tick
-	mRenderer->Tick();
-	mRenderer->Render();
-
+	// input, object tick, render tick
+	mFrameGraph->Run();
+	// hand this frame's collection to the next render
+	if (mPipelined) {
+		mRenderer->SwapCollection();
+	}
 	// end
-	EndFrame();;
+	EndFrame();
 }
 
 void Director::Update() {
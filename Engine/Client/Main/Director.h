@@ -3,6 +3,8 @@
 #include <Core/CoreHeader.h>
 #include <Render/Renderer.h>
 #include <Client/Scene/Camera.h>
+#include <Core/Scheduler/TaskGraph.h>
+#include <Core/Scheduler/Parallel.h>
 
 
 namespace z {
@@ -65,7 +67,30 @@ public:
 		return mFrameTime;
 	}
 
+	// engine worker pool
+	sched::Worker* GetWorker() {
+		return mWorker.get();
+	}
+
+	/* pipelined: frame N+1 simulates and collects on workers while the main
+		thread renders frame N, one frame more latency. off by default, starts
+		as App::IsFramePipelined (-pipelined on the game's command line)
+	*/
+	void SetPipelined(bool pipelined);
+
+	bool IsPipelined() const {
+		return mPipelined;
+	}
+
+	// for sched::ParallelFor and friends
+	sched::ParallelScheduler& GetParallelScheduler() {
+		return *mParallel;
+	}
+
 private:
+	// frame steps as a task graph, independent steps overlap on workers
+	void BuildFrameGraph();
+
 	uint64_t mFrameInterval{ 0 };
 	float mFrameTime{ 0 };
 	
@@ -78,7 +103,14 @@ private:
 	RefCountPtr<CameraController> mCameraController;
 
 	RHIStats mRHIStats;
-	
+
+	bool mPipelined{ false };
+
+	// queues go first, they belong to the worker's service
+	std::unique_ptr<sched::ThreadWorker> mWorker;
+	std::unique_ptr<sched::ParallelScheduler> mParallel;
+	std::unique_ptr<sched::TaskGraph> mFrameGraph;
+
 };
 
 extern Director* GDirector;
@@ -16,6 +16,17 @@
 
 namespace z {
 
+namespace {
+
+// editor axis cylinders, folded at compile time
+constexpr math::Affine3x4 K_AXIS_ROTATIONS[3] = {
+	math::Affine3x4(math::MatrixRotationAxis(math::Vector3F(0, 0, 1), math::ToRadian(270.f))),
+	math::Affine3x4(math::MatrixRotationAxis(math::Vector3F(0, 1, 0), math::ToRadian(180.f))),
+	math::Affine3x4(math::MatrixRotationAxis(math::Vector3F(1, 0, 0), math::ToRadian(90.f))),
+};
+
+}
+
 
 Scene::Scene() {
 	mIsEditor = true;
@@ -36,7 +47,7 @@ bool Scene::Load(const std::string file) {
 		item->Material->SetFillMode(RS_FILL_WIREFRAME);
 		item->Mesh = mesh;
 		item->SetMeshIndexGroup(0);
-		item->WorldMatrix = math::Matrix4F::Identity;
+		item->WorldMatrix = math::Affine3x4::Identity;
 		mEditorItems.push_back(item);
 
 		// xyz axis
@@ -49,10 +60,9 @@ bool Scene::Load(const std::string file) {
 			//item->material->SetFillMode(RS_FILL_WIREFRAME);
 			item->Mesh = mesh;
 			item->SetMeshIndexGroup(0);
-			item->WorldMatrix = math::Matrix4F::Identity;
+			item->WorldMatrix = math::Affine3x4::Identity;
 
-			math::Matrix4F rotation = math::MatrixRotationAxis(math::Vector3F(i==2, i==1, i==0), math::ToRadian(90.f * (3 - i)));
-			item->WorldMatrix = item->WorldMatrix * rotation;
+			item->WorldMatrix = item->WorldMatrix * K_AXIS_ROTATIONS[i];
 			
 			mEditorItems.push_back(item);
 		}
@@ -137,31 +147,53 @@ void Scene::CollectRender(SceneCollection* collection) {
 		collection->PushRenderItem(item);
 	}
 
-	// primitives
+	// primitives, culled by their world bound boxes
+	std::vector<PrimitiveComp*> prims;
 	for (IEntity* ent : mEntities) {
-		std::vector<PrimitiveComp*> prims = ent->GetComponents<PrimitiveComp>();
-		for (auto prim : prims) {
-			prim->CollectRender(collection);
+		std::vector<PrimitiveComp*> entPrims = ent->GetComponents<PrimitiveComp>();
+		prims.insert(prims.end(), entPrims.begin(), entPrims.end());
+	}
+	size_t num = prims.size();
+	if (num == 0) {
+		return;
+	}
+	std::vector<float> bounds(num * 6);
+	math::SoABoxF boxes{
+		{ &bounds[0], &bounds[num], &bounds[num * 2] },
+		{ &bounds[num * 3], &bounds[num * 4], &bounds[num * 5] }
+	};
+	for (size_t i = 0; i < num; i++) {
+		boxes.Set(i, prims[i]->GetWorldBoundBox());
+	}
+	std::vector<uint32_t> visible(math::GetMaskWords(num));
+	math::Frustum frustum(mCamera->GetCam()->GetViewProjectMatrix());
+	math::CullBoxes(frustum, boxes, num, visible.data());
+	for (size_t i = 0; i < num; i++) {
+		if (math::IsMaskSet(visible.data(), i)) {
+			prims[i]->CollectRender(collection);
 		}
 	}
-
 }
 
 IEntity* Scene::Pick(const math::Vector3F& rayStart, const math::Vector3F& rayDir) {
+    IEntity* picked = nullptr;
+    float t = math::K_MAXFLOAT;
     for (IEntity* ent : mEntities) {
         if (!ent->IsPickable())
             continue;
 
-        // convert to local ray
-
-
+        // convert to local ray, t keeps its meaning as the direction isn't normalized
+        math::Affine3x4 inv = ent->GetWorldTransform().GetInverse();
+        math::Ray ray(inv.TransformPoint(rayStart), inv.TransformNormal(rayDir));
 
         std::vector<PrimitiveComp*> prims = ent->GetComponents<PrimitiveComp>();
         for (auto prim : prims) {
-            //if (prim->IsIntersectRay)
-
+            if (prim->IntersectRay(ray, t)) {
+                picked = ent;
+            }
         }
     }
+    return picked;
 }
 
 
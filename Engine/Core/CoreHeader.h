@@ -31,5 +31,12 @@
 #include <Core/Math/Geometry.h>
 #include <Core/Math/Matrix.h>
 #include <Core/Math/LinearAlg.h>
+#include <Core/Math/Quaternion.h>
 #include <Core/Math/Camera.h>
 #include <Core/Math/Number.h>
+#include <Core/Math/Batch.h>
+#include <Core/Math/Affine.h>
+#include <Core/Math/FastMath.h>
+#include <Core/Math/Frustum.h>
+#include <Core/Math/GeometryAlg.h>
+#include <Core/Math/Packing.h>
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <type_traits>
+
+#include "Vector.h"
+#include "Matrix.h"
+#include "Number.h"
+#include "Batch.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+World transforms: the rows x, y and z of a Matrix4F whose w row is always
+(0, 0, 0, 1), the rotation and scale in the first three columns and the
+translation in the last. 48 bytes instead of 64, products skip the w row.
+a * b applies a first and sums in the order Matrix4F does, equal up to
+rounding (see Simd.h). ToMatrix4 only appends the w row, for the shader upload.
+
+the simd backend does the product and the inverse, the *Scalar functions are
+the plain code. constexpr like Matrix4F, the inverse runtime only
+*/
+template<typename T>
+class alignas(16) TAffine3x4 {
+	using TVector = TVector4<T>;
+public:
+	// ctor
+	constexpr TAffine3x4() : x(0), y(0), z(0) {}
+	constexpr TAffine3x4(TVector _x, TVector _y, TVector _z) : x(_x), y(_y), z(_z) {}
+	constexpr TAffine3x4(const TAffine3x4& m) = default;
+	// m's w row has to be (0, 0, 0, 1)
+	constexpr explicit TAffine3x4(const TMatrix4<T>& m) : x(m.x), y(m.y), z(m.z) {}
+
+	// operator
+	constexpr TAffine3x4 operator* (const TAffine3x4& m2) const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			if (!Z_MATH_CONSTANT_EVALUATED()) {
+				TAffine3x4 r;
+				simd::AffineMul(&m00, &m2.m00, &r.m00);
+				return r;
+			}
+		}
+#endif
+		return MulScalar(m2);
+	}
+
+	constexpr TAffine3x4& operator *= (const TAffine3x4& m2) { *this = *this * m2; return *this; }
+
+	// row i of the result is the rows of this weighted by row i of m2
+	constexpr TAffine3x4 MulScalar(const TAffine3x4& m2) const {
+		return TAffine3x4(CombineRows(m2.x), CombineRows(m2.y), CombineRows(m2.z));
+	}
+
+	/* the 3x3 must have orthogonal columns, any rotation * scale * translation
+	   (see Transform). sheared ones need ToMatrix4().GetInverse()
+	*/
+	TAffine3x4 GetInverse() const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			TAffine3x4 r;
+			simd::AffineInverse(&m00, &r.m00);
+			return r;
+		} else
+#endif
+		{
+			return GetInverseScalar();
+		}
+	}
+
+	TAffine3x4 GetInverseScalar() const {
+		// 1 / squared length of each column
+		T i0 = T(1) / ((x.x * x.x + y.x * y.x) + z.x * z.x);
+		T i1 = T(1) / ((x.y * x.y + y.y * y.y) + z.y * z.y);
+		T i2 = T(1) / ((x.z * x.z + y.z * y.z) + z.z * z.z);
+		TVector3<T> r0(x.x * i0, y.x * i0, z.x * i0);
+		TVector3<T> r1(x.y * i1, y.y * i1, z.y * i1);
+		TVector3<T> r2(x.z * i2, y.z * i2, z.z * i2);
+		return TAffine3x4(
+			TVector(r0, -((r0.x * x.w + r0.y * y.w) + r0.z * z.w)),
+			TVector(r1, -((r1.x * x.w + r1.y * y.w) + r1.z * z.w)),
+			TVector(r2, -((r2.x * x.w + r2.y * y.w) + r2.z * z.w)));
+	}
+
+	// summed as TransformPoints does
+	constexpr TVector3<T> TransformPoint(const TVector3<T>& p) const {
+		return TVector3<T>(
+			((x.x * p.x + x.y * p.y) + x.z * p.z) + x.w,
+			((y.x * p.x + y.y * p.y) + y.z * p.z) + y.w,
+			((z.x * p.x + z.y * p.y) + z.z * p.z) + z.w);
+	}
+
+	// directions, not normalized
+	constexpr TVector3<T> TransformNormal(const TVector3<T>& n) const {
+		return TVector3<T>(
+			(x.x * n.x + x.y * n.y) + x.z * n.z,
+			(y.x * n.x + y.y * n.y) + y.z * n.z,
+			(z.x * n.x + z.y * n.y) + z.z * n.z);
+	}
+
+	constexpr TMatrix4<T> ToMatrix4() const {
+		return TMatrix4<T>(x, y, z, TVector(0, 0, 0, 1));
+	}
+
+	TVector& operator [](int idx) { return m[idx]; }
+	const TVector operator [](int idx) const { return m[idx]; }
+
+	friend std::ostream& operator<<(std::ostream& out, const TAffine3x4& v) {
+		out << "(" << v.x << ", " << v.y << ", " << v.z << ")";
+		return out;
+	}
+
+	// data
+	union {
+		struct { TVector x, y, z; };
+		struct { T m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23; };
+		TVector m[3];
+	};
+
+	const static TAffine3x4 Identity;
+
+private:
+	// implied w row (0, 0, 0, 1) included, so sums are the ones of Matrix4F
+	constexpr TVector CombineRows(const TVector& c) const {
+		return x * c.x + y * c.y + z * c.z + TVector(0, 0, 0, 1) * c.w;
+	}
+};
+
+
+template<typename T> constexpr TAffine3x4<T> TAffine3x4<T>::Identity(TVector4<T>(1, 0, 0, 0), TVector4<T>(0, 1, 0, 0), TVector4<T>(0, 0, 1, 0));
+
+typedef TAffine3x4<float> Affine3x4;
+
+static_assert(sizeof(Affine3x4) == 48, "Affine3x4 layout");
+
+
+inline Box TransformBox(const Affine3x4& m, const Box& box) {
+	return TransformBox(m.ToMatrix4(), box);
+}
+
+}
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "Matrix.h"
+#include "Geometry.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+Batch kernels over structures of arrays: x, y and z of N items each in their
+own float array. the simd backend (Simd.h) does 8 items (avx) or 4 (sse) per
+step, the tail and the scalar backend run the *Scalar versions. both do the
+same operations in the same order, equal up to rounding (see Simd.h).
+
+arrays need no alignment, an output may be its input. the kernels are
+serial, split big batches with ParallelFor.
+
+matrices are used as TMatrix4 does, p' = m * p: row i dotted with (x, y, z, 1)
+*/
+struct SoAVector3F {
+	float* X;
+	float* Y;
+	float* Z;
+
+	Vector3F Get(size_t i) const { return Vector3F(X[i], Y[i], Z[i]); }
+	void Set(size_t i, const Vector3F& v) { X[i] = v.x, Y[i] = v.y, Z[i] = v.z; }
+	// view of the items from n on
+	SoAVector3F Offset(size_t n) const { return SoAVector3F{ X + n, Y + n, Z + n }; }
+};
+
+struct SoABoxF {
+	SoAVector3F Min;
+	SoAVector3F Max;
+
+	Box Get(size_t i) const {
+		Box b;
+		b.MinP = Min.Get(i);
+		b.MaxP = Max.Get(i);
+		return b;
+	}
+	void Set(size_t i, const Box& b) { Min.Set(i, b.MinP), Max.Set(i, b.MaxP); }
+	SoABoxF Offset(size_t n) const { return SoABoxF{ Min.Offset(n), Max.Offset(n) }; }
+};
+
+
+// points, w = 1 and the result's w dropped (affine m)
+inline void TransformPointsScalar(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		float x = in.X[i], y = in.Y[i], z = in.Z[i];
+		out.X[i] = ((m.m00 * x + m.m01 * y) + m.m02 * z) + m.m03;
+		out.Y[i] = ((m.m10 * x + m.m11 * y) + m.m12 * z) + m.m13;
+		out.Z[i] = ((m.m20 * x + m.m21 * y) + m.m22 * z) + m.m23;
+	}
+}
+
+/* directions by the upper 3x3 of m, not normalized. for normals under a non
+   uniform scale pass the inverse transpose of the world matrix
+*/
+inline void TransformNormalsScalar(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		float x = in.X[i], y = in.Y[i], z = in.Z[i];
+		out.X[i] = (m.m00 * x + m.m01 * y) + m.m02 * z;
+		out.Y[i] = (m.m10 * x + m.m11 * y) + m.m12 * z;
+		out.Z[i] = (m.m20 * x + m.m21 * y) + m.m22 * z;
+	}
+}
+
+// unioned into box, so chunks can be chained
+inline void ComputeBoundsScalar(SoAVector3F in, size_t num, Box& box) {
+	for (size_t i = 0; i < num; i++) {
+		box.MinP.x = std::min(in.X[i], box.MinP.x);
+		box.MinP.y = std::min(in.Y[i], box.MinP.y);
+		box.MinP.z = std::min(in.Z[i], box.MinP.z);
+		box.MaxP.x = std::max(in.X[i], box.MaxP.x);
+		box.MaxP.y = std::max(in.Y[i], box.MaxP.y);
+		box.MaxP.z = std::max(in.Z[i], box.MaxP.z);
+	}
+}
+
+/* boxes that bound the transformed boxes (arvo), by center and extent:
+   center' = m * center, extent' = abs(m) * extent. boxes must not be empty
+*/
+inline void TransformBoxesScalar(const Matrix4F& m, SoABoxF in, SoABoxF out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		float cx = (in.Min.X[i] + in.Max.X[i]) * 0.5f;
+		float cy = (in.Min.Y[i] + in.Max.Y[i]) * 0.5f;
+		float cz = (in.Min.Z[i] + in.Max.Z[i]) * 0.5f;
+		float ex = (in.Max.X[i] - in.Min.X[i]) * 0.5f;
+		float ey = (in.Max.Y[i] - in.Min.Y[i]) * 0.5f;
+		float ez = (in.Max.Z[i] - in.Min.Z[i]) * 0.5f;
+
+		float nx = ((m.m00 * cx + m.m01 * cy) + m.m02 * cz) + m.m03;
+		float ny = ((m.m10 * cx + m.m11 * cy) + m.m12 * cz) + m.m13;
+		float nz = ((m.m20 * cx + m.m21 * cy) + m.m22 * cz) + m.m23;
+		float fx = (std::abs(m.m00) * ex + std::abs(m.m01) * ey) + std::abs(m.m02) * ez;
+		float fy = (std::abs(m.m10) * ex + std::abs(m.m11) * ey) + std::abs(m.m12) * ez;
+		float fz = (std::abs(m.m20) * ex + std::abs(m.m21) * ey) + std::abs(m.m22) * ez;
+
+		out.Min.X[i] = nx - fx, out.Min.Y[i] = ny - fy, out.Min.Z[i] = nz - fz;
+		out.Max.X[i] = nx + fx, out.Max.Y[i] = ny + fy, out.Max.Z[i] = nz + fz;
+	}
+}
+
+// one box, as TransformBoxes does it
+inline Box TransformBox(const Matrix4F& m, Box box) {
+	Box r;
+	SoABoxF in{ { &box.MinP.x, &box.MinP.y, &box.MinP.z }, { &box.MaxP.x, &box.MaxP.y, &box.MaxP.z } };
+	SoABoxF out{ { &r.MinP.x, &r.MinP.y, &r.MinP.z }, { &r.MaxP.x, &r.MaxP.y, &r.MaxP.z } };
+	TransformBoxesScalar(m, in, out, 1);
+	return r;
+}
+
+
+#if Z_MATH_SIMD
+
+namespace simd {
+
+// one row of m splatted
+struct RowN {
+	explicit RowN(const TVector4<float>& r) :
+		X(SplatN(r.x)), Y(SplatN(r.y)), Z(SplatN(r.z)), W(SplatN(r.w)) {
+	}
+
+	RowN Abs() const {
+		RowN r = *this;
+		r.X = AbsN(X), r.Y = AbsN(Y), r.Z = AbsN(Z);
+		return r;
+	}
+
+	FloatN Direction(FloatN x, FloatN y, FloatN z) const {
+		return AddN(AddN(MulN(X, x), MulN(Y, y)), MulN(Z, z));
+	}
+
+	FloatN Point(FloatN x, FloatN y, FloatN z) const {
+		return AddN(Direction(x, y, z), W);
+	}
+
+	FloatN X, Y, Z, W;
+};
+
+}
+
+inline void TransformPoints(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	simd::RowN r0(m[0]), r1(m[1]), r2(m[2]);
+	size_t i = 0;
+	for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+		simd::FloatN x = simd::LoadN(in.X + i), y = simd::LoadN(in.Y + i), z = simd::LoadN(in.Z + i);
+		simd::StoreN(out.X + i, r0.Point(x, y, z));
+		simd::StoreN(out.Y + i, r1.Point(x, y, z));
+		simd::StoreN(out.Z + i, r2.Point(x, y, z));
+	}
+	TransformPointsScalar(m, in.Offset(i), out.Offset(i), num - i);
+}
+
+inline void TransformNormals(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	simd::RowN r0(m[0]), r1(m[1]), r2(m[2]);
+	size_t i = 0;
+	for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+		simd::FloatN x = simd::LoadN(in.X + i), y = simd::LoadN(in.Y + i), z = simd::LoadN(in.Z + i);
+		simd::StoreN(out.X + i, r0.Direction(x, y, z));
+		simd::StoreN(out.Y + i, r1.Direction(x, y, z));
+		simd::StoreN(out.Z + i, r2.Direction(x, y, z));
+	}
+	TransformNormalsScalar(m, in.Offset(i), out.Offset(i), num - i);
+}
+
+inline void ComputeBounds(SoAVector3F in, size_t num, Box& box) {
+	size_t i = 0;
+	if (num >= simd::K_FLOATN) {
+		simd::FloatN minX = simd::SplatN(box.MinP.x), minY = simd::SplatN(box.MinP.y), minZ = simd::SplatN(box.MinP.z);
+		simd::FloatN maxX = simd::SplatN(box.MaxP.x), maxY = simd::SplatN(box.MaxP.y), maxZ = simd::SplatN(box.MaxP.z);
+		for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+			simd::FloatN x = simd::LoadN(in.X + i), y = simd::LoadN(in.Y + i), z = simd::LoadN(in.Z + i);
+			minX = simd::MinN(x, minX), minY = simd::MinN(y, minY), minZ = simd::MinN(z, minZ);
+			maxX = simd::MaxN(x, maxX), maxY = simd::MaxN(y, maxY), maxZ = simd::MaxN(z, maxZ);
+		}
+		// lanes folded like points, min and max are exact in any order
+		float lanes[6][simd::K_FLOATN];
+		simd::StoreN(lanes[0], minX), simd::StoreN(lanes[1], minY), simd::StoreN(lanes[2], minZ);
+		simd::StoreN(lanes[3], maxX), simd::StoreN(lanes[4], maxY), simd::StoreN(lanes[5], maxZ);
+		ComputeBoundsScalar(SoAVector3F{ lanes[0], lanes[1], lanes[2] }, simd::K_FLOATN, box);
+		ComputeBoundsScalar(SoAVector3F{ lanes[3], lanes[4], lanes[5] }, simd::K_FLOATN, box);
+	}
+	ComputeBoundsScalar(in.Offset(i), num - i, box);
+}
+
+inline void TransformBoxes(const Matrix4F& m, SoABoxF in, SoABoxF out, size_t num) {
+	simd::RowN r0(m[0]), r1(m[1]), r2(m[2]);
+	simd::RowN a0 = r0.Abs(), a1 = r1.Abs(), a2 = r2.Abs();
+	simd::FloatN half = simd::SplatN(0.5f);
+	size_t i = 0;
+	for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+		simd::FloatN minX = simd::LoadN(in.Min.X + i), minY = simd::LoadN(in.Min.Y + i), minZ = simd::LoadN(in.Min.Z + i);
+		simd::FloatN maxX = simd::LoadN(in.Max.X + i), maxY = simd::LoadN(in.Max.Y + i), maxZ = simd::LoadN(in.Max.Z + i);
+		simd::FloatN cx = simd::MulN(simd::AddN(minX, maxX), half);
+		simd::FloatN cy = simd::MulN(simd::AddN(minY, maxY), half);
+		simd::FloatN cz = simd::MulN(simd::AddN(minZ, maxZ), half);
+		simd::FloatN ex = simd::MulN(simd::SubN(maxX, minX), half);
+		simd::FloatN ey = simd::MulN(simd::SubN(maxY, minY), half);
+		simd::FloatN ez = simd::MulN(simd::SubN(maxZ, minZ), half);
+
+		simd::FloatN nx = r0.Point(cx, cy, cz), ny = r1.Point(cx, cy, cz), nz = r2.Point(cx, cy, cz);
+		simd::FloatN fx = a0.Direction(ex, ey, ez), fy = a1.Direction(ex, ey, ez), fz = a2.Direction(ex, ey, ez);
+		simd::StoreN(out.Min.X + i, simd::SubN(nx, fx));
+		simd::StoreN(out.Min.Y + i, simd::SubN(ny, fy));
+		simd::StoreN(out.Min.Z + i, simd::SubN(nz, fz));
+		simd::StoreN(out.Max.X + i, simd::AddN(nx, fx));
+		simd::StoreN(out.Max.Y + i, simd::AddN(ny, fy));
+		simd::StoreN(out.Max.Z + i, simd::AddN(nz, fz));
+	}
+	TransformBoxesScalar(m, in.Offset(i), out.Offset(i), num - i);
+}
+
+#else
+
+inline void TransformPoints(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	TransformPointsScalar(m, in, out, num);
+}
+
+inline void TransformNormals(const Matrix4F& m, SoAVector3F in, SoAVector3F out, size_t num) {
+	TransformNormalsScalar(m, in, out, num);
+}
+
+inline void ComputeBounds(SoAVector3F in, size_t num, Box& box) {
+	ComputeBoundsScalar(in, num, box);
+}
+
+inline void TransformBoxes(const Matrix4F& m, SoABoxF in, SoABoxF out, size_t num) {
+	TransformBoxesScalar(m, in, out, num);
+}
+
+#endif
+
+}
+}
@@ -6,8 +6,8 @@
 namespace z { namespace math {
 
 
-inline Matrix4F MatrixPerspective(float fov, float aspect, float nearZ, float farZ) {
-	float tanv = std::sin(fov / 2) / std::cos(fov / 2);
+constexpr Matrix4F MatrixPerspective(float fov, float aspect, float nearZ, float farZ) {
+	float tanv = Sin(fov / 2) / Cos(fov / 2);
 	float r = farZ / (farZ - nearZ);
 
 	return Matrix4F(
@@ -18,7 +18,7 @@ inline Matrix4F MatrixPerspective(float fov, float aspect, float nearZ, float fa
 	);
 }
 
-inline Matrix4F MatrixOrtho(float left, float right, float bottom, float top, float nearZ, float farZ) {
+constexpr Matrix4F MatrixOrtho(float left, float right, float bottom, float top, float nearZ, float farZ) {
 	return Matrix4F(
 		{ 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
 		{ 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
@@ -28,7 +28,7 @@ inline Matrix4F MatrixOrtho(float left, float right, float bottom, float top, fl
 }
 
 
-inline Matrix4F MatrixOrtho2D(float left, float right, float bottom, float top) {
+constexpr Matrix4F MatrixOrtho2D(float left, float right, float bottom, float top) {
 	return Matrix4F(
 		{ 2.0f / (right - left), 0.0f, 0.0f, 0.0f },
 		{ 0.0f, 2.0f / (top - bottom), 0.0f, 0.0f },
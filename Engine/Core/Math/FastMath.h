@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+
+#include "Number.h"
+#include "Batch.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+Approximations for bulk geometry, over arrays of num floats. errors against
+the exact result, measured by TestMath:
+
+SinCos           abs 1e-7 for |x| <= 8192, see SinCos(float) in Number.h
+Atan2            abs 4e-7 rad, finite inputs. atan2(+-0, +-0) is +-0
+Rsqrt            rel 5e-7, x a normal float > 0
+NormalizeVectors length within 1e-6 of 1 for lengths up to 1e19, shorter than 1e-19 give 0
+
+SinCos and Atan2 match their *Scalar versions up to rounding (see
+Simd.h). Rsqrt and NormalizeVectors refine the 12 bit rsqrt estimate of the
+cpu by one newton step, they differ from the exact scalar ones within the
+bounds above, and between cpu vendors. the simd versions do 4 values a step
+with sse2
+*/
+
+// sleef's atanf minimax polynomial on [0, 1], a + a^3 * p(a^2)
+inline float Atan2(float y, float x) {
+	float ax = std::abs(x), ay = std::abs(y);
+	float mx = ax > ay ? ax : ay;
+	float mn = ax < ay ? ax : ay;
+	float a = mx > 0.0f ? mn / mx : 0.0f;
+	float z = a * a;
+	float p = 0.00282363896258175373077393f;
+	p = p * z - 0.0159569028764963150024414f;
+	p = p * z + 0.0425049886107444763183594f;
+	p = p * z - 0.0748900920152664184570312f;
+	p = p * z + 0.106347933411598205566406f;
+	p = p * z - 0.142027363181114196777344f;
+	p = p * z + 0.199926957488059997558594f;
+	p = p * z - 0.333331018686294555664062f;
+	float r = a * z * p + a;
+	r = ay > ax ? K_PIDIV2 - r : r;
+	r = x < 0.0f ? K_PI - r : r;
+	return std::signbit(y) ? -r : r;
+}
+
+inline void SinCosScalar(const float* x, float* s, float* c, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		SinCos(x[i], s[i], c[i]);
+	}
+}
+
+inline void Atan2Scalar(const float* y, const float* x, float* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		out[i] = Atan2(y[i], x[i]);
+	}
+}
+
+inline void RsqrtScalar(const float* in, float* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		out[i] = 1.0f / std::sqrt(in[i]);
+	}
+}
+
+inline void NormalizeVectorsScalar(SoAVector3F in, SoAVector3F out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		float x = in.X[i], y = in.Y[i], z = in.Z[i];
+		float len2 = (x * x + y * y) + z * z;
+		float r = len2 >= FLT_MIN ? 1.0f / std::sqrt(len2) : 0.0f;
+		out.X[i] = x * r, out.Y[i] = y * r, out.Z[i] = z * r;
+	}
+}
+
+
+#if Z_MATH_SIMD
+
+namespace simd {
+
+inline __m128 Select4(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// SinCos(float), the quadrant bits moved to masks
+inline void SinCos4(__m128 x, __m128& s, __m128& c) {
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	__m128 half = _mm_or_ps(_mm_and_ps(x, signBit), _mm_set1_ps(0.5f));
+	__m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(detail::K_2DIVPI)), half));
+	__m128 qf = _mm_cvtepi32_ps(q);
+	__m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(detail::K_PIDIV2_A)));
+	r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(detail::K_PIDIV2_B)));
+	r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(detail::K_PIDIV2_C)));
+	__m128 z = _mm_mul_ps(r, r);
+
+	__m128 sr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+	sr = _mm_sub_ps(_mm_mul_ps(sr, z), _mm_set1_ps(1.6666654611e-1f));
+	sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sr, z), r), r);
+	__m128 cr = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(1.388731625493765e-3f));
+	cr = _mm_add_ps(_mm_mul_ps(cr, z), _mm_set1_ps(4.166664568298827e-2f));
+	cr = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cr, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+	cr = _mm_add_ps(cr, _mm_set1_ps(1.0f));
+
+	const __m128i one = _mm_set1_epi32(1);
+	__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+	// bit 1 of q, and of q + 1, to the sign bit
+	__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(q, 1), 31));
+	__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(_mm_add_epi32(q, one), 1), 31));
+	s = _mm_xor_ps(Select4(swap, cr, sr), sinSign);
+	c = _mm_xor_ps(Select4(swap, sr, cr), cosSign);
+}
+
+inline __m128 Atan24(__m128 y, __m128 x) {
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	__m128 ax = _mm_andnot_ps(signBit, x), ay = _mm_andnot_ps(signBit, y);
+	__m128 mx = _mm_max_ps(ax, ay);
+	__m128 mn = _mm_min_ps(ax, ay);
+	__m128 a = _mm_and_ps(_mm_cmpgt_ps(mx, _mm_setzero_ps()), _mm_div_ps(mn, mx));
+	__m128 z = _mm_mul_ps(a, a);
+	__m128 p = _mm_set1_ps(0.00282363896258175373077393f);
+	p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.0159569028764963150024414f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.0425049886107444763183594f));
+	p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.0748900920152664184570312f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.106347933411598205566406f));
+	p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.142027363181114196777344f));
+	p = _mm_add_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.199926957488059997558594f));
+	p = _mm_sub_ps(_mm_mul_ps(p, z), _mm_set1_ps(0.333331018686294555664062f));
+	__m128 r = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, z), p), a);
+	r = Select4(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(K_PIDIV2), r), r);
+	r = Select4(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(K_PI), r), r);
+	return _mm_xor_ps(r, _mm_and_ps(y, signBit));
+}
+
+// rsqrt estimate and a newton step, r * (1.5 - 0.5 * x * r * r)
+inline __m128 Rsqrt4(__m128 x) {
+	__m128 r = _mm_rsqrt_ps(x);
+	__m128 hx = _mm_mul_ps(_mm_set1_ps(0.5f), x);
+	return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(hx, r), r)));
+}
+
+}
+
+inline void SinCos(const float* x, float* s, float* c, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		__m128 sv, cv;
+		simd::SinCos4(_mm_loadu_ps(x + i), sv, cv);
+		_mm_storeu_ps(s + i, sv);
+		_mm_storeu_ps(c + i, cv);
+	}
+	SinCosScalar(x + i, s + i, c + i, num - i);
+}
+
+inline void Atan2(const float* y, const float* x, float* out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		_mm_storeu_ps(out + i, simd::Atan24(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+	}
+	Atan2Scalar(y + i, x + i, out + i, num - i);
+}
+
+inline void Rsqrt(const float* in, float* out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		_mm_storeu_ps(out + i, simd::Rsqrt4(_mm_loadu_ps(in + i)));
+	}
+	RsqrtScalar(in + i, out + i, num - i);
+}
+
+inline void NormalizeVectors(SoAVector3F in, SoAVector3F out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		__m128 x = _mm_loadu_ps(in.X + i), y = _mm_loadu_ps(in.Y + i), z = _mm_loadu_ps(in.Z + i);
+		__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 r = _mm_and_ps(_mm_cmpge_ps(len2, _mm_set1_ps(FLT_MIN)), simd::Rsqrt4(len2));
+		_mm_storeu_ps(out.X + i, _mm_mul_ps(x, r));
+		_mm_storeu_ps(out.Y + i, _mm_mul_ps(y, r));
+		_mm_storeu_ps(out.Z + i, _mm_mul_ps(z, r));
+	}
+	NormalizeVectorsScalar(in.Offset(i), out.Offset(i), num - i);
+}
+
+#else
+
+inline void SinCos(const float* x, float* s, float* c, size_t num) {
+	SinCosScalar(x, s, c, num);
+}
+
+inline void Atan2(const float* y, const float* x, float* out, size_t num) {
+	Atan2Scalar(y, x, out, num);
+}
+
+inline void Rsqrt(const float* in, float* out, size_t num) {
+	RsqrtScalar(in, out, num);
+}
+
+inline void NormalizeVectors(SoAVector3F in, SoAVector3F out, size_t num) {
+	NormalizeVectorsScalar(in, out, num);
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Matrix.h"
+#include "Geometry.h"
+#include "Batch.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+View frustum, six planes facing inwards and normalized so sphere radii
+compare with distances. built from a view projection matrix (d3d depth,
+0 to 1, see Camera::GetViewProjectMatrix) by adding its rows (gribb, hartmann).
+
+the tests are conservative: a box or sphere outside near a corner may pass
+*/
+class Frustum {
+public:
+	enum {
+		PLANE_LEFT,
+		PLANE_RIGHT,
+		PLANE_BOTTOM,
+		PLANE_TOP,
+		PLANE_NEAR,
+		PLANE_FAR,
+		PLANE_NUM,
+	};
+
+	Frustum() {}
+	explicit Frustum(const Matrix4F& viewProj) {
+		const Vector4F& r0 = viewProj.x;
+		const Vector4F& r1 = viewProj.y;
+		const Vector4F& r2 = viewProj.z;
+		const Vector4F& r3 = viewProj.w;
+		Planes[PLANE_LEFT] = Plane(r3 + r0).GetNormalized();
+		Planes[PLANE_RIGHT] = Plane(r3 - r0).GetNormalized();
+		Planes[PLANE_BOTTOM] = Plane(r3 + r1).GetNormalized();
+		Planes[PLANE_TOP] = Plane(r3 - r1).GetNormalized();
+		Planes[PLANE_NEAR] = Plane(r2).GetNormalized();
+		Planes[PLANE_FAR] = Plane(r3 - r2).GetNormalized();
+	}
+
+	// the box corner furthest along each normal has to be in front
+	bool IsVisible(const Box& box) const {
+		for (const Plane& p : Planes) {
+			Point3D corner(
+				p.Normal.x > 0 ? box.MaxP.x : box.MinP.x,
+				p.Normal.y > 0 ? box.MaxP.y : box.MinP.y,
+				p.Normal.z > 0 ? box.MaxP.z : box.MinP.z);
+			if (!(p.Distance(corner) >= 0)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool IsVisible(const Point3D& center, float radius) const {
+		for (const Plane& p : Planes) {
+			if (!(p.Distance(center) + radius >= 0)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Plane Planes[PLANE_NUM];
+};
+
+
+/* visibility masks of the cull kernels, item i is bit i % 32 of word i / 32.
+   kernels overwrite GetMaskWords(num) words
+*/
+inline size_t GetMaskWords(size_t num) {
+	return (num + 31) / 32;
+}
+
+inline bool IsMaskSet(const uint32_t* mask, size_t i) {
+	return (mask[i / 32] >> (i % 32)) & 1;
+}
+
+inline void CullBoxesScalar(const Frustum& frustum, SoABoxF boxes, size_t num, uint32_t* visible) {
+	std::fill(visible, visible + GetMaskWords(num), 0);
+	for (size_t i = 0; i < num; i++) {
+		visible[i / 32] |= uint32_t(frustum.IsVisible(boxes.Get(i))) << (i % 32);
+	}
+}
+
+inline void CullSpheresScalar(const Frustum& frustum, SoAVector3F centers, const float* radius, size_t num, uint32_t* visible) {
+	std::fill(visible, visible + GetMaskWords(num), 0);
+	for (size_t i = 0; i < num; i++) {
+		visible[i / 32] |= uint32_t(frustum.IsVisible(centers.Get(i), radius[i])) << (i % 32);
+	}
+}
+
+
+#if Z_MATH_SIMD
+
+namespace simd {
+
+// one plane splatted, with the box corner it tests
+struct PlaneN {
+	explicit PlaneN(const Plane& p) :
+		X(SplatN(p.Normal.x)), Y(SplatN(p.Normal.y)), Z(SplatN(p.Normal.z)), D(SplatN(p.D)),
+		MaxX(p.Normal.x > 0), MaxY(p.Normal.y > 0), MaxZ(p.Normal.z > 0) {
+	}
+
+	FloatN Distance(FloatN x, FloatN y, FloatN z) const {
+		return AddN(AddN(AddN(MulN(X, x), MulN(Y, y)), MulN(Z, z)), D);
+	}
+
+	FloatN X, Y, Z, D;
+	bool MaxX, MaxY, MaxZ;
+};
+
+}
+
+// K_FLOATN boxes against each plane at a time, the sums of CullBoxesScalar.
+// an item within rounding of a plane may go either way (see Simd.h)
+inline void CullBoxes(const Frustum& frustum, SoABoxF boxes, size_t num, uint32_t* visible) {
+	std::fill(visible, visible + GetMaskWords(num), 0);
+	const simd::PlaneN planes[Frustum::PLANE_NUM] = {
+		simd::PlaneN(frustum.Planes[0]), simd::PlaneN(frustum.Planes[1]), simd::PlaneN(frustum.Planes[2]),
+		simd::PlaneN(frustum.Planes[3]), simd::PlaneN(frustum.Planes[4]), simd::PlaneN(frustum.Planes[5]),
+	};
+	const simd::FloatN zero = simd::SplatN(0.0f);
+	size_t i = 0;
+	for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+		simd::FloatN minX = simd::LoadN(boxes.Min.X + i), minY = simd::LoadN(boxes.Min.Y + i), minZ = simd::LoadN(boxes.Min.Z + i);
+		simd::FloatN maxX = simd::LoadN(boxes.Max.X + i), maxY = simd::LoadN(boxes.Max.Y + i), maxZ = simd::LoadN(boxes.Max.Z + i);
+		int mask = -1;
+		for (const simd::PlaneN& p : planes) {
+			simd::FloatN d = p.Distance(p.MaxX ? maxX : minX, p.MaxY ? maxY : minY, p.MaxZ ? maxZ : minZ);
+			mask &= simd::MaskN(simd::CmpGeN(d, zero));
+		}
+		// K_FLOATN divides 32, groups never straddle words
+		visible[i / 32] |= uint32_t(mask) << (i % 32);
+	}
+	for (; i < num; i++) {
+		visible[i / 32] |= uint32_t(frustum.IsVisible(boxes.Get(i))) << (i % 32);
+	}
+}
+
+inline void CullSpheres(const Frustum& frustum, SoAVector3F centers, const float* radius, size_t num, uint32_t* visible) {
+	std::fill(visible, visible + GetMaskWords(num), 0);
+	const simd::PlaneN planes[Frustum::PLANE_NUM] = {
+		simd::PlaneN(frustum.Planes[0]), simd::PlaneN(frustum.Planes[1]), simd::PlaneN(frustum.Planes[2]),
+		simd::PlaneN(frustum.Planes[3]), simd::PlaneN(frustum.Planes[4]), simd::PlaneN(frustum.Planes[5]),
+	};
+	const simd::FloatN zero = simd::SplatN(0.0f);
+	size_t i = 0;
+	for (; i + simd::K_FLOATN <= num; i += simd::K_FLOATN) {
+		simd::FloatN x = simd::LoadN(centers.X + i), y = simd::LoadN(centers.Y + i), z = simd::LoadN(centers.Z + i);
+		simd::FloatN r = simd::LoadN(radius + i);
+		int mask = -1;
+		for (const simd::PlaneN& p : planes) {
+			mask &= simd::MaskN(simd::CmpGeN(simd::AddN(p.Distance(x, y, z), r), zero));
+		}
+		visible[i / 32] |= uint32_t(mask) << (i % 32);
+	}
+	for (; i < num; i++) {
+		visible[i / 32] |= uint32_t(frustum.IsVisible(centers.Get(i), radius[i])) << (i % 32);
+	}
+}
+
+#else
+
+inline void CullBoxes(const Frustum& frustum, SoABoxF boxes, size_t num, uint32_t* visible) {
+	CullBoxesScalar(frustum, boxes, num, visible);
+}
+
+inline void CullSpheres(const Frustum& frustum, SoAVector3F centers, const float* radius, size_t num, uint32_t* visible) {
+	CullSpheresScalar(frustum, centers, radius, num, visible);
+}
+
+#endif
+
+}
+}
@@ -27,6 +27,11 @@ public:
 
     }
 
+    void Union(const Box &b) {
+        MinP = Point3D(std::min(b.MinP.x, MinP.x), std::min(b.MinP.y, MinP.y), std::min(b.MinP.z, MinP.z));
+        MaxP = Point3D(std::max(b.MaxP.x, MaxP.x), std::max(b.MaxP.y, MaxP.y), std::max(b.MaxP.z, MaxP.z));
+    }
+
     friend std::ostream& operator<<(std::ostream& out, const Box& v) {
         out << "Box" << v.MinP << ", " << v.MaxP;
         return out;
@@ -36,6 +41,50 @@ public:
     Point3D MaxP;
 };
 
+// points with Distance >= 0 are in front, on the side the normal points to
+class Plane {
+public:
+    constexpr Plane() : Normal(0, 1, 0), D(0) {}
+    constexpr Plane(const Vector3F& normal, float d) : Normal(normal), D(d) {}
+    // a, b, c, d of ax + by + cz + d = 0
+    constexpr explicit Plane(const Vector4F& v) : Normal(v.x, v.y, v.z), D(v.w) {}
+
+    // signed distance when the normal is unit length
+    constexpr float Distance(const Point3D& p) const {
+        return ((Normal.x * p.x + Normal.y * p.y) + Normal.z * p.z) + D;
+    }
+
+    constexpr Plane GetNormalized() const {
+        float l = 1.0f / Sqrt(Normal.x * Normal.x + Normal.y * Normal.y + Normal.z * Normal.z);
+        return Plane(Normal * l, D * l);
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Plane& v) {
+        out << "Plane" << v.Normal << ", " << v.D;
+        return out;
+    }
+
+    Vector3F Normal;
+    float D;
+};
+
+// points Origin + t * Direction, t >= 0. the direction needn't be unit length
+class Ray {
+public:
+    Ray(const Point3D& origin, const Vector3F& direction) :
+        Origin(origin), Direction(direction), InvDirection(1.0f / direction) {
+    }
+
+    Point3D GetPoint(float t) const {
+        return Origin + Direction * t;
+    }
+
+    Point3D Origin;
+    Vector3F Direction;
+    // inf where the direction is 0, for the slab tests
+    Vector3F InvDirection;
+};
+
 
 }
 }
\ No newline at end of file
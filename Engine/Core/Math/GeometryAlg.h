@@ -1,2 +1,196 @@
 #pragma once
 
+#include <cmath>
+
+#include "Vector.h"
+#include "Geometry.h"
+#include "Batch.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+Ray queries against batches of triangles and boxes, in the layout of Batch.h.
+one ray meets K_FLOATN items a step, the *Scalar versions are the reference
+and the tails. they agree on hits and indices, t up to rounding (see Simd.h).
+
+t is in and out: hits at t or further are ignored, a nearer hit sets t and
+index and returns true, so calls chain over blocks and meshes. ties keep the
+lower index. the scalar code writes min, max and the tests the way the simd
+instructions do them, nan included
+*/
+
+// triangles as a corner and its two edges: V0, E1 = V1 - V0, E2 = V2 - V0
+struct SoATriangleF {
+	SoAVector3F V0;
+	SoAVector3F E1;
+	SoAVector3F E2;
+
+	void Set(size_t i, const Point3D& v0, const Point3D& v1, const Point3D& v2) {
+		V0.Set(i, v0), E1.Set(i, v1 - v0), E2.Set(i, v2 - v0);
+	}
+	SoATriangleF Offset(size_t n) const { return SoATriangleF{ V0.Offset(n), E1.Offset(n), E2.Offset(n) }; }
+};
+
+// moller trumbore, both sides hit, edges included
+inline bool IntersectTrianglesScalar(const Ray& ray, SoATriangleF tris, size_t num, float& t, size_t& index) {
+	bool hit = false;
+	const Vector3F& d = ray.Direction;
+	for (size_t i = 0; i < num; i++) {
+		Vector3F e1 = tris.E1.Get(i), e2 = tris.E2.Get(i);
+		Vector3F p((d.y * e2.z) - (d.z * e2.y), (d.z * e2.x) - (d.x * e2.z), (d.x * e2.y) - (d.y * e2.x));
+		float det = (e1.x * p.x + e1.y * p.y) + e1.z * p.z;
+		float inv = 1.0f / det;
+		Vector3F s = ray.Origin - tris.V0.Get(i);
+		float u = ((s.x * p.x + s.y * p.y) + s.z * p.z) * inv;
+		Vector3F q((s.y * e1.z) - (s.z * e1.y), (s.z * e1.x) - (s.x * e1.z), (s.x * e1.y) - (s.y * e1.x));
+		float v = ((d.x * q.x + d.y * q.y) + d.z * q.z) * inv;
+		float dist = ((e2.x * q.x + e2.y * q.y) + e2.z * q.z) * inv;
+		if (0.0f < std::abs(det) && u >= 0.0f && 1.0f >= u && v >= 0.0f && 1.0f >= u + v &&
+			0.0f < dist && dist < t) {
+			t = dist, index = i, hit = true;
+		}
+	}
+	return hit;
+}
+
+/* slabs, t is where the ray enters the box, 0 from inside. the near and far
+   planes of each axis follow the sign of the direction
+*/
+inline bool IntersectBoxesScalar(const Ray& ray, SoABoxF boxes, size_t num, float& t, size_t& index) {
+	bool hit = false;
+	const Vector3F& o = ray.Origin;
+	const Vector3F& inv = ray.InvDirection;
+	SoAVector3F nearP{ inv.x >= 0 ? boxes.Min.X : boxes.Max.X, inv.y >= 0 ? boxes.Min.Y : boxes.Max.Y, inv.z >= 0 ? boxes.Min.Z : boxes.Max.Z };
+	SoAVector3F farP{ inv.x >= 0 ? boxes.Max.X : boxes.Min.X, inv.y >= 0 ? boxes.Max.Y : boxes.Min.Y, inv.z >= 0 ? boxes.Max.Z : boxes.Min.Z };
+	for (size_t i = 0; i < num; i++) {
+		float nx = (nearP.X[i] - o.x) * inv.x, ny = (nearP.Y[i] - o.y) * inv.y, nz = (nearP.Z[i] - o.z) * inv.z;
+		float fx = (farP.X[i] - o.x) * inv.x, fy = (farP.Y[i] - o.y) * inv.y, fz = (farP.Z[i] - o.z) * inv.z;
+		float enter = nx > ny ? nx : ny;
+		enter = enter > nz ? enter : nz;
+		enter = enter > 0.0f ? enter : 0.0f;
+		float exit = fx < fy ? fx : fy;
+		exit = exit < fz ? exit : fz;
+		if (exit >= enter && enter < t) {
+			t = enter, index = i, hit = true;
+		}
+	}
+	return hit;
+}
+
+inline bool IntersectBox(const Ray& ray, Box box, float& t) {
+	size_t index;
+	SoABoxF in{ { &box.MinP.x, &box.MinP.y, &box.MinP.z }, { &box.MaxP.x, &box.MaxP.y, &box.MaxP.z } };
+	return IntersectBoxesScalar(ray, in, 1, t, index);
+}
+
+
+#if Z_MATH_SIMD
+
+namespace simd {
+
+// the nearest lane of mask below t, lanes in order so ties keep the first
+inline bool NearestLane(FloatN dist, int mask, size_t first, float& t, size_t& index) {
+	float lanes[K_FLOATN];
+	StoreN(lanes, dist);
+	bool hit = false;
+	for (int k = 0; k < K_FLOATN; k++) {
+		if ((mask >> k) & 1 && lanes[k] < t) {
+			t = lanes[k], index = first + k, hit = true;
+		}
+	}
+	return hit;
+}
+
+}
+
+inline bool IntersectTriangles(const Ray& ray, SoATriangleF tris, size_t num, float& t, size_t& index) {
+	using namespace simd;
+	FloatN dx = SplatN(ray.Direction.x), dy = SplatN(ray.Direction.y), dz = SplatN(ray.Direction.z);
+	FloatN ox = SplatN(ray.Origin.x), oy = SplatN(ray.Origin.y), oz = SplatN(ray.Origin.z);
+	FloatN zero = SplatN(0.0f), one = SplatN(1.0f), best = SplatN(t);
+	bool hit = false;
+	size_t i = 0;
+	for (; i + K_FLOATN <= num; i += K_FLOATN) {
+		FloatN e1x = LoadN(tris.E1.X + i), e1y = LoadN(tris.E1.Y + i), e1z = LoadN(tris.E1.Z + i);
+		FloatN e2x = LoadN(tris.E2.X + i), e2y = LoadN(tris.E2.Y + i), e2z = LoadN(tris.E2.Z + i);
+		FloatN px = SubN(MulN(dy, e2z), MulN(dz, e2y));
+		FloatN py = SubN(MulN(dz, e2x), MulN(dx, e2z));
+		FloatN pz = SubN(MulN(dx, e2y), MulN(dy, e2x));
+		FloatN det = AddN(AddN(MulN(e1x, px), MulN(e1y, py)), MulN(e1z, pz));
+		FloatN inv = DivN(one, det);
+		FloatN sx = SubN(ox, LoadN(tris.V0.X + i)), sy = SubN(oy, LoadN(tris.V0.Y + i)), sz = SubN(oz, LoadN(tris.V0.Z + i));
+		FloatN u = MulN(AddN(AddN(MulN(sx, px), MulN(sy, py)), MulN(sz, pz)), inv);
+		FloatN qx = SubN(MulN(sy, e1z), MulN(sz, e1y));
+		FloatN qy = SubN(MulN(sz, e1x), MulN(sx, e1z));
+		FloatN qz = SubN(MulN(sx, e1y), MulN(sy, e1x));
+		FloatN v = MulN(AddN(AddN(MulN(dx, qx), MulN(dy, qy)), MulN(dz, qz)), inv);
+		FloatN dist = MulN(AddN(AddN(MulN(e2x, qx), MulN(e2y, qy)), MulN(e2z, qz)), inv);
+
+		FloatN in = AndN(CmpLtN(zero, AbsN(det)), AndN(CmpGeN(u, zero), CmpGeN(one, u)));
+		in = AndN(in, AndN(CmpGeN(v, zero), CmpGeN(one, AddN(u, v))));
+		in = AndN(in, AndN(CmpLtN(zero, dist), CmpLtN(dist, best)));
+		int mask = MaskN(in);
+		// hits are rare, reduced in scalar when there are some
+		if (mask && NearestLane(dist, mask, i, t, index)) {
+			best = SplatN(t);
+			hit = true;
+		}
+	}
+	size_t tail;
+	if (IntersectTrianglesScalar(ray, tris.Offset(i), num - i, t, tail)) {
+		index = i + tail;
+		hit = true;
+	}
+	return hit;
+}
+
+inline bool IntersectBoxes(const Ray& ray, SoABoxF boxes, size_t num, float& t, size_t& index) {
+	using namespace simd;
+	const Vector3F& o = ray.Origin;
+	const Vector3F& invDir = ray.InvDirection;
+	SoAVector3F nearP{ invDir.x >= 0 ? boxes.Min.X : boxes.Max.X, invDir.y >= 0 ? boxes.Min.Y : boxes.Max.Y, invDir.z >= 0 ? boxes.Min.Z : boxes.Max.Z };
+	SoAVector3F farP{ invDir.x >= 0 ? boxes.Max.X : boxes.Min.X, invDir.y >= 0 ? boxes.Max.Y : boxes.Min.Y, invDir.z >= 0 ? boxes.Max.Z : boxes.Min.Z };
+	FloatN ox = SplatN(o.x), oy = SplatN(o.y), oz = SplatN(o.z);
+	FloatN ix = SplatN(invDir.x), iy = SplatN(invDir.y), iz = SplatN(invDir.z);
+	FloatN zero = SplatN(0.0f), best = SplatN(t);
+	bool hit = false;
+	size_t i = 0;
+	for (; i + K_FLOATN <= num; i += K_FLOATN) {
+		FloatN nx = MulN(SubN(LoadN(nearP.X + i), ox), ix);
+		FloatN ny = MulN(SubN(LoadN(nearP.Y + i), oy), iy);
+		FloatN nz = MulN(SubN(LoadN(nearP.Z + i), oz), iz);
+		FloatN fx = MulN(SubN(LoadN(farP.X + i), ox), ix);
+		FloatN fy = MulN(SubN(LoadN(farP.Y + i), oy), iy);
+		FloatN fz = MulN(SubN(LoadN(farP.Z + i), oz), iz);
+		FloatN enter = MaxN(MaxN(MaxN(nx, ny), nz), zero);
+		FloatN exit = MinN(MinN(fx, fy), fz);
+		int mask = MaskN(AndN(CmpGeN(exit, enter), CmpLtN(enter, best)));
+		if (mask && NearestLane(enter, mask, i, t, index)) {
+			best = SplatN(t);
+			hit = true;
+		}
+	}
+	size_t tail;
+	if (IntersectBoxesScalar(ray, boxes.Offset(i), num - i, t, tail)) {
+		index = i + tail;
+		hit = true;
+	}
+	return hit;
+}
+
+#else
+
+inline bool IntersectTriangles(const Ray& ray, SoATriangleF tris, size_t num, float& t, size_t& index) {
+	return IntersectTrianglesScalar(ray, tris, num, t, index);
+}
+
+inline bool IntersectBoxes(const Ray& ray, SoABoxF boxes, size_t num, float& t, size_t& index) {
+	return IntersectBoxesScalar(ray, boxes, num, t, index);
+}
+
+#endif
+
+}
+}
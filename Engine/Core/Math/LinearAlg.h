@@ -2,6 +2,7 @@
 
 #include "Vector.h"
 #include "Matrix.h"
+#include "Number.h"
 
 namespace z {
 namespace math {
@@ -9,26 +10,26 @@ namespace math {
 
 // Vector
 template <typename T>
-inline T Dot(TVector3<T> t1, TVector3<T> t2) {
+constexpr T Dot(TVector3<T> t1, TVector3<T> t2) {
 	return t1.x * t2.x + t1.y * t2.y + t1.z * t2.z;
 }
 
 template <typename T>
-inline TVector3<T> Cross(TVector3<T> t1, TVector3<T> t2) {
+constexpr TVector3<T> Cross(TVector3<T> t1, TVector3<T> t2) {
 	return TVector3<T> {
 		(t1.y* t2.z) - (t1.z * t2.y), (t1.z* t2.x) - (t1.x * t2.z), (t1.x* t2.y) - (t1.y * t2.x)
 	};
 }
 
 template <typename T>
-inline TVector3<T> Normalize(TVector3<T> v) {
-	T l = std::sqrt(Dot(v, v));
+constexpr TVector3<T> Normalize(TVector3<T> v) {
+	T l = Sqrt(Dot(v, v));
 	return v / l;
 }
 
 template<typename T>
-inline T GetLength(TVector3<T> v) {
-	return std::sqrt(Dot(v, v));
+constexpr T GetLength(TVector3<T> v) {
+	return Sqrt(Dot(v, v));
 }
 
 
@@ -39,10 +40,10 @@ NxNx(1-Cos)+Cos   NxNy(1-Cos)+NzSin NxNz(1-Cos)-NySin
 NxNy(1-Cos)-NzSin NyNy(1-Cos)+Cos   NyNz(1-Cos)+NxSin
 NxNz(1-Cos)+Nysin NxNy(1-Cos)-NxCos NzNz(1-Cos)+Cos
 */
-inline Matrix4F MatrixRotationAxis(Vector3F axis, float radian) {
+constexpr Matrix4F MatrixRotationAxis(Vector3F axis, float radian) {
 	axis = Normalize(axis);
-	float sinv = std::sin(radian);
-	float cosv = std::cos(radian);
+	float sinv = 0, cosv = 0;
+	SinCos(radian, sinv, cosv);
 
 	Vector3F V0 = Vector3F(1.0f-cosv) * Vector3F(axis.y, axis.z, axis.x) * Vector3F(axis.z, axis.x, axis.y);
 
@@ -58,48 +59,49 @@ inline Matrix4F MatrixRotationAxis(Vector3F axis, float radian) {
 	};
 }
 
-inline Matrix4F MatrixRotationX(float radian) {
-	float sinv = std::sin(radian);
-	float cosv = std::cos(radian);
+constexpr Matrix4F MatrixRotationX(float radian) {
+	float sinv = 0, cosv = 0;
+	SinCos(radian, sinv, cosv);
 
-	Matrix4F r = Matrix4F::Identity;
-	r[1][1] = cosv;
-	r[1][2] = -sinv;
-	r[2][1] = sinv;
-	r[2][2] = cosv;
-	return r;
+	return Matrix4F(
+		1, 0,    0,     0,
+		0, cosv, -sinv, 0,
+		0, sinv, cosv,  0,
+		0, 0,    0,     1
+	);
 }
 
-inline Matrix4F MatrixRotationY(float radian) {
-	float sinv = std::sin(radian);
-	float cosv = std::cos(radian);
+constexpr Matrix4F MatrixRotationY(float radian) {
+	float sinv = 0, cosv = 0;
+	SinCos(radian, sinv, cosv);
 
-	Matrix4F r = Matrix4F::Identity;
-	r[0][0] = cosv;
-	r[0][2] = sinv;
-	r[2][0] = -sinv;
-	r[2][2] = cosv;
-	return r;
+	return Matrix4F(
+		cosv,  0, sinv, 0,
+		0,     1, 0,    0,
+		-sinv, 0, cosv, 0,
+		0,     0, 0,    1
+	);
 }
 
-inline Matrix4F MatrixRotationZ(float radian) {
-	float sinv = std::sin(radian);
-	float cosv = std::cos(radian);
+constexpr Matrix4F MatrixRotationZ(float radian) {
+	float sinv = 0, cosv = 0;
+	SinCos(radian, sinv, cosv);
 
-	Matrix4F r = Matrix4F::Identity;
-	r[0][0] = cosv;
-	r[0][1] = -sinv;
-	r[1][0] = sinv;
-	r[1][1] = cosv;
-	return r;
+	return Matrix4F(
+		cosv, -sinv, 0, 0,
+		sinv, cosv,  0, 0,
+		0,    0,     1, 0,
+		0,    0,     0, 1
+	);
 }
 
-inline Matrix4F MatrixTransform(Vector3F trans) {
-    Matrix4F r = Matrix4F::Identity;
-    r[0][3] = trans.x;
-    r[1][3] = trans.y;
-    r[2][3] = trans.z;
-    return r;
+constexpr Matrix4F MatrixTransform(Vector3F trans) {
+	return Matrix4F(
+		1, 0, 0, trans.x,
+		0, 1, 0, trans.y,
+		0, 0, 1, trans.z,
+		0, 0, 0, 1
+	);
 }
 
 }
@@ -1,6 +1,10 @@
  #pragma once
 
+#include <type_traits>
+
 #include "Vector.h"
+#include "Number.h"
+#include "Simd.h"
 
 namespace z {
 namespace math {
@@ -65,43 +69,27 @@ class TMatrix3 {
 	using TVector = TVector3<T>;
 public:
 	// ctor
-	TMatrix3() {}
-	TMatrix3(TVector _x, TVector _y, TVector _z) : x(_x), y(_y), z(_z) { }
-	TMatrix3(const TMatrix3& m) { *this = m; }
-	TMatrix3(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21, T m22) :
+	constexpr TMatrix3() : x(0), y(0), z(0) {}
+	constexpr TMatrix3(TVector _x, TVector _y, TVector _z) : x(_x), y(_y), z(_z) { }
+	constexpr TMatrix3(const TMatrix3& m) = default;
+	constexpr TMatrix3(T m00, T m01, T m02, T m10, T m11, T m12, T m20, T m21, T m22) :
 		TMatrix3(TVector(m00, m01, m02), TVector(m10, m11, m12), TVector(m20, m21, m22)) {}
 
 	// operator
-	TVector operator* (const TVector& v) const {
+	constexpr TVector operator* (const TVector& v) const {
 		// vector * matrix
-		T fX = (m00 * v[0]) + (m01 * v[1]) + (m02 * v[2]);
-		T fY = (m10 * v[0]) + (m11 * v[1]) + (m12 * v[2]);
-		T fZ = (m20 * v[0]) + (m21 * v[1]) + (m22 * v[2]);
+		T fX = (x.x * v.x) + (x.y * v.y) + (x.z * v.z);
+		T fY = (y.x * v.x) + (y.y * v.y) + (y.z * v.z);
+		T fZ = (z.x * v.x) + (z.y * v.y) + (z.z * v.z);
 		return TVector(fX, fY, fZ);
 	}
 
-	TMatrix3 operator* (const TMatrix3& m2) {
-		// m * m2
-		TMatrix3 r;
-		T a0 = m[0][0], a1 = m[1][0], a2 = m[2][0];
-		r[0][0] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2);
-		r[1][0] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2);
-		r[2][0] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2);
-
-		a0 = m[0][1], a1 = m[1][1], a2 = m[2][1];
-		r[0][1] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2);
-		r[1][1] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2);
-		r[2][1] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2);
-
-		a0 = m[0][2], a1 = m[1][2], a2 = m[2][2];
-		r[0][2] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2);
-		r[1][2] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2);
-		r[2][2] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2);
-
-		return r;
+	constexpr TMatrix3 operator* (const TMatrix3& m2) const {
+		// m * m2, row i of the result is m's rows weighted by row i of m2
+		return TMatrix3(CombineRows(m2.x), CombineRows(m2.y), CombineRows(m2.z));
 	}
 
-	TMatrix3& operator *= (const TMatrix3 &v2) { *this = *this * v2; return *this; }
+	constexpr TMatrix3& operator *= (const TMatrix3 &v2) { *this = *this * v2; return *this; }
 
 	TMatrix3 GetInverse() {
 		TMatrix3 r;
@@ -127,11 +115,11 @@ public:
 		return r;
 	}
 
-	TMatrix3 GetTranspose() {
+	constexpr TMatrix3 GetTranspose() const {
 		return TMatrix3<T>{
-			m[0][0], m[1][0], m[2][0],
-			m[0][1], m[1][1], m[2][1],
-			m[0][2], m[1][2], m[2][2]
+			x.x, y.x, z.x,
+			x.y, y.y, z.y,
+			x.z, y.z, z.z
 		};
 	}
 	TVector& operator [](int idx) { return m[idx]; }
@@ -151,25 +139,34 @@ public:
 
 	const static TMatrix3 Zero;
 	const static TMatrix3 Identity;
+
+private:
+	constexpr TVector CombineRows(const TVector& c) const {
+		return x * c.x + y * c.y + z * c.z;
+	}
 };
 
 
-template<typename T> const TMatrix3<T> TMatrix3<T>::Zero(0, 0, 0, 0, 0, 0, 0, 0, 0);
-template<typename T> const TMatrix3<T> TMatrix3<T>::Identity(1, 0, 0, 0, 1, 0, 0, 0, 1);
+template<typename T> constexpr TMatrix3<T> TMatrix3<T>::Zero(0, 0, 0, 0, 0, 0, 0, 0, 0);
+template<typename T> constexpr TMatrix3<T> TMatrix3<T>::Identity(1, 0, 0, 0, 1, 0, 0, 0, 1);
 
 typedef TMatrix3<float> Matrix3F;
 
 
-// Matrix4
+/* Matrix4, float ones use the simd backend (see Simd.h). the *Scalar
+   functions are the plain code, kept for other types and as the reference.
+   everything but the inverse is constexpr, folded with the scalar code.
+   constant expressions read only x, y, z and w, not m[] or m00..m33
+*/
 template<typename T>
-class TMatrix4 {
+class alignas(16) TMatrix4 {
 	using TVector = TVector4<T>;
 public:
 	// ctor
-	TMatrix4() : x(0), y(0), z(0), w(0) {}
-	TMatrix4(TVector _x, TVector _y, TVector _z, TVector _w) : x(_x), y(_y), z(_z), w(_w) { }
-	TMatrix4(const TMatrix4& m) { *this = m; }
-	TMatrix4(T m00, T m01, T m02, T m03, T m10, T m11, T m12, T m13,
+	constexpr TMatrix4() : x(0), y(0), z(0), w(0) {}
+	constexpr TMatrix4(TVector _x, TVector _y, TVector _z, TVector _w) : x(_x), y(_y), z(_z), w(_w) { }
+	constexpr TMatrix4(const TMatrix4& m) = default;
+	constexpr TMatrix4(T m00, T m01, T m02, T m03, T m10, T m11, T m12, T m13,
 		T m20, T m21, T m22, T m23, T m30, T m31, T m32, T m33) :
 		TMatrix4(
 			TVector(m00, m01, m02, m03), TVector(m10, m11, m12, m13),
@@ -177,47 +174,76 @@ public:
 		) {}
 
 	// operator
-	TVector operator* (const TVector& v) const {
+	constexpr TVector operator* (const TVector& v) const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			if (!Z_MATH_CONSTANT_EVALUATED()) {
+				TVector r;
+				simd::MatrixTransform(&m00, v.value, r.value);
+				return r;
+			}
+		}
+#endif
+		return TransformScalar(v);
+	}
+
+	constexpr TMatrix4 operator* (const TMatrix4& m2) const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			if (!Z_MATH_CONSTANT_EVALUATED()) {
+				TMatrix4 r;
+				simd::MatrixMul(&m00, &m2.m00, &r.m00);
+				return r;
+			}
+		}
+#endif
+		return MulScalar(m2);
+	}
+
+	constexpr TMatrix4& operator *= (const TMatrix4& v2) { *this = *this * v2; return *this; }
+
+	TMatrix4 GetInverse() const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			TMatrix4 r;
+			float det = simd::MatrixInverse(&m00, &r.m00);
+			CHECK(!Equal(det, .0f));
+			return r;
+		} else
+#endif
+		{
+			return GetInverseScalar();
+		}
+	}
+
+	constexpr TMatrix4 GetTranspose() const {
+#if Z_MATH_SIMD
+		if constexpr (std::is_same<T, float>::value) {
+			if (!Z_MATH_CONSTANT_EVALUATED()) {
+				TMatrix4 r;
+				simd::MatrixTranspose(&m00, &r.m00);
+				return r;
+			}
+		}
+#endif
+		return GetTransposeScalar();
+	}
+
+	constexpr TVector TransformScalar(const TVector& v) const {
 		// vector * matrix
-		T fX = (m[0][0] * v[0]) + (m[0][1] * v[1]) + (m[0][2] * v[2]) + (m[0][3] * v[3]);
-		T fY = (m[1][0] * v[0]) + (m[1][1] * v[1]) + (m[1][2] * v[2]) + (m[1][3] * v[3]);
-		T fZ = (m[2][0] * v[0]) + (m[2][1] * v[1]) + (m[2][2] * v[2]) + (m[2][3] * v[3]);
-		T fW = (m[3][0] * v[0]) + (m[3][1] * v[1]) + (m[3][2] * v[2]) + (m[3][3] * v[3]);
+		T fX = (x.x * v.x) + (x.y * v.y) + (x.z * v.z) + (x.w * v.w);
+		T fY = (y.x * v.x) + (y.y * v.y) + (y.z * v.z) + (y.w * v.w);
+		T fZ = (z.x * v.x) + (z.y * v.y) + (z.z * v.z) + (z.w * v.w);
+		T fW = (w.x * v.x) + (w.y * v.y) + (w.z * v.z) + (w.w * v.w);
 		return TVector(fX, fY, fZ, fW);
 	}
 
-	TMatrix4 operator* (const TMatrix4& m2) {
-		// m * m2
-		TMatrix4 r;
-		T a0 = m[0][0], a1 = m[1][0], a2 = m[2][0], a3 = m[3][0];
-		r[0][0] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2) + (m2[0][3] * a3);
-		r[1][0] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2) + (m2[1][3] * a3);
-		r[2][0] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2) + (m2[2][3] * a3);
-		r[3][0] = (m2[3][0] * a0) + (m2[3][1] * a1) + (m2[3][2] * a2) + (m2[3][3] * a3);
-
-		a0 = m[0][1], a1 = m[1][1], a2 = m[2][1], a3 = m[3][1];
-		r[0][1] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2) + (m2[0][3] * a3);
-		r[1][1] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2) + (m2[1][3] * a3);
-		r[2][1] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2) + (m2[2][3] * a3);
-		r[3][1] = (m2[3][0] * a0) + (m2[3][1] * a1) + (m2[3][2] * a2) + (m2[3][3] * a3);
-
-		a0 = m[0][2], a1 = m[1][2], a2 = m[2][2], a3 = m[3][2];
-		r[0][2] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2) + (m2[0][3] * a3);
-		r[1][2] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2) + (m2[1][3] * a3);
-		r[2][2] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2) + (m2[2][3] * a3);
-		r[3][2] = (m2[3][0] * a0) + (m2[3][1] * a1) + (m2[3][2] * a2) + (m2[3][3] * a3);
-
-		a0 = m[0][3], a1 = m[1][3], a2 = m[2][3], a3 = m[3][3];
-		r[0][3] = (m2[0][0] * a0) + (m2[0][1] * a1) + (m2[0][2] * a2) + (m2[0][3] * a3);
-		r[1][3] = (m2[1][0] * a0) + (m2[1][1] * a1) + (m2[1][2] * a2) + (m2[1][3] * a3);
-		r[2][3] = (m2[2][0] * a0) + (m2[2][1] * a1) + (m2[2][2] * a2) + (m2[2][3] * a3);
-		r[3][3] = (m2[3][0] * a0) + (m2[3][1] * a1) + (m2[3][2] * a2) + (m2[3][3] * a3);
-		return r;
+	constexpr TMatrix4 MulScalar(const TMatrix4& m2) const {
+		// m * m2, row i of the result is m's rows weighted by row i of m2
+		return TMatrix4(CombineRows(m2.x), CombineRows(m2.y), CombineRows(m2.z), CombineRows(m2.w));
 	}
 
-	TMatrix4& operator *= (const TMatrix4& v2) { *this = *this * v2; return *this; }
-
-	TMatrix4 GetInverse() {
+	TMatrix4 GetInverseScalar() const {
 		TMatrix4 r;
 		T tmp[12];
 
@@ -278,12 +304,12 @@ public:
 		return r;
 	}
 
-	TMatrix4 GetTranspose() {
+	constexpr TMatrix4 GetTransposeScalar() const {
 		return TMatrix4{
-			m[0][0], m[1][0], m[2][0], m[3][0],
-			m[0][1], m[1][1], m[2][1], m[3][1],
-			m[0][2], m[1][2], m[2][2], m[3][2],
-			m[0][3], m[1][3], m[2][3], m[3][3]
+			x.x, y.x, z.x, w.x,
+			x.y, y.y, z.y, w.y,
+			x.z, y.z, z.z, w.z,
+			x.w, y.w, z.w, w.w
 		};
 	}
 	TVector& operator [](int idx) { return m[idx]; }
@@ -294,7 +320,7 @@ public:
 		return out;
 	}
 
-	operator TMatrix3<T>() { return TMatrix3<T>{x, y, z}; }
+	constexpr operator TMatrix3<T>() const { return TMatrix3<T>{x, y, z}; }
 
 	// data
 	union {
@@ -305,11 +331,16 @@ public:
 
 	const static TMatrix4 Zero;
 	const static TMatrix4 Identity;
+
+private:
+	constexpr TVector CombineRows(const TVector& c) const {
+		return x * c.x + y * c.y + z * c.z + w * c.w;
+	}
 };
 
 
-template<typename T> const TMatrix4<T> TMatrix4<T>::Zero(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-template<typename T> const TMatrix4<T> TMatrix4<T>::Identity(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+template<typename T> constexpr TMatrix4<T> TMatrix4<T>::Zero(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+template<typename T> constexpr TMatrix4<T> TMatrix4<T>::Identity(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
 
 
 typedef TMatrix4<float> Matrix4;
@@ -1,32 +1,154 @@
 #pragma once
 
+#include <cmath>
+
+/* true while the compiler folds a constant expression, where neither simd nor
+   the std:: math functions can run. compilers without the builtin always
+   take the constant path, which is only slower
+*/
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define Z_MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define Z_MATH_CONSTANT_EVALUATED() true
+#endif
+
 namespace z {
 namespace math {
 
-const float K_PI      = 3.141592654f;
-const float K_2PI     = 6.283185307f;
-const float K_1DIVPI  = 0.318309886f;
-const float K_1DIV2PI = 0.159154943f;
-const float K_PIDIV2  = 1.570796327f;
-const float K_PIDIV4  = 0.785398163f;
+constexpr float K_PI      = 3.141592654f;
+constexpr float K_2PI     = 6.283185307f;
+constexpr float K_1DIVPI  = 0.318309886f;
+constexpr float K_1DIV2PI = 0.159154943f;
+constexpr float K_PIDIV2  = 1.570796327f;
+constexpr float K_PIDIV4  = 0.785398163f;
 
-const float K_MAXFLOAT = 1e10;
+constexpr float K_MAXFLOAT = 1e10;
 
 // degree
-inline float ToRadian(float degree) {
+constexpr float ToRadian(float degree) {
 	return degree / 180.0f * K_PI;
 }
 
-inline float ToDegree(float radian) {
+constexpr float ToDegree(float radian) {
 	return radian * 180.0f / K_PI;
 }
 
 // eps
-const float eps = (float)1e-6;
+constexpr float eps = (float)1e-6;
 
-inline float Equal(float a, float b) {
+constexpr float Equal(float a, float b) {
 	return a - b > -eps && a - b < eps;
 }
 
+/* Sin, Cos and Sqrt are std:: at runtime. folded at compile time they run a
+   series in double instead, within an ulp of the std:: ones
+*/
+namespace detail {
+
+// to [-pi, pi]
+constexpr double ReduceAngle(double x) {
+	const double pi2 = 6.283185307179586;
+	double k = x / pi2;
+	long long n = (long long)(k >= 0 ? k + 0.5 : k - 0.5);
+	return x - n * pi2;
+}
+
+constexpr double SinSeries(double x) {
+	double term = x, sum = x;
+	for (int i = 1; i < 12; i++) {
+		term *= -x * x / ((2 * i) * (2 * i + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double CosSeries(double x) {
+	double term = 1, sum = 1;
+	for (int i = 1; i < 12; i++) {
+		term *= -x * x / ((2 * i - 1) * (2 * i));
+		sum += term;
+	}
+	return sum;
+}
+
+// newton, negative numbers give 0
+constexpr double SqrtNewton(double x) {
+	if (!(x > 0)) {
+		return 0;
+	}
+	double r = x > 1 ? x : 1;
+	for (int i = 0; i < 128; i++) {
+		double next = (r + x / r) * 0.5;
+		if (next >= r) {
+			break;
+		}
+		r = next;
+	}
+	return r;
+}
+
+}
+
+constexpr float Sin(float radian) {
+	if (Z_MATH_CONSTANT_EVALUATED()) {
+		return (float)detail::SinSeries(detail::ReduceAngle(radian));
+	}
+	return std::sin(radian);
+}
+
+constexpr float Cos(float radian) {
+	if (Z_MATH_CONSTANT_EVALUATED()) {
+		return (float)detail::CosSeries(detail::ReduceAngle(radian));
+	}
+	return std::cos(radian);
+}
+
+constexpr float Sqrt(float v) {
+	if (Z_MATH_CONSTANT_EVALUATED()) {
+		return (float)detail::SqrtNewton(v);
+	}
+	return std::sqrt(v);
+}
+
+
+namespace detail {
+
+// pi / 2 in three parts, q * the first two exact for |q| < 2^13 (cody and waite)
+constexpr float K_PIDIV2_A = 1.5703125f;
+constexpr float K_PIDIV2_B = 4.837512969970703125e-4f;
+constexpr float K_PIDIV2_C = 7.54978995489188216e-8f;
+constexpr float K_2DIVPI = 0.636619772f;
+
+// cephes' sinf and cosf minimax polynomials on [-pi/4, pi/4], z = r * r
+constexpr float SinPoly(float r, float z) {
+	return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+}
+
+constexpr float CosPoly(float z) {
+	return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+}
+
+}
+
+/* sin and cos at once, without std::. abs error below 1e-7 for |radian| up
+   to 8192, beyond it the reduction loses bits. the same sums at compile time,
+   at runtime and in the SinCos batch kernel (FastMath.h), equal up to rounding
+*/
+constexpr void SinCos(float radian, float& s, float& c) {
+	// nearest multiple of pi / 2, rounded half away from 0
+	float t = radian * detail::K_2DIVPI + (radian < 0.0f ? -0.5f : 0.5f);
+	int q = (t > -1e9f && t < 1e9f) ? (int)t : 0;
+	float qf = (float)q;
+	float r = ((radian - qf * detail::K_PIDIV2_A) - qf * detail::K_PIDIV2_B) - qf * detail::K_PIDIV2_C;
+	float z = r * r;
+	float sr = detail::SinPoly(r, z);
+	float cr = detail::CosPoly(z);
+	// quadrant q mod 4 swaps and negates
+	float sv = (q & 1) ? cr : sr;
+	float cv = (q & 1) ? sr : cr;
+	s = (q & 2) ? -sv : sv;
+	c = ((q + 1) & 2) ? -cv : cv;
+}
+
 }
 }
\ No newline at end of file
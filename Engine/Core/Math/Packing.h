@@ -0,0 +1,343 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "Vector.h"
+#include "Quaternion.h"
+#include "Batch.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+Vertex attribute packing, the cpu side of the packed ERHIInputSemantic
+formats (decoded in Shader/include/Common.hlsl):
+
+half      float16, round to nearest even, denormals kept    (uv: 8 -> 4 bytes)
+snorm     [-1, 1] to int8 / int16, d3d rounding and decode
+unorm16   [0, 1] to uint16
+oct       unit vectors on the octahedron, 2 x snorm16       (normal: 12 -> 4 bytes)
+qtangent  normal, tangent and binormal as one quaternion,
+          4 x snorm16, the sign of w the binormal's side     (tbn: 36 -> 8 bytes)
+
+the bulk converters are bit exact with the single value ones. clamps and
+selects are written the way the sse instructions do them, nan gives -1 or 0.
+nan halfs keep being nan, their payload bits may differ
+*/
+
+namespace detail {
+
+inline uint32_t FloatBits(float v) {
+	uint32_t u;
+	memcpy(&u, &v, 4);
+	return u;
+}
+
+inline float BitsFloat(uint32_t u) {
+	float v;
+	memcpy(&v, &u, 4);
+	return v;
+}
+
+}
+
+// rounded to nearest even (fabian giesen's float_to_half_fast3_rtne)
+inline uint16_t FloatToHalf(float v) {
+	const uint32_t f32Infinity = 255u << 23;
+	const uint32_t f16Max = (127u + 16) << 23;
+	const uint32_t minNormal = 113u << 23;
+	// aligns the 10 mantissa bits of a half denormal to the bottom of the float
+	const float denormMagic = detail::BitsFloat(((127u - 15) + (23 - 10) + 1) << 23);
+
+	uint32_t u = detail::FloatBits(v);
+	uint32_t sign = u & 0x80000000u;
+	u ^= sign;
+
+	uint32_t r;
+	if (u >= f16Max) {
+		// inf or nan
+		r = u > f32Infinity ? 0x7e00 : 0x7c00;
+	} else if (u < minNormal) {
+		r = detail::FloatBits(detail::BitsFloat(u) + denormMagic) - detail::FloatBits(denormMagic);
+	} else {
+		uint32_t mantissaOdd = (u >> 13) & 1;
+		// rebias the exponent (15 - 127) and round
+		r = (u + 0xc8000fffu + mantissaOdd) >> 13;
+	}
+	return uint16_t(r | (sign >> 16));
+}
+
+// exact, denormals scaled by 2^112
+inline float HalfToFloat(uint16_t h) {
+	uint32_t expMantissa = h & 0x7fffu;
+	float scaled = detail::BitsFloat(expMantissa << 13) * detail::BitsFloat((254u - 15) << 23);
+	uint32_t infNan = expMantissa > 0x7bffu ? 255u << 23 : 0;
+	return detail::BitsFloat(detail::FloatBits(scaled) | ((h & 0x8000u) << 16) | infNan);
+}
+
+inline float ClampSnorm(float v) {
+	v = v > -1.0f ? v : -1.0f;
+	return v < 1.0f ? v : 1.0f;
+}
+
+inline float ClampUnorm(float v) {
+	v = v > 0.0f ? v : 0.0f;
+	return v < 1.0f ? v : 1.0f;
+}
+
+inline int16_t PackSnorm16(float v) {
+	return int16_t(std::lrint(ClampSnorm(v) * 32767.0f));
+}
+
+inline float UnpackSnorm16(int16_t v) {
+	float f = v / 32767.0f;
+	return f > -1.0f ? f : -1.0f;
+}
+
+inline int8_t PackSnorm8(float v) {
+	return int8_t(std::lrint(ClampSnorm(v) * 127.0f));
+}
+
+inline float UnpackSnorm8(int8_t v) {
+	float f = v / 127.0f;
+	return f > -1.0f ? f : -1.0f;
+}
+
+inline uint16_t PackUnorm16(float v) {
+	return uint16_t(std::lrint(ClampUnorm(v) * 65535.0f));
+}
+
+inline float UnpackUnorm16(uint16_t v) {
+	return v / 65535.0f;
+}
+
+
+// unit vector to [-1, 1]^2, the lower half folded over the diagonals
+inline Vector2F OctEncode(const Vector3F& n) {
+	float s = (std::abs(n.x) + std::abs(n.y)) + std::abs(n.z);
+	float x = n.x / s, y = n.y / s;
+	if (n.z < 0.0f) {
+		float fx = (1.0f - std::abs(y)) * std::copysign(1.0f, x);
+		float fy = (1.0f - std::abs(x)) * std::copysign(1.0f, y);
+		x = fx, y = fy;
+	}
+	return Vector2F(x, y);
+}
+
+inline Vector3F OctDecode(const Vector2F& e) {
+	Vector3F n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+	if (n.z < 0.0f) {
+		float x = (1.0f - std::abs(n.y)) * std::copysign(1.0f, n.x);
+		float y = (1.0f - std::abs(n.x)) * std::copysign(1.0f, n.y);
+		n.x = x, n.y = y;
+	}
+	return Normalize(n);
+}
+
+/* rotation taking x, y, z to tangent, binormal, normal, after the tangent is
+   made orthogonal to the normal. w is kept off 0 so its sign survives snorm16,
+   negative w means the binormal is -cross(normal, tangent)
+*/
+inline Quaternion TangentFrameToQuaternion(const Vector3F& normal, const Vector3F& tangent, const Vector3F& binormal) {
+	Vector3F n = Normalize(normal);
+	Vector3F t = Normalize(tangent - n * Dot(n, tangent));
+	Vector3F b = Cross(n, t);
+	Quaternion q = Quaternion::FromMatrix(Matrix4F(
+		t.x, b.x, n.x, 0,
+		t.y, b.y, n.y, 0,
+		t.z, b.z, n.z, 0,
+		0,   0,   0,   1));
+	q = Normalize(q);
+	if (q.w < 0.0f) {
+		q = -q;
+	}
+	const float bias = 1.0f / 32767.0f;
+	if (q.w < bias) {
+		float s = std::sqrt(1.0f - bias * bias);
+		q = Quaternion(q.x * s, q.y * s, q.z * s, bias);
+	}
+	return Dot(b, binormal) < 0.0f ? -q : q;
+}
+
+inline void QuaternionToTangentFrame(const Quaternion& q, Vector3F& normal, Vector3F& tangent, Vector3F& binormal) {
+	tangent = q.Rotate(Vector3F(1, 0, 0));
+	normal = q.Rotate(Vector3F(0, 0, 1));
+	binormal = Cross(normal, tangent) * (q.w < 0.0f ? -1.0f : 1.0f);
+}
+
+
+// bulk, num values of in to out
+inline void FloatToHalfScalar(const float* in, uint16_t* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		out[i] = FloatToHalf(in[i]);
+	}
+}
+
+inline void HalfToFloatScalar(const uint16_t* in, float* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		out[i] = HalfToFloat(in[i]);
+	}
+}
+
+inline void PackSnorm16Scalar(const float* in, int16_t* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		out[i] = PackSnorm16(in[i]);
+	}
+}
+
+// x, y pairs, the layout of SEMANTIC_NORMAL_OCT
+inline void PackNormalsOctScalar(SoAVector3F normals, int16_t* out, size_t num) {
+	for (size_t i = 0; i < num; i++) {
+		Vector2F e = OctEncode(normals.Get(i));
+		out[i * 2] = PackSnorm16(e.x);
+		out[i * 2 + 1] = PackSnorm16(e.y);
+	}
+}
+
+
+#if Z_MATH_SIMD
+
+/* 4 values a step with sse2, halfs by f16c where the compiler targets it
+   (msvc has no __F16C__, its /arch:AVX2 implies it)
+*/
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define Z_MATH_F16C 1
+#else
+#define Z_MATH_F16C 0
+#endif
+
+namespace simd {
+
+inline __m128i FloatToHalf4(__m128 v) {
+#if Z_MATH_F16C
+	return _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+#else
+	// FloatToHalf, both branches computed and selected
+	const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+	const __m128i f16MaxMinus1 = _mm_set1_epi32(((127 + 16) << 23) - 1);
+	const __m128i minNormal = _mm_set1_epi32(113 << 23);
+	const __m128 denormMagic = _mm_castsi128_ps(_mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+
+	__m128i u = _mm_castps_si128(v);
+	__m128i sign = _mm_and_si128(u, _mm_set1_epi32(int(0x80000000u)));
+	u = _mm_xor_si128(u, sign);
+
+	__m128i infNan = _mm_or_si128(_mm_set1_epi32(0x7c00),
+		_mm_and_si128(_mm_cmpgt_epi32(u, f32Infinity), _mm_set1_epi32(0x0200)));
+	__m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), denormMagic)), _mm_castps_si128(denormMagic));
+	__m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+	__m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(int(0xc8000fffu))), mantissaOdd), 13);
+
+	__m128i isDenorm = _mm_cmplt_epi32(u, minNormal);
+	__m128i isInfNan = _mm_cmpgt_epi32(u, f16MaxMinus1);
+	__m128i r = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+	r = _mm_or_si128(_mm_and_si128(isInfNan, infNan), _mm_andnot_si128(isInfNan, r));
+	r = _mm_or_si128(r, _mm_srli_epi32(sign, 16));
+	// to 16 bits without the signed saturation of packs
+	r = _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+	return _mm_packs_epi32(r, r);
+#endif
+}
+
+// the 4 halfs in the low 64 bits of h
+inline __m128 HalfToFloat4(__m128i h) {
+#if Z_MATH_F16C
+	return _mm_cvtph_ps(h);
+#else
+	h = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+	__m128i expMantissa = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+	__m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+	__m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7bff)), _mm_set1_epi32(255 << 23));
+	__m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expMantissa), 16);
+	return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNan)));
+#endif
+}
+
+// 4 rounded int32 of clamped v * 32767
+inline __m128i Snorm16x4(__m128 v) {
+	v = _mm_max_ps(v, _mm_set1_ps(-1.0f));
+	v = _mm_min_ps(v, _mm_set1_ps(1.0f));
+	return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(32767.0f)));
+}
+
+inline __m128 Abs4(__m128 v) {
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// copysign(1, v)
+inline __m128 SignOne4(__m128 v) {
+	return _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f));
+}
+
+}
+
+inline void FloatToHalf(const float* in, uint16_t* out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		_mm_storel_epi64((__m128i*)(out + i), simd::FloatToHalf4(_mm_loadu_ps(in + i)));
+	}
+	FloatToHalfScalar(in + i, out + i, num - i);
+}
+
+inline void HalfToFloat(const uint16_t* in, float* out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		_mm_storeu_ps(out + i, simd::HalfToFloat4(_mm_loadl_epi64((const __m128i*)(in + i))));
+	}
+	HalfToFloatScalar(in + i, out + i, num - i);
+}
+
+inline void PackSnorm16(const float* in, int16_t* out, size_t num) {
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		__m128i r = simd::Snorm16x4(_mm_loadu_ps(in + i));
+		_mm_storel_epi64((__m128i*)(out + i), _mm_packs_epi32(r, r));
+	}
+	PackSnorm16Scalar(in + i, out + i, num - i);
+}
+
+inline void PackNormalsOct(SoAVector3F normals, int16_t* out, size_t num) {
+	const __m128 one = _mm_set1_ps(1.0f);
+	size_t i = 0;
+	for (; i + 4 <= num; i += 4) {
+		__m128 nx = _mm_loadu_ps(normals.X + i), ny = _mm_loadu_ps(normals.Y + i), nz = _mm_loadu_ps(normals.Z + i);
+		__m128 s = _mm_add_ps(_mm_add_ps(simd::Abs4(nx), simd::Abs4(ny)), simd::Abs4(nz));
+		__m128 x = _mm_div_ps(nx, s), y = _mm_div_ps(ny, s);
+		__m128 fx = _mm_mul_ps(_mm_sub_ps(one, simd::Abs4(y)), simd::SignOne4(x));
+		__m128 fy = _mm_mul_ps(_mm_sub_ps(one, simd::Abs4(x)), simd::SignOne4(y));
+		__m128 lower = _mm_cmplt_ps(nz, _mm_setzero_ps());
+		x = _mm_or_ps(_mm_and_ps(lower, fx), _mm_andnot_ps(lower, x));
+		y = _mm_or_ps(_mm_and_ps(lower, fy), _mm_andnot_ps(lower, y));
+		__m128i px = simd::Snorm16x4(x), py = simd::Snorm16x4(y);
+		// x0 y0 x1 y1 .. as int32, packed to 8 int16
+		_mm_storeu_si128((__m128i*)(out + i * 2),
+			_mm_packs_epi32(_mm_unpacklo_epi32(px, py), _mm_unpackhi_epi32(px, py)));
+	}
+	PackNormalsOctScalar(normals.Offset(i), out + i * 2, num - i);
+}
+
+#else
+
+inline void FloatToHalf(const float* in, uint16_t* out, size_t num) {
+	FloatToHalfScalar(in, out, num);
+}
+
+inline void HalfToFloat(const uint16_t* in, float* out, size_t num) {
+	HalfToFloatScalar(in, out, num);
+}
+
+inline void PackSnorm16(const float* in, int16_t* out, size_t num) {
+	PackSnorm16Scalar(in, out, num);
+}
+
+inline void PackNormalsOct(SoAVector3F normals, int16_t* out, size_t num) {
+	PackNormalsOctScalar(normals, out, num);
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cmath>
+
+#include "Matrix.h"
+#include "LinearAlg.h"
+#include "Simd.h"
+
+namespace z {
+namespace math {
+
+/*
+Unit quaternion rotation, rotating as the matrices of LinearAlg.h do.
+a * b applies a first, like Matrix4F, so ToMatrix(a * b) == ToMatrix(a) * ToMatrix(b).
+16 bytes, not aligned, Transform keeps it next to 3 float vectors.
+
+Euler rotators are (pitch x, yaw y, roll z) applied yaw, pitch, roll (see Transform)
+*/
+class Quaternion {
+public:
+	// ctor
+	Quaternion() : x(0), y(0), z(0), w(1) {}
+	Quaternion(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+
+	static Quaternion FromAxisAngle(const Vector3F& axis, float radian) {
+		float s = 0, c = 0;
+		SinCos(radian * 0.5f, s, c);
+		Vector3F n = Normalize(axis) * s;
+		return Quaternion(n.x, n.y, n.z, c);
+	}
+
+	static Quaternion FromRotator(const Vector3F& rotator) {
+		return FromAxisAngle(Vector3F(0, 1, 0), rotator.y) *
+			FromAxisAngle(Vector3F(1, 0, 0), rotator.x) *
+			FromAxisAngle(Vector3F(0, 0, 1), rotator.z);
+	}
+
+	// rotation of m's upper 3x3, which has to be orthonormal (shepperd)
+	static Quaternion FromMatrix(const Matrix4F& m) {
+		float trace = m.m00 + m.m11 + m.m22;
+		Quaternion q;
+		if (trace > 0.0f) {
+			float s = std::sqrt(trace + 1.0f) * 2.0f;
+			q = Quaternion((m.m21 - m.m12) / s, (m.m02 - m.m20) / s, (m.m10 - m.m01) / s, 0.25f * s);
+		} else if (m.m00 > m.m11 && m.m00 > m.m22) {
+			float s = std::sqrt(1.0f + m.m00 - m.m11 - m.m22) * 2.0f;
+			q = Quaternion(0.25f * s, (m.m01 + m.m10) / s, (m.m02 + m.m20) / s, (m.m21 - m.m12) / s);
+		} else if (m.m11 > m.m22) {
+			float s = std::sqrt(1.0f + m.m11 - m.m00 - m.m22) * 2.0f;
+			q = Quaternion((m.m01 + m.m10) / s, 0.25f * s, (m.m12 + m.m21) / s, (m.m02 - m.m20) / s);
+		} else {
+			float s = std::sqrt(1.0f + m.m22 - m.m00 - m.m11) * 2.0f;
+			q = Quaternion((m.m02 + m.m20) / s, (m.m12 + m.m21) / s, 0.25f * s, (m.m10 - m.m01) / s);
+		}
+		return q;
+	}
+
+	// operator
+	Quaternion operator* (const Quaternion& q) const {
+		Quaternion r;
+#if Z_MATH_SIMD
+		simd::QuaternionMul(q.value, value, r.value);
+#else
+		r = MulScalar(q);
+#endif
+		return r;
+	}
+
+	Quaternion& operator *= (const Quaternion& q) { *this = *this * q; return *this; }
+
+	Quaternion operator- () const { return Quaternion(-x, -y, -z, -w); }
+
+	// hamilton product q * this, the reference of the simd one
+	Quaternion MulScalar(const Quaternion& q) const {
+		return Quaternion(
+			((q.w * x + q.x * w) + q.y * z) - q.z * y,
+			((q.w * y - q.x * z) + q.y * w) + q.z * x,
+			((q.w * z + q.x * y) - q.y * x) + q.z * w,
+			((q.w * w - q.x * x) - q.y * y) - q.z * z
+		);
+	}
+
+	// the inverse of a unit quaternion
+	Quaternion GetConjugate() const {
+		return Quaternion(-x, -y, -z, w);
+	}
+
+	Vector3F Rotate(const Vector3F& v) const {
+		// v + w t + q x t, t = 2 q x v
+		Vector3F q(x, y, z);
+		Vector3F t = Cross(q, v) * 2.0f;
+		return v + t * w + Cross(q, t);
+	}
+
+	Matrix4F ToMatrix() const {
+		float xx = x * x, yy = y * y, zz = z * z;
+		float xy = x * y, xz = x * z, yz = y * z;
+		float wx = w * x, wy = w * y, wz = w * z;
+		return Matrix4F(
+			1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy), 0,
+			2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx), 0,
+			2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy), 0,
+			0, 0, 0, 1
+		);
+	}
+
+	// back to FromRotator's angles
+	Vector3F ToRotator() const {
+		float m21 = 2 * (y * z + w * x);
+		Vector3F euler;
+		euler.x = std::asin(std::min(1.0f, std::max(-1.0f, m21)));
+		if (std::cos(euler.x) > 0.0001f) {
+			euler.y = -std::atan2(2 * (x * z - w * y), 1 - 2 * (x * x + y * y));
+			euler.z = -std::atan2(2 * (x * y - w * z), 1 - 2 * (x * x + z * z));
+		} else {
+			// when x = 90 degree, rotar y is loss, just set to zero
+			euler.y = 0.0f;
+			euler.z = std::atan2(2 * (x * y + w * z), 1 - 2 * (y * y + z * z));
+		}
+		return euler;
+	}
+
+	friend std::ostream& operator<<(std::ostream& out, const Quaternion& q) {
+		out << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+		return out;
+	}
+
+	// data
+	union {
+		struct { float x, y, z, w; };
+		float value[4];
+	};
+
+	const static Quaternion Identity;
+};
+
+inline const Quaternion Quaternion::Identity(0, 0, 0, 1);
+
+
+inline float Dot(const Quaternion& a, const Quaternion& b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+inline Quaternion Normalize(const Quaternion& q) {
+	float l = 1.0f / std::sqrt(Dot(q, q));
+	return Quaternion(q.x * l, q.y * l, q.z * l, q.w * l);
+}
+
+// normalized lerp, the short way round. cheap, speed not constant
+inline Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t) {
+	float s = Dot(a, b) < 0.0f ? -t : t;
+	return Normalize(Quaternion(
+		a.x + (b.x * s - a.x * t), a.y + (b.y * s - a.y * t),
+		a.z + (b.z * s - a.z * t), a.w + (b.w * s - a.w * t)));
+}
+
+// constant angular speed, the short way round. nlerp when nearly equal
+inline Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t) {
+	float cosv = Dot(a, b);
+	Quaternion c = cosv < 0.0f ? -b : b;
+	cosv = std::abs(cosv);
+	if (cosv > 0.9995f) {
+		return Nlerp(a, c, t);
+	}
+	float angle = std::acos(cosv);
+	float sinv = std::sin(angle);
+	float wa = std::sin((1.0f - t) * angle) / sinv;
+	float wb = std::sin(t * angle) / sinv;
+	return Quaternion(a.x * wa + c.x * wb, a.y * wa + c.y * wb, a.z * wa + c.z * wb, a.w * wa + c.w * wb);
+}
+
+}
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+/*
+Backend of the 4 wide float math, Vector4F and Matrix4F. set Z_MATH_SIMD to
+one of the values below (BuildCMake.py), or leave it to the compiler flags:
+AVX when __AVX__ (/arch:AVX, -mavx), SSE on any x64 build, scalar otherwise.
+
+kernels work on 16 byte aligned rows of 4 floats. the inverse groups its
+sums differently, it is only close.
+
+the simd code here and in the batch headers does the operations of its
+*Scalar version in the same order and never asks for fma, so both agree up
+to rounding: a few ulp at most. they are not bit exact, the compiler may
+fuse multiply-adds on either side (gcc -march with fma, clang
+-ffp-contract=on, msvc /fp:contract), and its vectorizer may still emit
+fused multiply-subtract under -ffp-contract=off. tests compare the paths
+with a tolerance. a result that only compares or moves floats (min, max,
+shuffles, transpose) stays exact, a sign taken from a sum may flip when the
+sum is within rounding of 0
+*/
+#define Z_MATH_SIMD_SCALAR 0
+#define Z_MATH_SIMD_SSE 1
+#define Z_MATH_SIMD_AVX 2
+
+#ifndef Z_MATH_SIMD
+#if defined(__AVX__)
+#define Z_MATH_SIMD Z_MATH_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Z_MATH_SIMD Z_MATH_SIMD_SSE
+#else
+#define Z_MATH_SIMD Z_MATH_SIMD_SCALAR
+#endif
+#endif
+
+#if Z_MATH_SIMD >= Z_MATH_SIMD_AVX
+#include <immintrin.h>
+#elif Z_MATH_SIMD >= Z_MATH_SIMD_SSE
+// sse2, the integer lanes of Packing.h and FastMath.h
+#include <emmintrin.h>
+#endif
+
+namespace z {
+namespace math {
+namespace simd {
+
+#if Z_MATH_SIMD >= Z_MATH_SIMD_SSE
+
+#define Z_SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+
+// b[0] * a0 + b[1] * a1 + b[2] * a2 + b[3] * a3, added left to right
+inline __m128 CombineRows(__m128 b, __m128 a0, __m128 a1, __m128 a2, __m128 a3) {
+	__m128 r = _mm_mul_ps(Z_SPLAT(b, 0), a0);
+	r = _mm_add_ps(r, _mm_mul_ps(Z_SPLAT(b, 1), a1));
+	r = _mm_add_ps(r, _mm_mul_ps(Z_SPLAT(b, 2), a2));
+	return _mm_add_ps(r, _mm_mul_ps(Z_SPLAT(b, 3), a3));
+}
+
+#if Z_MATH_SIMD >= Z_MATH_SIMD_AVX
+// two rows at once
+inline __m256 CombineRows2(__m256 b, __m256 a0, __m256 a1, __m256 a2, __m256 a3) {
+	__m256 r = _mm256_mul_ps(_mm256_permute_ps(b, 0x00), a0);
+	r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(b, 0x55), a1));
+	r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(b, 0xAA), a2));
+	return _mm256_add_ps(r, _mm256_mul_ps(_mm256_permute_ps(b, 0xFF), a3));
+}
+#endif
+
+// r = a * b as TMatrix4 defines it, a applied first: row i of r is sum(b[i][k] * row k of a)
+inline void MatrixMul(const float* a, const float* b, float* r) {
+	__m128 a0 = _mm_load_ps(a);
+	__m128 a1 = _mm_load_ps(a + 4);
+	__m128 a2 = _mm_load_ps(a + 8);
+	__m128 a3 = _mm_load_ps(a + 12);
+#if Z_MATH_SIMD >= Z_MATH_SIMD_AVX
+	__m256 aa0 = _mm256_set_m128(a0, a0);
+	__m256 aa1 = _mm256_set_m128(a1, a1);
+	__m256 aa2 = _mm256_set_m128(a2, a2);
+	__m256 aa3 = _mm256_set_m128(a3, a3);
+	__m256 r01 = CombineRows2(_mm256_loadu_ps(b), aa0, aa1, aa2, aa3);
+	__m256 r23 = CombineRows2(_mm256_loadu_ps(b + 8), aa0, aa1, aa2, aa3);
+	_mm256_storeu_ps(r, r01);
+	_mm256_storeu_ps(r + 8, r23);
+#else
+	__m128 r0 = CombineRows(_mm_load_ps(b), a0, a1, a2, a3);
+	__m128 r1 = CombineRows(_mm_load_ps(b + 4), a0, a1, a2, a3);
+	__m128 r2 = CombineRows(_mm_load_ps(b + 8), a0, a1, a2, a3);
+	__m128 r3 = CombineRows(_mm_load_ps(b + 12), a0, a1, a2, a3);
+	_mm_store_ps(r, r0);
+	_mm_store_ps(r + 4, r1);
+	_mm_store_ps(r + 8, r2);
+	_mm_store_ps(r + 12, r3);
+#endif
+}
+
+inline void MatrixTranspose(const float* m, float* r) {
+	__m128 r0 = _mm_load_ps(m);
+	__m128 r1 = _mm_load_ps(m + 4);
+	__m128 r2 = _mm_load_ps(m + 8);
+	__m128 r3 = _mm_load_ps(m + 12);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	_mm_store_ps(r, r0);
+	_mm_store_ps(r + 4, r1);
+	_mm_store_ps(r + 8, r2);
+	_mm_store_ps(r + 12, r3);
+}
+
+// r[i] = dot(row i of m, v), summed over the columns
+inline void MatrixTransform(const float* m, const float* v, float* r) {
+	__m128 c0 = _mm_load_ps(m);
+	__m128 c1 = _mm_load_ps(m + 4);
+	__m128 c2 = _mm_load_ps(m + 8);
+	__m128 c3 = _mm_load_ps(m + 12);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	_mm_store_ps(r, CombineRows(_mm_load_ps(v), c0, c1, c2, c3));
+}
+
+// MatrixMul of the rows x, y, z of affine matrices, w rows (0, 0, 0, 1) implied
+inline void AffineMul(const float* a, const float* b, float* r) {
+	__m128 a0 = _mm_load_ps(a);
+	__m128 a1 = _mm_load_ps(a + 4);
+	__m128 a2 = _mm_load_ps(a + 8);
+	__m128 a3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+	_mm_store_ps(r, CombineRows(_mm_load_ps(b), a0, a1, a2, a3));
+	_mm_store_ps(r + 4, CombineRows(_mm_load_ps(b + 4), a0, a1, a2, a3));
+	_mm_store_ps(r + 8, CombineRows(_mm_load_ps(b + 8), a0, a1, a2, a3));
+}
+
+/* inverse of the rows x, y, z of an affine matrix whose 3x3 has orthogonal
+   columns: the transpose, row i divided by the squared length of column i.
+   lane 3 of the columns is scratch, dropped by the transpose
+*/
+inline void AffineInverse(const float* m, float* r) {
+	__m128 r0 = _mm_load_ps(m);
+	__m128 r1 = _mm_load_ps(m + 4);
+	__m128 r2 = _mm_load_ps(m + 8);
+	__m128 len = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, r0), _mm_mul_ps(r1, r1)), _mm_mul_ps(r2, r2));
+	__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), len);
+	// columns of the inverse
+	__m128 c0 = _mm_mul_ps(r0, inv);
+	__m128 c1 = _mm_mul_ps(r1, inv);
+	__m128 c2 = _mm_mul_ps(r2, inv);
+	__m128 t = _mm_mul_ps(c0, Z_SPLAT(r0, 3));
+	t = _mm_add_ps(t, _mm_mul_ps(c1, Z_SPLAT(r1, 3)));
+	t = _mm_add_ps(t, _mm_mul_ps(c2, Z_SPLAT(r2, 3)));
+	t = _mm_xor_ps(t, _mm_set1_ps(-0.0f));
+	_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+	_mm_store_ps(r, c0);
+	_mm_store_ps(r + 4, c1);
+	_mm_store_ps(r + 8, c2);
+}
+
+/* cramer's rule on 2x2 sub determinants (intel AP-928), returns the
+   determinant, r is only written when it isn't 0
+*/
+inline float MatrixInverse(const float* m, float* r) {
+	__m128 row0, row1, row2, row3, tmp;
+	__m128 minor0, minor1, minor2, minor3, det;
+
+	// transposed, rows 1 and 3 with their halves swapped
+	tmp = _mm_movelh_ps(_mm_load_ps(m), _mm_load_ps(m + 4));
+	row1 = _mm_movelh_ps(_mm_load_ps(m + 8), _mm_load_ps(m + 12));
+	row0 = _mm_shuffle_ps(tmp, row1, 0x88);
+	row1 = _mm_shuffle_ps(row1, tmp, 0xDD);
+	tmp = _mm_movehl_ps(_mm_load_ps(m + 4), _mm_load_ps(m));
+	row3 = _mm_movehl_ps(_mm_load_ps(m + 12), _mm_load_ps(m + 8));
+	row2 = _mm_shuffle_ps(tmp, row3, 0x88);
+	row3 = _mm_shuffle_ps(row3, tmp, 0xDD);
+
+	tmp = _mm_mul_ps(row2, row3);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	minor0 = _mm_mul_ps(row1, tmp);
+	minor1 = _mm_mul_ps(row0, tmp);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+	minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+	minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+	tmp = _mm_mul_ps(row1, row2);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+	minor3 = _mm_mul_ps(row0, tmp);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+	minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+	minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+	tmp = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+	minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+	minor2 = _mm_mul_ps(row0, tmp);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+	minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+	minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+	tmp = _mm_mul_ps(row0, row1);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+	minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+	tmp = _mm_mul_ps(row0, row3);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+	minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+	minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+	tmp = _mm_mul_ps(row0, row2);
+	tmp = _mm_shuffle_ps(tmp, tmp, 0xB1);
+	minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+	tmp = _mm_shuffle_ps(tmp, tmp, 0x4E);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+	minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+	det = _mm_mul_ps(row0, minor0);
+	det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+	det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+	float d = _mm_cvtss_f32(det);
+	if (d == 0.0f) {
+		return d;
+	}
+	// a real divide, rcp is only 12 bits
+	det = _mm_div_ps(_mm_set1_ps(1.0f), Z_SPLAT(det, 0));
+	_mm_store_ps(r, _mm_mul_ps(det, minor0));
+	_mm_store_ps(r + 4, _mm_mul_ps(det, minor1));
+	_mm_store_ps(r + 8, _mm_mul_ps(det, minor2));
+	_mm_store_ps(r + 12, _mm_mul_ps(det, minor3));
+	return d;
+}
+
+/* hamilton product p q (q applied first), lanes x y z w. the scalar code in
+   Quaternion.h adds in the same order, up to rounding (see top)
+*/
+inline void QuaternionMul(const float* p, const float* q, float* r) {
+	__m128 pp = _mm_loadu_ps(p);
+	__m128 qq = _mm_loadu_ps(q);
+	__m128 s1 = _mm_xor_ps(_mm_shuffle_ps(qq, qq, _MM_SHUFFLE(0, 1, 2, 3)), _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f));
+	__m128 s2 = _mm_xor_ps(_mm_shuffle_ps(qq, qq, _MM_SHUFFLE(1, 0, 3, 2)), _mm_set_ps(-0.0f, -0.0f, 0.0f, 0.0f));
+	__m128 s3 = _mm_xor_ps(_mm_shuffle_ps(qq, qq, _MM_SHUFFLE(2, 3, 0, 1)), _mm_set_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+	__m128 rr = _mm_mul_ps(Z_SPLAT(pp, 3), qq);
+	rr = _mm_add_ps(rr, _mm_mul_ps(Z_SPLAT(pp, 0), s1));
+	rr = _mm_add_ps(rr, _mm_mul_ps(Z_SPLAT(pp, 1), s2));
+	rr = _mm_add_ps(rr, _mm_mul_ps(Z_SPLAT(pp, 2), s3));
+	_mm_storeu_ps(r, rr);
+}
+
+#undef Z_SPLAT
+
+/* lanes of the batch kernels (Batch.h), 8 floats with avx, 4 with sse.
+   loads and stores are unaligned. compares give all-ones lanes, MaskN packs
+   their sign bits, lane i to bit i
+*/
+#if Z_MATH_SIMD >= Z_MATH_SIMD_AVX
+typedef __m256 FloatN;
+const int K_FLOATN = 8;
+inline FloatN LoadN(const float* p) { return _mm256_loadu_ps(p); }
+inline void StoreN(float* p, FloatN v) { _mm256_storeu_ps(p, v); }
+inline FloatN SplatN(float v) { return _mm256_set1_ps(v); }
+inline FloatN AddN(FloatN a, FloatN b) { return _mm256_add_ps(a, b); }
+inline FloatN SubN(FloatN a, FloatN b) { return _mm256_sub_ps(a, b); }
+inline FloatN MulN(FloatN a, FloatN b) { return _mm256_mul_ps(a, b); }
+inline FloatN MinN(FloatN a, FloatN b) { return _mm256_min_ps(a, b); }
+inline FloatN MaxN(FloatN a, FloatN b) { return _mm256_max_ps(a, b); }
+inline FloatN AbsN(FloatN a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline FloatN DivN(FloatN a, FloatN b) { return _mm256_div_ps(a, b); }
+inline FloatN CmpGeN(FloatN a, FloatN b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline FloatN CmpLtN(FloatN a, FloatN b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline FloatN AndN(FloatN a, FloatN b) { return _mm256_and_ps(a, b); }
+inline int MaskN(FloatN a) { return _mm256_movemask_ps(a); }
+#else
+typedef __m128 FloatN;
+const int K_FLOATN = 4;
+inline FloatN LoadN(const float* p) { return _mm_loadu_ps(p); }
+inline void StoreN(float* p, FloatN v) { _mm_storeu_ps(p, v); }
+inline FloatN SplatN(float v) { return _mm_set1_ps(v); }
+inline FloatN AddN(FloatN a, FloatN b) { return _mm_add_ps(a, b); }
+inline FloatN SubN(FloatN a, FloatN b) { return _mm_sub_ps(a, b); }
+inline FloatN MulN(FloatN a, FloatN b) { return _mm_mul_ps(a, b); }
+inline FloatN MinN(FloatN a, FloatN b) { return _mm_min_ps(a, b); }
+inline FloatN MaxN(FloatN a, FloatN b) { return _mm_max_ps(a, b); }
+inline FloatN AbsN(FloatN a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline FloatN DivN(FloatN a, FloatN b) { return _mm_div_ps(a, b); }
+inline FloatN CmpGeN(FloatN a, FloatN b) { return _mm_cmpge_ps(a, b); }
+inline FloatN CmpLtN(FloatN a, FloatN b) { return _mm_cmplt_ps(a, b); }
+inline FloatN AndN(FloatN a, FloatN b) { return _mm_and_ps(a, b); }
+inline int MaskN(FloatN a) { return _mm_movemask_ps(a); }
+#endif
+
+#endif
+
+}
+}
+}
@@ -11,27 +11,27 @@ template <typename T>
 class TVector2 {
 public:
 	// ctor
-	TVector2() : x(0), y(0){}
-	TVector2(T v) : TVector2(v, v) {}
-	TVector2(T _x, T _y) : x(_x), y(_y) {}
-	TVector2(const TVector2& v) { *this = v; }
+	constexpr TVector2() : x(0), y(0){}
+	constexpr TVector2(T v) : TVector2(v, v) {}
+	constexpr TVector2(T _x, T _y) : x(_x), y(_y) {}
+	constexpr TVector2(const TVector2& v) = default;
 
 	// operator
-	TVector2 operator- () const { return TVector2(-x, -y); }
-	TVector2 operator+ (const TVector2& v2) const { return TVector2(x + v2.x, y + v2.y); }
-	TVector2 operator- (const TVector2& v2) const { return TVector2(x - v2.x, y - v2.y); }
-	TVector2 operator* (const TVector2& v2) const { return TVector2(x * v2.x, y * v2.y); }
-	TVector2 operator/ (const TVector2& v2) const { return TVector2(x / v2.x, y / v2.y); }
-	TVector2 operator* (T v2) const { return *this * TVector2(v2); }
-	TVector2 operator/ (T v2) const { return *this / TVector2(v2); }
-
-	TVector2& operator += (TVector2 v2) { *this = *this + v2; return *this; }
-	TVector2& operator -= (TVector2 v2) { *this = *this - v2; return *this; }
-	TVector2& operator *= (TVector2 v2) { *this = *this * v2; return *this; }
-	TVector2& operator /= (TVector2 v2) { *this = *this / v2; return *this; }
-
-	friend TVector2 operator* (T v1, TVector2 v2) { return TVector2(v1) * v2; }
-	friend TVector2 operator/ (T v1, TVector2 v2) { return TVector2(v1) / v2; }
+	constexpr TVector2 operator- () const { return TVector2(-x, -y); }
+	constexpr TVector2 operator+ (const TVector2& v2) const { return TVector2(x + v2.x, y + v2.y); }
+	constexpr TVector2 operator- (const TVector2& v2) const { return TVector2(x - v2.x, y - v2.y); }
+	constexpr TVector2 operator* (const TVector2& v2) const { return TVector2(x * v2.x, y * v2.y); }
+	constexpr TVector2 operator/ (const TVector2& v2) const { return TVector2(x / v2.x, y / v2.y); }
+	constexpr TVector2 operator* (T v2) const { return *this * TVector2(v2); }
+	constexpr TVector2 operator/ (T v2) const { return *this / TVector2(v2); }
+
+	constexpr TVector2& operator += (TVector2 v2) { *this = *this + v2; return *this; }
+	constexpr TVector2& operator -= (TVector2 v2) { *this = *this - v2; return *this; }
+	constexpr TVector2& operator *= (TVector2 v2) { *this = *this * v2; return *this; }
+	constexpr TVector2& operator /= (TVector2 v2) { *this = *this / v2; return *this; }
+
+	friend constexpr TVector2 operator* (T v1, TVector2 v2) { return TVector2(v1) * v2; }
+	friend constexpr TVector2 operator/ (T v1, TVector2 v2) { return TVector2(v1) / v2; }
 
 	T& operator [](int idx) { return value[idx]; }
 	const T operator [](int idx) const { return value[idx]; }
@@ -46,8 +46,8 @@ public:
 	const static TVector2 Identity;
 };
 
-template<typename T> const TVector2<T> TVector2<T>::Zero(0, 0);
-template<typename T> const TVector2<T> TVector2<T>::Identity(1, 1);
+template<typename T> constexpr TVector2<T> TVector2<T>::Zero(0, 0);
+template<typename T> constexpr TVector2<T> TVector2<T>::Identity(1, 1);
 
 typedef TVector2<float> Vector2;
 typedef TVector2<float> Vector2F;
@@ -59,27 +59,27 @@ template <typename T>
 class TVector3 {
 public:
 	// ctor
-	TVector3() : x{0}, y{0}, z{0} {}
-	TVector3(T v) : TVector3(v, v, v) {}
-	TVector3(T _x, T _y, T _z) : x(_x), y(_y), z(_z) {}
-	TVector3(const TVector3& v) { *this = v; }
+	constexpr TVector3() : x{0}, y{0}, z{0} {}
+	constexpr TVector3(T v) : TVector3(v, v, v) {}
+	constexpr TVector3(T _x, T _y, T _z) : x(_x), y(_y), z(_z) {}
+	constexpr TVector3(const TVector3& v) = default;
 
 	// operator
-	TVector3 operator- () const { return TVector3(-x, -y, -z); }
-	TVector3 operator+ (const TVector3 &v2) const { return TVector3(x + v2.x, y + v2.y, z + v2.z); }
-	TVector3 operator- (const TVector3 &v2) const { return TVector3(x - v2.x, y - v2.y, z - v2.z); }
-	TVector3 operator* (const TVector3 &v2) const { return TVector3(x * v2.x, y * v2.y, z * v2.z); }
-	TVector3 operator/ (const TVector3 &v2) const { return TVector3(x / v2.x, y / v2.y, z / v2.z); }
-	TVector3 operator* (T v2) const { return *this * TVector3(v2); }
-	TVector3 operator/ (T v2) const { return *this / TVector3(v2); }
-
-	TVector3& operator += (TVector3 v2) { *this = *this + v2; return *this; }
-	TVector3& operator -= (TVector3 v2) { *this = *this - v2; return *this; }
-	TVector3& operator *= (TVector3 v2) { *this = *this * v2; return *this; }
-	TVector3& operator /= (TVector3 v2) { *this = *this / v2; return *this; }
-
-	friend TVector3 operator* (T v1, TVector3 v2) { return TVector3(v1) * v2; }
-	friend TVector3 operator/ (T v1, TVector3 v2) { return TVector3(v1) / v2; }
+	constexpr TVector3 operator- () const { return TVector3(-x, -y, -z); }
+	constexpr TVector3 operator+ (const TVector3 &v2) const { return TVector3(x + v2.x, y + v2.y, z + v2.z); }
+	constexpr TVector3 operator- (const TVector3 &v2) const { return TVector3(x - v2.x, y - v2.y, z - v2.z); }
+	constexpr TVector3 operator* (const TVector3 &v2) const { return TVector3(x * v2.x, y * v2.y, z * v2.z); }
+	constexpr TVector3 operator/ (const TVector3 &v2) const { return TVector3(x / v2.x, y / v2.y, z / v2.z); }
+	constexpr TVector3 operator* (T v2) const { return *this * TVector3(v2); }
+	constexpr TVector3 operator/ (T v2) const { return *this / TVector3(v2); }
+
+	constexpr TVector3& operator += (TVector3 v2) { *this = *this + v2; return *this; }
+	constexpr TVector3& operator -= (TVector3 v2) { *this = *this - v2; return *this; }
+	constexpr TVector3& operator *= (TVector3 v2) { *this = *this * v2; return *this; }
+	constexpr TVector3& operator /= (TVector3 v2) { *this = *this / v2; return *this; }
+
+	friend constexpr TVector3 operator* (T v1, TVector3 v2) { return TVector3(v1) * v2; }
+	friend constexpr TVector3 operator/ (T v1, TVector3 v2) { return TVector3(v1) / v2; }
 
 	T& operator [](int idx) { return value[idx]; }
 	const T operator [](int idx) const { return value[idx]; }
@@ -99,46 +99,46 @@ public:
 	const static TVector3 Identity;
 };
 
-template<typename T> const TVector3<T> TVector3<T>::Zero(0, 0, 0);
-template<typename T> const TVector3<T> TVector3<T>::Identity(1, 1, 1);
+template<typename T> constexpr TVector3<T> TVector3<T>::Zero(0, 0, 0);
+template<typename T> constexpr TVector3<T> TVector3<T>::Identity(1, 1, 1);
 
 typedef TVector3<float> Vector3;
 typedef TVector3<float> Vector3F;
 typedef TVector3<int> Vector3I;
 
 
-// Vector4
+// Vector4, 16 byte aligned for the simd backend
 template <typename T>
-class TVector4 {
+class alignas(16) TVector4 {
 public:
 	// ctor
-	TVector4() {}
-	TVector4(T _x, T _y, T _z, T _w) : x(_x), y(_y), z(_z), w(_w) {}
-	TVector4(T v) : TVector4(v, v, v, v) {}
-	TVector4(const TVector4& v) { *this = v; }
-	TVector4(const TVector3<T>& v, T _w) : TVector4(v.x, v.y, v.z, _w) {}
+	constexpr TVector4() : x(0), y(0), z(0), w(0) {}
+	constexpr TVector4(T _x, T _y, T _z, T _w) : x(_x), y(_y), z(_z), w(_w) {}
+	constexpr TVector4(T v) : TVector4(v, v, v, v) {}
+	constexpr TVector4(const TVector4& v) = default;
+	constexpr TVector4(const TVector3<T>& v, T _w) : TVector4(v.x, v.y, v.z, _w) {}
 
 	// operator
-	TVector4 operator- () const { return TVector4(-x, -y, -z. - w); }
-	TVector4 operator+ (const TVector4& v2) const { return Vector4(x + v2.x, y + v2.y, z + v2.z, w + v2.w); }
-	TVector4 operator- (const TVector4& v2) const { return Vector4(x - v2.x, y - v2.y, z - v2.z, w - v2.w); }
-	TVector4 operator* (const TVector4& v2) const { return Vector4(x * v2.x, y * v2.y, z * v2.z, w * v2.w); }
-	TVector4 operator/ (const TVector4& v2) const { return Vector4(x / v2.x, y / v2.y, z / v2.z, w / v2.w); }
-	TVector4 operator* (T v2) const { return *this * Vector4(v2); }
-	TVector4 operator/ (T v2) const { return *this / Vector4(v2); }
-
-	TVector4& operator += (const TVector4& v2) { *this = *this + v2; return *this; }
-	TVector4& operator -= (const TVector4& v2) { *this = *this - v2; return *this; }
-	TVector4& operator *= (const TVector4& v2) { *this = *this * v2; return *this; }
-	TVector4& operator /= (const TVector4& v2) { *this = *this / v2; return *this; }
-
-	friend TVector4 operator* (T v1, const TVector4& v2) { return TVector4(v1) * v2; }
-	friend TVector4 operator/ (T v1, const TVector4& v2) { return TVector4(v1) / v2; }
+	constexpr TVector4 operator- () const { return TVector4(-x, -y, -z, -w); }
+	constexpr TVector4 operator+ (const TVector4& v2) const { return TVector4(x + v2.x, y + v2.y, z + v2.z, w + v2.w); }
+	constexpr TVector4 operator- (const TVector4& v2) const { return TVector4(x - v2.x, y - v2.y, z - v2.z, w - v2.w); }
+	constexpr TVector4 operator* (const TVector4& v2) const { return TVector4(x * v2.x, y * v2.y, z * v2.z, w * v2.w); }
+	constexpr TVector4 operator/ (const TVector4& v2) const { return TVector4(x / v2.x, y / v2.y, z / v2.z, w / v2.w); }
+	constexpr TVector4 operator* (T v2) const { return *this * TVector4(v2); }
+	constexpr TVector4 operator/ (T v2) const { return *this / TVector4(v2); }
+
+	constexpr TVector4& operator += (const TVector4& v2) { *this = *this + v2; return *this; }
+	constexpr TVector4& operator -= (const TVector4& v2) { *this = *this - v2; return *this; }
+	constexpr TVector4& operator *= (const TVector4& v2) { *this = *this * v2; return *this; }
+	constexpr TVector4& operator /= (const TVector4& v2) { *this = *this / v2; return *this; }
+
+	friend constexpr TVector4 operator* (T v1, const TVector4& v2) { return TVector4(v1) * v2; }
+	friend constexpr TVector4 operator/ (T v1, const TVector4& v2) { return TVector4(v1) / v2; }
 
 	T& operator [](int idx) { return value[idx]; }
 	const T operator [](int idx) const { return value[idx]; }
 	
-	operator TVector3<T>() { return TVector3<T>{x, y, z}; }
+	constexpr operator TVector3<T>() const { return TVector3<T>{x, y, z}; }
 
 	friend std::ostream& operator<<(std::ostream& out, const TVector4& v) {
 		out << "(" << v.x << ", " << v.y << ", " <<  v.z << ", " << v.w << ")";
@@ -156,10 +156,10 @@ public:
 };
 
 template<typename T>
-const TVector4<T> TVector4<T>::Zero(0, 0, 0, 0);
+constexpr TVector4<T> TVector4<T>::Zero(0, 0, 0, 0);
 
 template<typename T>
-const TVector4<T> TVector4<T>::Identity(1, 1, 1, 1);
+constexpr TVector4<T> TVector4<T>::Identity(1, 1, 1, 1);
 
 typedef TVector4<float> Vector4;
 typedef TVector4<float> Vector4F;
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "Service.h"
+
+// coroutines need c++20, targets built as c++17 don't see anything here
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define Z_SCHED_COROUTINE 1
+#else
+#define Z_SCHED_COROUTINE 0
+#endif
+
+#if Z_SCHED_COROUTINE
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <vector>
+
+namespace z {
+namespace sched {
+
+/*
+Coroutine frame allocator, size classes on top of NodePool.
+frames are freed on whichever worker finishes them, the per thread caches of
+NodePool handle that. frames larger than the biggest class use the heap.
+*/
+class FramePool {
+private:
+	template<size_t Size>
+	struct Block {
+		alignas(std::max_align_t) unsigned char Data[Size];
+	};
+
+	template<size_t Size>
+	static bool TryAlloc(size_t size, void*& p) {
+		if (size > Size) {
+			return false;
+		}
+		p = NodePool<Block<Size>>::New();
+		return true;
+	}
+
+	template<size_t Size>
+	static bool TryFree(size_t size, void* p) {
+		if (size > Size) {
+			return false;
+		}
+		NodePool<Block<Size>>::Delete((Block<Size>*)p);
+		return true;
+	}
+
+public:
+	static void* Alloc(size_t size) {
+		void* p = nullptr;
+		if (TryAlloc<128>(size, p) || TryAlloc<256>(size, p) || TryAlloc<512>(size, p) ||
+			TryAlloc<1024>(size, p) || TryAlloc<2048>(size, p)) {
+			return p;
+		}
+		return ::operator new(size);
+	}
+
+	static void Free(void* p, size_t size) {
+		if (TryFree<128>(size, p) || TryFree<256>(size, p) || TryFree<512>(size, p) ||
+			TryFree<1024>(size, p) || TryFree<2048>(size, p)) {
+			return;
+		}
+		::operator delete(p);
+	}
+};
+
+
+template<typename T = void>
+class Co;
+
+namespace detail {
+
+// state shared by Co<T> promises
+class CoPromiseBase {
+public:
+	void* operator new(size_t size) {
+		return FramePool::Alloc(size);
+	}
+
+	void operator delete(void* p, size_t size) {
+		FramePool::Free(p, size);
+	}
+
+	std::suspend_always initial_suspend() noexcept {
+		return {};
+	}
+
+	/* on finish:
+		detached: free the frame
+		joined by WhenAll: the last one resumes the waiting coroutine
+		awaited: resume the awaiting coroutine
+	*/
+	struct FinalAwaiter {
+		bool await_ready() noexcept {
+			return false;
+		}
+
+		template<typename Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+			CoPromiseBase& promise = h.promise();
+			if (promise.mDetached) {
+				CHECK(!promise.mError, "Detached coroutine threw.");
+				h.destroy();
+				return std::noop_coroutine();
+			}
+			if (promise.mJoinCount && promise.mJoinCount->fetch_sub(1) != 1) {
+				return std::noop_coroutine();
+			}
+			return promise.mContinuation ? promise.mContinuation : std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	FinalAwaiter final_suspend() noexcept {
+		return {};
+	}
+
+	void unhandled_exception() {
+		mError = std::current_exception();
+	}
+
+	void RethrowIfError() {
+		if (mError) {
+			std::rethrow_exception(mError);
+		}
+	}
+
+	std::coroutine_handle<> mContinuation;
+	std::atomic<int>* mJoinCount{ nullptr };
+	std::exception_ptr mError;
+	bool mDetached{ false };
+};
+
+template<typename T>
+class CoPromise : public CoPromiseBase {
+public:
+	Co<T> get_return_object();
+
+	template<typename U>
+	void return_value(U&& value) {
+		mValue.emplace(std::forward<U>(value));
+	}
+
+	T TakeResult() {
+		RethrowIfError();
+		return std::move(*mValue);
+	}
+
+private:
+	std::optional<T> mValue;
+};
+
+template<>
+class CoPromise<void> : public CoPromiseBase {
+public:
+	Co<void> get_return_object();
+
+	void return_void() {}
+
+	void TakeResult() {
+		RethrowIfError();
+	}
+};
+
+}	// namespace detail
+
+
+/*
+Lazy coroutine task, the body starts when awaited or detached.
+
+	Co<Mesh> Load(...) {
+		co_await parallel.Schedule();	// read and decode on workers
+		...
+		co_await renderStrand.Schedule();	// upload on the render strand
+		co_return mesh;
+	}
+
+co_await a Co<T> runs it and resumes the awaiting coroutine on whatever
+queue it finished on. frames come from FramePool.
+*/
+template<typename T>
+class Co {
+public:
+	typedef detail::CoPromise<T> promise_type;
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	Co() {}
+	explicit Co(Handle handle) : mHandle(handle) {}
+
+	Co(Co&& other) noexcept : mHandle(other.mHandle) {
+		other.mHandle = nullptr;
+	}
+
+	Co& operator =(Co&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			mHandle = other.mHandle;
+			other.mHandle = nullptr;
+		}
+		return *this;
+	}
+
+	~Co() {
+		Reset();
+	}
+
+	bool IsValid() const {
+		return (bool)mHandle;
+	}
+
+	bool IsDone() const {
+		return mHandle && mHandle.done();
+	}
+
+	// start without waiting, the frame frees itself when done
+	void Detach() {
+		Handle handle = mHandle;
+		mHandle = nullptr;
+		handle.promise().mDetached = true;
+		handle.resume();
+	}
+
+	// result of a finished coroutine
+	decltype(auto) TakeResult() {
+		return mHandle.promise().TakeResult();
+	}
+
+	struct Awaiter {
+		Handle mHandle;
+
+		bool await_ready() noexcept {
+			return false;
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			mHandle.promise().mContinuation = awaiting;
+			return mHandle;
+		}
+
+		decltype(auto) await_resume() {
+			return mHandle.promise().TakeResult();
+		}
+	};
+
+	Awaiter operator co_await() && noexcept {
+		return Awaiter{ mHandle };
+	}
+
+	Awaiter operator co_await() & noexcept {
+		return Awaiter{ mHandle };
+	}
+
+private:
+	template<typename U>
+	friend class WhenAllAwaiter;
+
+	void Reset() {
+		if (mHandle) {
+			mHandle.destroy();
+			mHandle = nullptr;
+		}
+	}
+
+	Handle mHandle;
+
+	Co(Co const&) = delete;
+	void operator =(Co const&) = delete;
+};
+
+namespace detail {
+
+template<typename T>
+inline Co<T> CoPromise<T>::get_return_object() {
+	return Co<T>(Co<T>::Handle::from_promise(*this));
+}
+
+inline Co<void> CoPromise<void>::get_return_object() {
+	return Co<void>(Co<void>::Handle::from_promise(*this));
+}
+
+}	// namespace detail
+
+
+/*
+co_await queue.Schedule() continues the coroutine on that queue.
+if the thread is already running that queue it goes on in place, no post.
+*/
+class ScheduleAwaiter {
+public:
+	explicit ScheduleAwaiter(ITaskQueue* queue) : mQueue(queue) {}
+
+	bool await_ready() noexcept {
+		return GetCurrentTaskQueue() == mQueue;
+	}
+
+	void await_suspend(std::coroutine_handle<> h) {
+		// 8 bytes of capture, stays inline in Task
+		mQueue->Post([h]() { h.resume(); });
+	}
+
+	void await_resume() noexcept {}
+
+private:
+	ITaskQueue* mQueue;
+};
+
+
+// run all coroutines at once, resume when the last one finishes
+template<typename T>
+class WhenAllAwaiter {
+public:
+	explicit WhenAllAwaiter(std::vector<Co<T>>& cos) : mCos(cos) {}
+
+	bool await_ready() noexcept {
+		return mCos.empty();
+	}
+
+	bool await_suspend(std::coroutine_handle<> awaiting) {
+		// one extra count, so no child resumes us before all are started
+		mCount = (int)mCos.size() + 1;
+		for (Co<T>& co : mCos) {
+			co.mHandle.promise().mContinuation = awaiting;
+			co.mHandle.promise().mJoinCount = &mCount;
+			co.mHandle.resume();
+		}
+		// all finished in place, don't suspend
+		return mCount.fetch_sub(1) != 1;
+	}
+
+	void await_resume() noexcept {}
+
+private:
+	std::vector<Co<T>>& mCos;
+	std::atomic<int> mCount{ 0 };
+};
+
+template<typename T>
+Co<std::vector<T>> WhenAll(std::vector<Co<T>> cos) {
+	co_await WhenAllAwaiter<T>(cos);
+	std::vector<T> results;
+	results.reserve(cos.size());
+	for (Co<T>& co : cos) {
+		results.push_back(co.TakeResult());
+	}
+	co_return results;
+}
+
+inline Co<void> WhenAll(std::vector<Co<void>> cos) {
+	co_await WhenAllAwaiter<void>(cos);
+	for (Co<void>& co : cos) {
+		co.TakeResult();
+	}
+}
+
+}	// namespace sched
+}	// namespace z
+
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <Core/Platform/OSHeader.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace z {
+namespace sched {
+
+// pause instruction for spin loops
+inline void CpuRelax() {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/*
+Eventcount, lets threads sleep on "no work" without a lock on the post path.
+
+	waiter: key = PrepareWait() --> check work again --> Wait(key) or CancelWait()
+	poster: publish work --> NotifyOne()/NotifyAll()
+
+both sides go through a seq_cst operation between publishing and checking, so
+either the waiter sees the work, or the poster sees the waiter and bumps the
+epoch, and then Wait(key) returns at once. posting costs one fence and one
+load when nobody sleeps.
+*/
+class EventCount {
+public:
+	typedef uint32_t Key;
+
+	Key PrepareWait() {
+		mWaiters.fetch_add(1, std::memory_order_seq_cst);
+		return mEpoch.load(std::memory_order_seq_cst);
+	}
+
+	void CancelWait() {
+		mWaiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	void Wait(Key key) {
+		while (mEpoch.load(std::memory_order_acquire) == key) {
+			WaitOnEpoch(key, K_INFINITE);
+		}
+		mWaiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	// Wait with a timeout, may return early, callers check their condition again
+	void WaitFor(Key key, uint64_t micros) {
+		if (mEpoch.load(std::memory_order_acquire) == key) {
+			WaitOnEpoch(key, micros);
+		}
+		mWaiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	void NotifyOne() {
+		Notify(false);
+	}
+
+	void NotifyAll() {
+		Notify(true);
+	}
+
+	int GetWaiterNum() const {
+		return (int)mWaiters.load(std::memory_order_relaxed);
+	}
+
+private:
+	static const uint64_t K_INFINITE = ~uint64_t(0);
+
+	void Notify(bool all) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (mWaiters.load(std::memory_order_seq_cst) == 0) {
+			return;
+		}
+		mEpoch.fetch_add(1, std::memory_order_seq_cst);
+		WakeOnEpoch(all);
+	}
+
+#if defined(_WIN32)
+	void WaitOnEpoch(Key key, uint64_t micros) {
+		DWORD millis = micros == K_INFINITE ? INFINITE : (DWORD)std::min<uint64_t>((micros + 999) / 1000, INFINITE - 1);
+		WaitOnAddress(&mEpoch, &key, sizeof(Key), millis);
+	}
+
+	void WakeOnEpoch(bool all) {
+		all ? WakeByAddressAll(&mEpoch) : WakeByAddressSingle(&mEpoch);
+	}
+#elif defined(__linux__)
+	void WaitOnEpoch(Key key, uint64_t micros) {
+		timespec timeout;
+		timeout.tv_sec = (time_t)(micros / 1000000);
+		timeout.tv_nsec = (long)(micros % 1000000) * 1000;
+		syscall(SYS_futex, (uint32_t*)&mEpoch, FUTEX_WAIT_PRIVATE, key,
+			micros == K_INFINITE ? nullptr : &timeout, nullptr, 0);
+	}
+
+	void WakeOnEpoch(bool all) {
+		syscall(SYS_futex, (uint32_t*)&mEpoch, FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, nullptr, nullptr, 0);
+	}
+#else
+	void WaitOnEpoch(Key key, uint64_t micros) {
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto notified = [this, key]() { return mEpoch.load() != key; };
+		if (micros == K_INFINITE) {
+			mCond.wait(lock, notified);
+		} else {
+			mCond.wait_for(lock, std::chrono::microseconds(micros), notified);
+		}
+	}
+
+	void WakeOnEpoch(bool all) {
+		std::unique_lock<std::mutex> lock(mMutex);
+		all ? mCond.notify_all() : mCond.notify_one();
+	}
+
+	std::mutex mMutex;
+	std::condition_variable mCond;
+#endif
+
+	std::atomic<Key> mEpoch{ 0 };
+	std::atomic<uint32_t> mWaiters{ 0 };
+};
+
+}	// namespace sched
+}	// namespace z
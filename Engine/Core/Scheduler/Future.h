@@ -0,0 +1,368 @@
+#pragma once
+
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Service.h"
+
+namespace z {
+namespace sched {
+
+class StrandScheduler;
+class ParallelScheduler;
+
+template<typename T>
+class Future;
+
+namespace detail {
+
+// value of a future, nothing for void
+template<typename T>
+struct FutureValue {
+	std::optional<T> Value;
+
+	template<typename U>
+	void Set(U&& value) {
+		Value.emplace(std::forward<U>(value));
+	}
+
+	T Take() {
+		return std::move(*Value);
+	}
+};
+
+template<>
+struct FutureValue<void> {
+	void Take() {}
+};
+
+/*
+State shared by a future and whoever completes it, freed with the last ref.
+at most one continuation, it is posted to its queue once the state is ready.
+
+	producer: set value --> stage.exchange(READY) --> post continuation if one was set
+	Then: store continuation --> stage CAS EMPTY -> CONTINUATION, failed means ready, post now
+*/
+template<typename T>
+class FutureState : public FutureValue<T> {
+private:
+	enum {
+		STAGE_EMPTY = 0,
+		STAGE_CONTINUATION,
+		STAGE_READY,
+	};
+	typedef NodePool<FutureState> Pool;
+
+public:
+	static FutureState* New(Service* service) {
+		return Pool::New(service);
+	}
+
+	explicit FutureState(Service* service) : mService(service) {}
+
+	void Retain() {
+		mRefs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Release() {
+		if (mRefs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Pool::Delete(this);
+		}
+	}
+
+	bool IsReady() const {
+		return mStage.load(std::memory_order_acquire) == STAGE_READY;
+	}
+
+	Service* GetService() const {
+		return mService;
+	}
+
+	void SetError(std::exception_ptr error) {
+		mError = error;
+	}
+
+	void RethrowIfError() {
+		if (mError) {
+			std::rethrow_exception(mError);
+		}
+	}
+
+	std::exception_ptr GetError() const {
+		return mError;
+	}
+
+	// after the value or error is set
+	void Complete() {
+		if (mStage.exchange(STAGE_READY, std::memory_order_acq_rel) == STAGE_CONTINUATION) {
+			PostContinuation();
+		}
+		mEvent.NotifyAll();
+	}
+
+	void SetContinuation(ITaskQueue* queue, Task&& task) {
+		mContinuationQueue = queue;
+		mContinuation = std::move(task);
+		int stage = STAGE_EMPTY;
+		if (!mStage.compare_exchange_strong(stage, STAGE_CONTINUATION, std::memory_order_acq_rel)) {
+			PostContinuation();
+		}
+	}
+
+	EventCount& GetEvent() {
+		return mEvent;
+	}
+
+private:
+	void PostContinuation() {
+		mContinuationQueue->Post(std::move(mContinuation));
+	}
+
+	std::atomic<int> mRefs{ 2 };
+	std::atomic<int> mStage{ STAGE_EMPTY };
+	std::exception_ptr mError;
+	Service* mService;
+	ITaskQueue* mContinuationQueue{ nullptr };
+	Task mContinuation;
+	EventCount mEvent;
+};
+
+// set by a task dropped before it ran, e.g. by Service::Stop(false)
+inline std::exception_ptr BrokenFutureError() {
+	return std::make_exception_ptr(std::runtime_error("sched::Future broken, its task was dropped"));
+}
+
+// call f, with the value of `from` if it has one, and put the result into `to`
+template<typename R, typename F, typename... Args>
+void CompleteWith(FutureState<R>* to, F& f, Args&&... args) {
+	try {
+		if constexpr (std::is_void_v<R>) {
+			f(std::forward<Args>(args)...);
+		} else {
+			to->Set(f(std::forward<Args>(args)...));
+		}
+	} catch (...) {
+		to->SetError(std::current_exception());
+	}
+	to->Complete();
+}
+
+// task of PostPar, owns the producer ref of its state
+template<typename R, typename F>
+class FutureTask {
+public:
+	FutureTask(FutureState<R>* state, F&& f) : mState(state), mFunc(std::move(f)) {}
+
+	FutureTask(FutureTask&& other) noexcept : mState(other.mState), mFunc(std::move(other.mFunc)) {
+		other.mState = nullptr;
+	}
+
+	~FutureTask() {
+		if (mState) {
+			mState->SetError(BrokenFutureError());
+			mState->Complete();
+			mState->Release();
+		}
+	}
+
+	void operator()() {
+		FutureState<R>* state = mState;
+		mState = nullptr;
+		CompleteWith(state, mFunc);
+		state->Release();
+	}
+
+private:
+	FutureState<R>* mState;
+	F mFunc;
+};
+
+// task of Then, owns the ref of the future it continues and the producer ref of the next one
+template<typename T, typename R, typename F>
+class ContinuationTask {
+public:
+	ContinuationTask(FutureState<T>* from, FutureState<R>* to, F&& f) : mFrom(from), mTo(to), mFunc(std::move(f)) {}
+
+	ContinuationTask(ContinuationTask&& other) noexcept :
+		mFrom(other.mFrom), mTo(other.mTo), mFunc(std::move(other.mFunc)) {
+		other.mFrom = nullptr;
+		other.mTo = nullptr;
+	}
+
+	~ContinuationTask() {
+		if (mTo) {
+			mTo->SetError(BrokenFutureError());
+			mTo->Complete();
+			mTo->Release();
+		}
+		if (mFrom) {
+			mFrom->Release();
+		}
+	}
+
+	void operator()() {
+		FutureState<T>* from = mFrom;
+		FutureState<R>* to = mTo;
+		mFrom = nullptr;
+		mTo = nullptr;
+
+		// errors skip the continuation and go on down the chain
+		if (from->GetError()) {
+			to->SetError(from->GetError());
+			to->Complete();
+		} else if constexpr (std::is_void_v<T>) {
+			CompleteWith(to, mFunc);
+		} else {
+			CompleteWith(to, mFunc, from->Take());
+		}
+		from->Release();
+		to->Release();
+	}
+
+private:
+	FutureState<T>* mFrom;
+	FutureState<R>* mTo;
+	F mFunc;
+};
+
+template<typename T, typename F>
+struct ThenResult {
+	typedef std::invoke_result_t<F&, T> Type;
+};
+
+template<typename F>
+struct ThenResult<void, F> {
+	typedef std::invoke_result_t<F&> Type;
+};
+
+}	// namespace detail
+
+
+// spins before a thread outside of workers sleeps in Future::Wait
+const uint32_t K_FUTURE_SPIN = 256;
+
+/*
+Result of a task posted with PostPar, move only.
+
+	Future<Mesh> mesh = io.PostPar([path]() { return LoadMesh(path); });
+	mesh.Then(renderStrand, [](Mesh m) { Upload(m); });
+
+Then consumes the future, the continuation is posted to the given scheduler
+once the result is ready and gets the value (or nothing for void). errors
+thrown by a task skip the continuations after it and come out of Get().
+
+Wait() inside a task runs other waiting queues of the service instead of
+blocking the worker. don't wait on a task queued behind the calling strand,
+it never runs.
+*/
+template<typename T>
+class Future {
+public:
+	typedef detail::FutureState<T> State;
+
+	Future() {}
+	explicit Future(State* state) : mState(state) {}
+
+	Future(Future&& other) noexcept : mState(other.mState) {
+		other.mState = nullptr;
+	}
+
+	Future& operator =(Future&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			mState = other.mState;
+			other.mState = nullptr;
+		}
+		return *this;
+	}
+
+	~Future() {
+		Reset();
+	}
+
+	bool IsValid() const {
+		return mState != nullptr;
+	}
+
+	bool IsReady() const {
+		return mState && mState->IsReady();
+	}
+
+	void Wait() {
+		Service* service = mState->GetService();
+		uint32_t spin = 0;
+		while (!mState->IsReady()) {
+			if (service && service->RunPendingQueue()) {
+				spin = 0;
+				continue;
+			}
+			// workers never sleep here, tasks they could run may come any time
+			if (GetCurrentTaskQueue() != nullptr || spin < K_FUTURE_SPIN) {
+				CpuRelax();
+				if ((++spin & 63) == 0) {
+					std::this_thread::yield();
+				}
+				continue;
+			}
+
+			EventCount& event = mState->GetEvent();
+			EventCount::Key key = event.PrepareWait();
+			if (mState->IsReady()) {
+				event.CancelWait();
+				break;
+			}
+			event.Wait(key);
+		}
+	}
+
+	// wait, then take the result or rethrow the task's error
+	T Get() {
+		Wait();
+		mState->RethrowIfError();
+		return mState->Take();
+	}
+
+	// defined in Scheduler.h
+	template<typename F>
+	Future<typename detail::ThenResult<T, std::decay_t<F>>::Type> Then(StrandScheduler& strand, F&& f);
+	template<typename F>
+	Future<typename detail::ThenResult<T, std::decay_t<F>>::Type> Then(ParallelScheduler& parallel, F&& f);
+
+	// post f to queue, the future of its result
+	template<typename F>
+	static Future Post(ITaskQueue* queue, Service* service, F&& f) {
+		State* state = State::New(service);
+		queue->Post(detail::FutureTask<T, std::decay_t<F>>(state, std::forward<F>(f)));
+		return Future(state);
+	}
+
+private:
+	template<typename F>
+	Future<typename detail::ThenResult<T, std::decay_t<F>>::Type> ThenOn(ITaskQueue* queue, Service* service, F&& f) {
+		typedef typename detail::ThenResult<T, std::decay_t<F>>::Type R;
+		CHECK(mState, "Then on an empty future.");
+		typename Future<R>::State* next = Future<R>::State::New(service);
+		State* state = mState;
+		mState = nullptr;
+		state->SetContinuation(queue, detail::ContinuationTask<T, R, std::decay_t<F>>(state, next, std::forward<F>(f)));
+		return Future<R>(next);
+	}
+
+	void Reset() {
+		if (mState) {
+			mState->Release();
+			mState = nullptr;
+		}
+	}
+
+	State* mState{ nullptr };
+
+	Future(Future const&) = delete;
+	void operator =(Future const&) = delete;
+};
+
+}	// namespace sched
+}	// namespace z
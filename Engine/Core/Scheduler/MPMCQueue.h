@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+#include <Core/Common/Define.h>
+
+namespace z {
+namespace sched {
+
+/*
+Bounded lock free multi producer multi consumer queue (D. Vyukov).
+
+every cell has a sequence number:
+	seq == pos       cell is free for the producer of pos
+	seq == pos + 1   cell is filled for the consumer of pos
+producers and consumers only contend on their own position counter.
+*/
+template<typename T>
+class MPMCQueue {
+private:
+	struct Cell {
+		std::atomic<size_t> Sequence;
+		T Data;
+	};
+
+public:
+	// capacity must be power of 2
+	MPMCQueue(size_t capacity) :
+		mBuffer(new Cell[capacity]),
+		mMask(capacity - 1) {
+		CHECK(capacity >= 2 && (capacity & (capacity - 1)) == 0, "MPMCQueue capacity must be power of 2.");
+		for (size_t i = 0; i < capacity; i++) {
+			mBuffer[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~MPMCQueue() {
+		delete[] mBuffer;
+	}
+
+	size_t Capacity() const {
+		return mMask + 1;
+	}
+
+	// return false when full, data is not moved in that case
+	bool TryPush(T&& data) {
+		Cell* cell;
+		size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &mBuffer[pos & mMask];
+			size_t seq = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = mEnqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->Data = std::move(data);
+		cell->Sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// return false when empty
+	bool TryPop(T& data) {
+		Cell* cell;
+		size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &mBuffer[pos & mMask];
+			size_t seq = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (dif == 0) {
+				if (mDequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = mDequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		data = std::move(cell->Data);
+		cell->Sequence.store(pos + mMask + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	Cell* const mBuffer;
+	size_t const mMask;
+
+	alignas(64) std::atomic<size_t> mEnqueuePos{ 0 };
+	alignas(64) std::atomic<size_t> mDequeuePos{ 0 };
+
+	MPMCQueue(MPMCQueue const&) = delete;
+	void operator =(MPMCQueue const&) = delete;
+};
+
+}	// namespace sched
+}	// namespace z
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+
+namespace z {
+namespace sched {
+
+/*
+Fixed size node allocator for task queues.
+
+nodes are usually allocated on the post thread and freed on the sched thread,
+so every thread keeps a free list and hands over whole batches through a
+locked global list. after warm up New/Delete don't touch the heap, and the
+lock is taken once per BatchSize nodes at most.
+
+chunks are freed when the program exits, so leak checkers stay quiet. queues
+held by statics must be gone (or never posted to) by then
+*/
+template<typename T, size_t BatchSize = 64>
+class NodePool {
+private:
+	union Slot {
+		Slot* Next;
+		alignas(T) unsigned char Storage[sizeof(T)];
+	};
+
+	struct Batch {
+		Slot* Head;
+		size_t Count;
+	};
+
+	struct GlobalPool {
+		std::mutex Mutex;
+		std::vector<Batch> Batches;
+		// every chunk handed out, freed with the pool
+		std::vector<std::unique_ptr<Slot[]>> Chunks;
+	};
+
+	struct LocalCache {
+		Slot* Head{ nullptr };
+		size_t Count{ 0 };
+
+		~LocalCache() {
+			// give everything back when the thread exits
+			if (Head) {
+				std::unique_lock<std::mutex> lock(sGlobal.Mutex);
+				sGlobal.Batches.push_back({ Head, Count });
+			}
+		}
+	};
+
+public:
+	template<typename... Args>
+	static T* New(Args&&... args) {
+		return new (Alloc()) T(std::forward<Args>(args)...);
+	}
+
+	static void Delete(T* node) {
+		node->~T();
+		Free(node);
+	}
+
+private:
+	static void* Alloc() {
+		LocalCache& cache = sCache;
+		if (cache.Head == nullptr) {
+			Refill(cache);
+		}
+		Slot* slot = cache.Head;
+		cache.Head = slot->Next;
+		cache.Count--;
+		return slot;
+	}
+
+	static void Free(void* node) {
+		LocalCache& cache = sCache;
+		Slot* slot = (Slot*)node;
+		slot->Next = cache.Head;
+		cache.Head = slot;
+		if (++cache.Count >= BatchSize * 2) {
+			Flush(cache);
+		}
+	}
+
+	static void Refill(LocalCache& cache) {
+		{
+			std::unique_lock<std::mutex> lock(sGlobal.Mutex);
+			if (sGlobal.Batches.size() > 0) {
+				Batch batch = sGlobal.Batches.back();
+				sGlobal.Batches.pop_back();
+				cache.Head = batch.Head;
+				cache.Count = batch.Count;
+				return;
+			}
+		}
+
+		// pool is dry, grow by one chunk
+		Slot* chunk = new Slot[BatchSize];
+		{
+			std::unique_lock<std::mutex> lock(sGlobal.Mutex);
+			sGlobal.Chunks.emplace_back(chunk);
+		}
+		for (size_t i = 0; i + 1 < BatchSize; i++) {
+			chunk[i].Next = &chunk[i + 1];
+		}
+		chunk[BatchSize - 1].Next = nullptr;
+		cache.Head = chunk;
+		cache.Count = BatchSize;
+	}
+
+	static void Flush(LocalCache& cache) {
+		// detach BatchSize slots from the local list
+		Slot* head = cache.Head;
+		Slot* tail = head;
+		for (size_t i = 1; i < BatchSize; i++) {
+			tail = tail->Next;
+		}
+		cache.Head = tail->Next;
+		cache.Count -= BatchSize;
+		tail->Next = nullptr;
+
+		std::unique_lock<std::mutex> lock(sGlobal.Mutex);
+		sGlobal.Batches.push_back({ head, BatchSize });
+	}
+
+	inline static GlobalPool sGlobal;
+	inline static thread_local LocalCache sCache;
+};
+
+}	// namespace sched
+}	// namespace z
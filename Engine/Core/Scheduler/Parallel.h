@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Scheduler.h"
+
+namespace z {
+namespace sched {
+
+// default grain, ranges this small run serially and pieces are never split below it
+const size_t K_PARALLEL_GRAIN = 1024;
+// split depth on top of log2(workers), a stolen piece gets this much again
+const int K_PARALLEL_SPLIT_DEPTH = 2;
+// chunks per thread of reduce, scan and sort
+const size_t K_PARALLEL_CHUNKS = 4;
+
+namespace detail {
+
+/* pieces left of a parallel call, the caller's own piece included.
+   the thread in Wait helps the service, the last piece notifies then sets done,
+   nothing touches the counter after that (it lives on the caller's stack)
+*/
+class ForkJoin {
+public:
+	explicit ForkJoin(Service& service) : mService(service) {}
+
+	void Fork() {
+		mPending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Join() {
+		if (mPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			mEvent.NotifyAll();
+			mDone.store(true, std::memory_order_release);
+		}
+	}
+
+	void Wait() {
+		uint32_t spin = 0;
+		while (!mDone.load(std::memory_order_acquire)) {
+			if (mService.RunPendingQueue()) {
+				spin = 0;
+				continue;
+			}
+			if (mPending.load(std::memory_order_acquire) == 0 || spin < K_WORKER_SPIN_MAX) {
+				spin++;
+				CpuRelax();
+				continue;
+			}
+			// workers don't sleep here, see Future::Wait
+			if (GetCurrentTaskQueue() != nullptr) {
+				std::this_thread::yield();
+				continue;
+			}
+			EventCount::Key key = mEvent.PrepareWait();
+			if (mPending.load(std::memory_order_acquire) == 0) {
+				mEvent.CancelWait();
+				continue;
+			}
+			mEvent.Wait(key);
+		}
+	}
+
+private:
+	Service& mService;
+	std::atomic<int> mPending{ 1 };
+	std::atomic<bool> mDone{ false };
+	EventCount mEvent;
+};
+
+template<typename Body>
+struct ForContext {
+	ForContext(ParallelScheduler& sc, Body& body, size_t grain) :
+		Sched(sc), Func(body), Grain(grain), Join(sc.GetWorker()->GetService()) {
+	}
+
+	ParallelScheduler& Sched;
+	Body& Func;
+	size_t Grain;
+	ForkJoin Join;
+};
+
+/* lazy binary splitting: halve the range, post the upper half, keep the lower.
+   a piece run by another thread than its poster was stolen, somebody is idle,
+   so it may split deeper
+*/
+template<typename Body>
+void RunForRange(ForContext<Body>* ctx, size_t begin, size_t end, int depth, std::thread::id poster) {
+	std::thread::id self = std::this_thread::get_id();
+	if (self != poster) {
+		depth += K_PARALLEL_SPLIT_DEPTH;
+	}
+	while (end - begin > ctx->Grain && depth > 0) {
+		size_t mid = begin + (end - begin) / 2;
+		depth--;
+		ctx->Join.Fork();
+		ctx->Sched.PostPar([ctx, mid, end, depth, self]() {
+			RunForRange(ctx, mid, end, depth, self);
+		});
+		end = mid;
+	}
+	ctx->Func(begin, end);
+	ctx->Join.Join();
+}
+
+inline int SplitDepth(ParallelScheduler& sc) {
+	int depth = 0;
+	// the waiting thread helps, one more than the workers
+	for (int n = sc.GetWorker()->GetService().GetWorkerNum() + 1; n > 1; n = (n + 1) / 2) {
+		depth++;
+	}
+	return depth + K_PARALLEL_SPLIT_DEPTH;
+}
+
+// chunks of reduce, scan and sort, 1 for a serial run
+inline size_t ChunkNum(ParallelScheduler& sc, size_t num, size_t grain) {
+	size_t threads = (size_t)sc.GetWorker()->GetService().GetWorkerNum() + 1;
+	size_t byGrain = (num + std::max<size_t>(grain, 1) - 1) / std::max<size_t>(grain, 1);
+	return std::max<size_t>(1, std::min(byGrain, threads * K_PARALLEL_CHUNKS));
+}
+
+// [begin, end) of chunk c out of chunks over num items
+inline std::pair<size_t, size_t> ChunkRange(size_t num, size_t chunks, size_t c) {
+	return std::make_pair(num * c / chunks, num * (c + 1) / chunks);
+}
+
+}	// namespace detail
+
+
+/*
+Loops on the workers of sc, the calling thread helps and returns when all is
+done. inputs up to grain items run serially on the caller, bigger ones are
+split adaptively: a few pieces per thread, more where pieces get stolen.
+bodies run concurrently and must not throw.
+
+	ParallelForRange(sc, 0, n, [&](size_t begin, size_t end) { ... });
+	ParallelFor(sc, 0, n, [&](size_t i) { out[i] = f(in[i]); });
+*/
+template<typename Body>
+void ParallelForRange(ParallelScheduler& sc, size_t begin, size_t end, Body&& body, size_t grain = K_PARALLEL_GRAIN) {
+	if (end <= begin) {
+		return;
+	}
+	grain = std::max<size_t>(grain, 1);
+	if (end - begin <= grain) {
+		body(begin, end);
+		return;
+	}
+	detail::ForContext<std::remove_reference_t<Body>> ctx(sc, body, grain);
+	detail::RunForRange(&ctx, begin, end, detail::SplitDepth(sc), std::this_thread::get_id());
+	ctx.Join.Wait();
+}
+
+template<typename Body>
+void ParallelFor(ParallelScheduler& sc, size_t begin, size_t end, Body&& body, size_t grain = K_PARALLEL_GRAIN) {
+	ParallelForRange(sc, begin, end, [&body](size_t b, size_t e) {
+		for (size_t i = b; i < e; i++) {
+			body(i);
+		}
+	}, grain);
+}
+
+/* range(begin, end, T init) folds a sub range onto init, combine(T, T) joins
+   two partials. partials are combined left to right in a fixed chunking, so
+   the result doesn't change from run to run (float sums included)
+*/
+template<typename T, typename Range, typename Combine>
+T ParallelReduce(ParallelScheduler& sc, size_t begin, size_t end, const T& identity,
+	Range&& range, Combine&& combine, size_t grain = K_PARALLEL_GRAIN) {
+	size_t num = end > begin ? end - begin : 0;
+	size_t chunks = detail::ChunkNum(sc, num, grain);
+	if (chunks <= 1) {
+		return range(begin, end, identity);
+	}
+
+	std::vector<T> partials(chunks, identity);
+	ParallelFor(sc, 0, chunks, [&](size_t c) {
+		std::pair<size_t, size_t> r = detail::ChunkRange(num, chunks, c);
+		partials[c] = range(begin + r.first, begin + r.second, identity);
+	}, 1);
+
+	T result = std::move(partials[0]);
+	for (size_t c = 1; c < chunks; c++) {
+		result = combine(std::move(result), std::move(partials[c]));
+	}
+	return result;
+}
+
+/* inclusive scan, out[i] = op(...op(op(identity, in[0]), in[1])..., in[i]).
+   op has to be associative, out may be first (in place)
+*/
+template<typename InIt, typename OutIt, typename T, typename Op>
+void ParallelScan(ParallelScheduler& sc, InIt first, InIt last, OutIt out, const T& identity,
+	Op&& op, size_t grain = K_PARALLEL_GRAIN) {
+	size_t num = (size_t)std::distance(first, last);
+	size_t chunks = detail::ChunkNum(sc, num, grain);
+	if (chunks <= 1) {
+		T acc = identity;
+		for (size_t i = 0; i < num; i++) {
+			acc = op(acc, first[i]);
+			out[i] = acc;
+		}
+		return;
+	}
+
+	// total of each chunk, then scan again from the totals before it
+	std::vector<T> totals(chunks, identity);
+	ParallelFor(sc, 0, chunks, [&](size_t c) {
+		std::pair<size_t, size_t> r = detail::ChunkRange(num, chunks, c);
+		T acc = identity;
+		for (size_t i = r.first; i < r.second; i++) {
+			acc = op(acc, first[i]);
+		}
+		totals[c] = acc;
+	}, 1);
+
+	T carry = identity;
+	for (size_t c = 0; c < chunks; c++) {
+		T total = totals[c];
+		totals[c] = carry;
+		carry = op(carry, total);
+	}
+
+	ParallelFor(sc, 0, chunks, [&](size_t c) {
+		std::pair<size_t, size_t> r = detail::ChunkRange(num, chunks, c);
+		T acc = totals[c];
+		for (size_t i = r.first; i < r.second; i++) {
+			acc = op(acc, first[i]);
+			out[i] = acc;
+		}
+	}, 1);
+}
+
+/* merge sort, not stable. chunks are sorted with std::sort, then merged in
+   pairs, a merge split at pivots of its left run so the last passes still
+   spread over the threads. contiguous ranges only, values must be default
+   constructible and movable
+*/
+template<typename It, typename Less>
+void ParallelSort(ParallelScheduler& sc, It first, It last, Less less, size_t grain = K_PARALLEL_GRAIN) {
+	typedef typename std::iterator_traits<It>::value_type Value;
+	size_t num = (size_t)std::distance(first, last);
+	size_t chunks = detail::ChunkNum(sc, num, grain);
+	if (chunks <= 1) {
+		std::sort(first, last, less);
+		return;
+	}
+
+	ParallelFor(sc, 0, chunks, [&](size_t c) {
+		std::pair<size_t, size_t> r = detail::ChunkRange(num, chunks, c);
+		std::sort(first + r.first, first + r.second, less);
+	}, 1);
+
+	std::vector<Value> buffer(num);
+	Value* data = &*first;
+	Value* src = data;
+	Value* dst = buffer.data();
+	for (size_t width = 1; width < chunks; width *= 2) {
+		size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+		size_t parts = std::max<size_t>(1, chunks / pairs);
+		ParallelFor(sc, 0, pairs * parts, [&](size_t task) {
+			size_t pair = task / parts;
+			size_t part = task % parts;
+			size_t lo = detail::ChunkRange(num, chunks, pair * 2 * width).first;
+			size_t mid = detail::ChunkRange(num, chunks, std::min(chunks, pair * 2 * width + width) - 1).second;
+			size_t hi = detail::ChunkRange(num, chunks, std::min(chunks, pair * 2 * width + 2 * width) - 1).second;
+
+			// part takes left [a0, a1) and the right values below left[a1]
+			size_t leftNum = mid - lo;
+			size_t a0 = lo + leftNum * part / parts;
+			size_t a1 = lo + leftNum * (part + 1) / parts;
+			size_t b0 = part == 0 ? mid : (size_t)(std::lower_bound(src + mid, src + hi, src[a0], less) - src);
+			size_t b1 = part + 1 == parts ? hi : (size_t)(std::lower_bound(src + mid, src + hi, src[a1], less) - src);
+			std::merge(std::make_move_iterator(src + a0), std::make_move_iterator(src + a1),
+				std::make_move_iterator(src + b0), std::make_move_iterator(src + b1),
+				dst + (a0 - lo) + (b0 - mid) + lo, less);
+		}, 1);
+		std::swap(src, dst);
+	}
+
+	if (src != data) {
+		ParallelForRange(sc, 0, num, [&](size_t b, size_t e) {
+			std::move(src + b, src + e, data + b);
+		});
+	}
+}
+
+}	// namespace sched
+}	// namespace z
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace z {
+namespace sched {
+
+/*
+Growable FIFO ring, not thread safe.
+
+unlike std::list/std::deque it doesn't allocate per push once it has
+grown to the working size.
+*/
+template<typename T>
+class RingBuffer {
+public:
+	RingBuffer(size_t capacity = 64) : mBuffer(capacity) {}
+
+	size_t size() const {
+		return mCount;
+	}
+
+	T& front() {
+		return mBuffer[mHead];
+	}
+
+	void push_back(const T& item) {
+		if (mCount == mBuffer.size()) {
+			Grow();
+		}
+		mBuffer[(mHead + mCount) % mBuffer.size()] = item;
+		mCount++;
+	}
+
+	void pop_front() {
+		mHead = (mHead + 1) % mBuffer.size();
+		mCount--;
+	}
+
+private:
+	void Grow() {
+		std::vector<T> buffer(mBuffer.size() * 2);
+		for (size_t i = 0; i < mCount; i++) {
+			buffer[i] = mBuffer[(mHead + i) % mBuffer.size()];
+		}
+		mBuffer.swap(buffer);
+		mHead = 0;
+	}
+
+	std::vector<T> mBuffer;
+	size_t mHead{ 0 };
+	size_t mCount{ 0 };
+};
+
+}	// namespace sched
+}	// namespace z
@@ -2,6 +2,8 @@
 
 #include "Service.h"
 #include "Worker.h"
+#include "Co.h"
+#include "Future.h"
 
 namespace z {
 namespace sched {
@@ -11,38 +13,127 @@ public:
 	Scheduler(Worker* worker) : mWorker(worker) {
 	}
 
+	Worker* GetWorker() {
+		return mWorker;
+	}
+
 protected:
 	Worker* mWorker{ nullptr };
 };
 
 class StrandScheduler : public Scheduler {
 public:
-	StrandScheduler(Worker* worker) :
+	StrandScheduler(Worker* worker, ETaskPriority priority = PRIORITY_NORMAL) :
 		Scheduler(worker), 
-		mTaskQueue(mWorker->GetService()) {
+		mTaskQueue(mWorker->GetService(), priority) {
+	}
+
+	// timers may still point at the strand, see Service::AddTimer
+	~StrandScheduler() {
+		if (mTimed) {
+			mWorker->GetService().CancelTimers(&mTaskQueue);
+			mTaskQueue.WaitIdle();
+		}
 	}
+
 	void PostStrand(Task&& task) {
 		mTaskQueue.Post(std::forward<Task>(task));
 	}
 
+	// see Service::AddTimer
+	TimerHandle PostStrandAfter(std::chrono::microseconds delay, Task&& task) {
+		mTimed = true;
+		return mWorker->GetService().AddTimer(&mTaskQueue, delay, std::chrono::microseconds(0), std::forward<Task>(task));
+	}
+
+	// first run after one period
+	TimerHandle PostStrandEvery(std::chrono::microseconds period, Task&& task) {
+		mTimed = true;
+		return mWorker->GetService().AddTimer(&mTaskQueue, period, period, std::forward<Task>(task));
+	}
+
+#if Z_SCHED_COROUTINE
+	// co_await to continue on the strand
+	ScheduleAwaiter Schedule() {
+		return ScheduleAwaiter(&mTaskQueue);
+	}
+#endif
+
+	// see StrandTaskQueue::SetDrainQuantum
+	void SetStrandDrainQuantum(uint32_t tasks, uint32_t micros) {
+		mTaskQueue.SetDrainQuantum(tasks, micros);
+	}
+
+	// see TaskQueue::SetName
+	void SetStrandName(const char* name) {
+		mTaskQueue.SetName(name);
+	}
+
 private:
+	template<typename T>
+	friend class Future;
+
 	StrandTaskQueue mTaskQueue;
+	std::atomic<bool> mTimed{ false };
 };
 
 
 class ParallelScheduler : public Scheduler{
 public:
-	ParallelScheduler(Worker* worker) :
+	ParallelScheduler(Worker* worker, ETaskPriority priority = PRIORITY_NORMAL) :
 		Scheduler(worker),
-		mTaskQueue(mWorker->GetService()) {
+		mTaskQueue(mWorker->GetService(), priority) {
+	}
+
+	// timers may still point at the queue, see Service::AddTimer
+	~ParallelScheduler() {
+		if (mTimed) {
+			mWorker->GetService().CancelTimers(&mTaskQueue);
+			mTaskQueue.WaitIdle();
+		}
 	}
 
 	void PostPar(Task&& task) {
 		mTaskQueue.Post(std::forward<Task>(task));
 	}
 
+	// tasks with a result, void ones take the overload above
+	template<typename F, typename R = std::invoke_result_t<std::decay_t<F>&>,
+		typename = std::enable_if_t<!std::is_void_v<R>>>
+	Future<R> PostPar(F&& f) {
+		return Future<R>::Post(&mTaskQueue, &mWorker->GetService(), std::forward<F>(f));
+	}
+
+	// see Service::AddTimer
+	TimerHandle PostParAfter(std::chrono::microseconds delay, Task&& task) {
+		mTimed = true;
+		return mWorker->GetService().AddTimer(&mTaskQueue, delay, std::chrono::microseconds(0), std::forward<Task>(task));
+	}
+
+	// first run after one period
+	TimerHandle PostParEvery(std::chrono::microseconds period, Task&& task) {
+		mTimed = true;
+		return mWorker->GetService().AddTimer(&mTaskQueue, period, period, std::forward<Task>(task));
+	}
+
+#if Z_SCHED_COROUTINE
+	// co_await to continue on a worker
+	ScheduleAwaiter Schedule() {
+		return ScheduleAwaiter(&mTaskQueue);
+	}
+#endif
+
+	// see TaskQueue::SetName
+	void SetParName(const char* name) {
+		mTaskQueue.SetName(name);
+	}
+
 protected:
+	template<typename T>
+	friend class Future;
+
 	ParallelTaskQueue mTaskQueue;
+	std::atomic<bool> mTimed{ false };
 };
 
 
@@ -50,11 +141,22 @@ protected:
 class ComplexScheduler:
 	public ParallelScheduler, public StrandScheduler {
 public:
-	ComplexScheduler(Worker* worker) :
-		ParallelScheduler(worker), StrandScheduler(worker) {
+	ComplexScheduler(Worker* worker, ETaskPriority priority = PRIORITY_NORMAL) :
+		ParallelScheduler(worker, priority), StrandScheduler(worker, priority) {
 	}
 };
 
+template<typename T>
+template<typename F>
+Future<typename detail::ThenResult<T, std::decay_t<F>>::Type> Future<T>::Then(StrandScheduler& strand, F&& f) {
+	return ThenOn(&strand.mTaskQueue, &strand.mWorker->GetService(), std::forward<F>(f));
+}
+
+template<typename T>
+template<typename F>
+Future<typename detail::ThenResult<T, std::decay_t<F>>::Type> Future<T>::Then(ParallelScheduler& parallel, F&& f) {
+	return ThenOn(&parallel.mTaskQueue, &parallel.mWorker->GetService(), std::forward<F>(f));
+}
 
 }	// namespace sched
 }	// namespace z
\ No newline at end of file
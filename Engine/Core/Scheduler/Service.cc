@@ -1,63 +1,599 @@
 #include "Service.h"
+#include "Stats.h"
+
+#include <thread>
+#include <chrono>
+#include <algorithm>
 
 namespace z {
 namespace sched {
 
-Service::Service() {}
+// worker slot of current thread when running a work stealing service
+static thread_local Service* tCurService = nullptr;
+static thread_local int tCurWorkerIdx = -1;
+// queue running on current thread
+static thread_local ITaskQueue* tCurTaskQueue = nullptr;
+
+ITaskQueue* GetCurrentTaskQueue() {
+	return tCurTaskQueue;
+}
+
+Service::Service(EServiceMode mode, int workerNum) :
+	mMode(mode),
+	mWorkerNum(workerNum),
+	mBackgroundLimit(std::max(1, workerNum - 1)),
+	mTimerEpoch(std::chrono::steady_clock::now()) {
+	if (IsWorkStealing()) {
+		for (int p = 0; p < PRIORITY_NUM; p++) {
+			for (int i = 0; i < mWorkerNum; i++) {
+				mDeques[p].emplace_back(new WorkStealingDeque<ITaskQueue*>());
+			}
+		}
+	}
+}
 
 void Service::Run() {
-	while (true) {
-		ITaskQueue* q = nullptr;
-		{
-			std::unique_lock<std::mutex> lock(mWaitQueueMutex);
-			while (mWaitQueue.size() == 0) {
-				mWaitQueueCond.wait(lock);
-			} 
-			q = mWaitQueue.front();
-			if (q->ShouldPopWhenSched()) {
-				mWaitQueue.pop_front();
+	IsWorkStealing() ? RunWorkStealing() : RunSharedQueue();
+}
+
+void Service::Stop(bool drain) {
+	if (!drain) {
+		mCancelled = true;
+	}
+	mStopping = true;
+	mEvent.NotifyAll();
+}
+
+template<typename FindFunc>
+ITaskQueue* Service::WaitTaskQueue(FindFunc find, uint32_t& spinLimit) {
+	while (!mCancelled) {
+		PollTimers();
+
+		ITaskQueue* q = find();
+		if (q) {
+			return q;
+		}
+
+		// spin a while before parking, longer if spinning found work last time
+		for (uint32_t i = 0; i < spinLimit && q == nullptr; i++) {
+			for (int j = 0; j < 8; j++) {
+				CpuRelax();
+			}
+			q = find();
+		}
+		if (q) {
+			spinLimit = std::min(spinLimit * 2, K_WORKER_SPIN_MAX);
+			return q;
+		}
+		spinLimit = std::max(spinLimit / 2, K_WORKER_SPIN_MIN);
+
+		/* check again after prepare wait.
+			post thread: push queue --> NotifyOne()
+			this thread: PrepareWait() --> find() --> Wait()
+		   a post after find() bumps the epoch and Wait() returns at once.
+		*/
+		EventCount::Key key = mEvent.PrepareWait();
+		if ((q = find()) != nullptr) {
+			mEvent.CancelWait();
+			return q;
+		}
+		if (mStopping) {
+			mEvent.CancelWait();
+			return nullptr;
+		}
+		Park(key);
+	}
+	return nullptr;
+}
+
+void Service::Park(EventCount::Key key) {
+	/* one parked worker keeps the timers, it sleeps until the next due.
+	   others sleep until notified. a timer armed before the keeper's due
+	   notifies, and the woken worker takes over as keeper.
+	*/
+	uint64_t due = mTimerDue.load();
+	uint64_t keeperDue = mKeeperDue.load();
+	if (mTimerNum.load() == 0 || due >= keeperDue || !mKeeperDue.compare_exchange_strong(keeperDue, due)) {
+		mEvent.Wait(key);
+		return;
+	}
+
+	uint64_t dueMicros = due * K_TIMER_TICK_MICROS;
+	uint64_t nowMicros = GetTimerMicros();
+	mEvent.WaitFor(key, dueMicros > nowMicros ? dueMicros - nowMicros : 0);
+	mKeeperDue.compare_exchange_strong(due, ~uint64_t(0));
+}
+
+void Service::RunSharedQueue() {
+	uint32_t spinLimit = K_WORKER_SPIN_MIN;
+	bool held = false;
+	auto find = [this, &held]() {
+		return ReleaseBackground(TakeSharedQueue(held), held);
+	};
+	while (ITaskQueue* q = WaitTaskQueue(find, spinLimit)) {
+		RunTaskQueue(q, held);
+	}
+	ReleaseBackground(nullptr, held);
+}
+
+void Service::RunWorkStealing() {
+	int self = mRegisteredWorkers.fetch_add(1);
+	CHECK(self < mWorkerNum, "Too many threads run work stealing service.");
+
+	tCurService = this;
+	tCurWorkerIdx = self;
+	uint32_t seed = 2654435761u * (self + 1);
+	uint32_t tick = 0;
+	uint32_t spinLimit = K_WORKER_SPIN_MIN;
+
+	bool held = false;
+	auto find = [this, self, &seed, &tick, &held]() {
+		return ReleaseBackground(FindTaskQueue(self, seed, tick, held), held);
+	};
+	while (ITaskQueue* q = WaitTaskQueue(find, spinLimit)) {
+		RunTaskQueue(q, held);
+	}
+	ReleaseBackground(nullptr, held);
+
+	tCurService = nullptr;
+	tCurWorkerIdx = -1;
+}
+
+bool Service::RunPendingQueue() {
+	if (mCancelled.load()) {
+		return false;
+	}
+
+	static thread_local uint32_t tHelpSeed = 2654435761u;
+	uint32_t tick = 1;
+	bool held = false;
+	ITaskQueue* q = nullptr;
+	if (!IsWorkStealing()) {
+		q = TakeSharedQueue(held);
+	} else if (tCurService == this) {
+		q = FindTaskQueue(tCurWorkerIdx, tHelpSeed, tick, held);
+	} else {
+		// not a worker, no deque of its own. leave background queues to workers
+		for (int priority = 0; priority < PRIORITY_BACKGROUND && q == nullptr; priority++) {
+			if ((q = PopInjectQueue(priority)) == nullptr) {
+				q = StealTaskQueue(-1, priority, tHelpSeed);
+			}
+		}
+	}
+	if (q == nullptr) {
+		return false;
+	}
+	RunTaskQueue(q, held);
+	ReleaseBackground(nullptr, held);
+	return true;
+}
+
+void Service::RunTaskQueue(ITaskQueue* q, bool& held) {
+	// read before OnSched, q may be gone once its tasks are done
+	bool background = q->GetPriority() == PRIORITY_BACKGROUND;
+	q->OnSched();
+	held = background;
+}
+
+bool Service::TryEnterBackground(bool& held) {
+	if (held) {
+		held = false;
+		return true;
+	}
+	int running = mBackgroundRunning.load();
+	while (running < mBackgroundLimit) {
+		if (mBackgroundRunning.compare_exchange_weak(running, running + 1)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+ITaskQueue* Service::ReleaseBackground(ITaskQueue* found, bool& held) {
+	if (held) {
+		held = false;
+		mBackgroundRunning.fetch_sub(1);
+		// moved on to other work, a worker held back by the limit may take the slot
+		if (found) {
+			mEvent.NotifyOne();
+		}
+	}
+	return found;
+}
+
+void Service::PushWaitQueue(ITaskQueue* q) {
+	std::unique_lock<std::mutex> lock(mWaitQueueMutex);
+	mWaitQueue[q->GetPriority()].push_back(q);
+	mWaitQueueNum.fetch_add(1);
+	mPriorityNum[q->GetPriority()].fetch_add(1);
+}
+
+ITaskQueue* Service::TakeSharedQueue(bool& held) {
+	if (mWaitQueueNum.load() == 0) {
+		return nullptr;
+	}
+
+	ITaskQueue* q = nullptr;
+	bool stay = false;
+	{
+		std::unique_lock<std::mutex> lock(mWaitQueueMutex);
+		// highest priority first
+		int priority = 0;
+		while (priority < PRIORITY_NUM && mWaitQueue[priority].size() == 0) {
+			priority++;
+		}
+		if (priority == PRIORITY_NUM) {
+			return nullptr;
+		}
+		if (priority == PRIORITY_BACKGROUND && !TryEnterBackground(held)) {
+			return nullptr;
+		}
+
+		RingBuffer<ITaskQueue*>& queue = mWaitQueue[priority];
+		q = queue.front();
+		stay = !q->ShouldPopWhenSched();
+		if (!stay) {
+			queue.pop_front();
+			mWaitQueueNum.fetch_sub(1);
+			mPriorityNum[priority].fetch_sub(1);
+		} else {
+			q->OnTakenShared();
+		}
+	}
+
+	// a parallel queue stays for others, wake one more worker to help.
+	// workers join one by one while it has tasks, instead of all at once
+	if (stay) {
+		mEvent.NotifyOne();
+	}
+	return q;
+}
+
+ITaskQueue* Service::PopInjectQueue(int priority) {
+	if (mWaitQueueNum.load() == 0) {
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> lock(mWaitQueueMutex);
+	RingBuffer<ITaskQueue*>& queue = mWaitQueue[priority];
+	if (queue.size() == 0) {
+		return nullptr;
+	}
+	ITaskQueue* q = queue.front();
+	queue.pop_front();
+	mWaitQueueNum.fetch_sub(1);
+	mPriorityNum[priority].fetch_sub(1);
+	return q;
+}
+
+ITaskQueue* Service::StealTaskQueue(int self, int priority, uint32_t& seed) {
+	// xorshift, start from a random victim
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+
+	ITaskQueue* q = nullptr;
+	std::vector<std::unique_ptr<WorkStealingDeque<ITaskQueue*>>>& deques = mDeques[priority];
+	for (int i = 0; i < mWorkerNum; i++) {
+		int victim = (seed + i) % mWorkerNum;
+		if (victim == self) {
+			continue;
+		}
+		// steal fails when racing with others, retry until the deque is empty
+		while (!deques[victim]->Empty()) {
+			if (deques[victim]->Steal(q)) {
+#if Z_SCHED_STATS
+				Stats::OnSteal(true);
+#endif
+				return q;
+			}
+		}
+	}
+#if Z_SCHED_STATS
+	Stats::OnSteal(false);
+#endif
+	return nullptr;
+}
+
+ITaskQueue* Service::FindTaskQueue(int self, uint32_t& seed, uint32_t& tick, bool& held) {
+	tick++;
+	ITaskQueue* q = nullptr;
+	for (int priority = 0; priority < PRIORITY_NUM && q == nullptr; priority++) {
+		if (priority != PRIORITY_BACKGROUND) {
+			q = FindTaskQueue(self, priority, seed, tick);
+		} else if (TryEnterBackground(held)) {
+			if ((q = FindTaskQueue(self, priority, seed, tick)) == nullptr) {
+				mBackgroundRunning.fetch_sub(1);
 			}
 		}
+	}
+	return q;
+}
 
-		if (q) q->OnSched();
+ITaskQueue* Service::FindTaskQueue(int self, int priority, uint32_t& seed, uint32_t& tick) {
+	ITaskQueue* q = nullptr;
+	// look at injection queue first now and then, or a busy deque starves it
+	if ((tick & 31) == 0 && (q = PopInjectQueue(priority)) != nullptr) {
+		return q;
+	}
+	if (mDeques[priority][self]->Pop(q)) {
+		return q;
 	}
+	if ((q = PopInjectQueue(priority)) != nullptr) {
+		return q;
+	}
+	return StealTaskQueue(self, priority, seed);
 }
 
 void Service::AddWaitingTaskQueue(ITaskQueue* q) {
-	mWaitQueueMutex.lock();
-	mWaitQueue.push_back(q);
-	mWaitQueueMutex.unlock();
+	if (IsWorkStealing() && tCurService == this) {
+		mDeques[q->GetPriority()][tCurWorkerIdx]->Push(q);
+	} else {
+		PushWaitQueue(q);
+	}
+	// wake one parked worker, not all of them
+	mEvent.NotifyOne();
+}
 
-	q->SingleTheradSched() ?
-		mWaitQueueCond.notify_one() :
-		mWaitQueueCond.notify_all();
+void Service::YieldTaskQueue(ITaskQueue* q) {
+	// not to own deque, it is LIFO and would pick q again at once
+	PushWaitQueue(q);
+	mEvent.NotifyOne();
+}
+
+
+// === Timer ===
+bool TimerHandle::Cancel() {
+	std::shared_ptr<Service> service = mService.lock();
+	return service ? service->CancelTimer(mIndex, mGen) : false;
+}
+
+uint64_t Service::GetTimerMicros() const {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - mTimerEpoch).count();
+}
+
+TimerHandle Service::AddTimer(ITaskQueue* q, std::chrono::microseconds delay,
+	std::chrono::microseconds period, Task&& task) {
+	uint64_t delayMicros = std::max<int64_t>(delay.count(), 0);
+	uint64_t periodTicks = 0;
+	if (period.count() > 0) {
+		periodTicks = std::max<uint64_t>((period.count() + K_TIMER_TICK_MICROS - 1) / K_TIMER_TICK_MICROS, 1);
+	}
+
+	bool wake = false;
+	uint32_t index = 0, gen = 0;
+	{
+		std::unique_lock<std::mutex> lock(mTimersMutex);
+		// round up, never fire early
+		uint64_t now = GetTimerMicros();
+		uint64_t due = (now + delayMicros + K_TIMER_TICK_MICROS - 1) / K_TIMER_TICK_MICROS;
+		// an empty wheel may lag far behind, catch up before inserting
+		if (mTimers.Size() == 0) {
+			mTimers.Advance(now / K_TIMER_TICK_MICROS, [](uint32_t) {});
+		}
+
+		index = mTimers.Alloc();
+		gen = mTimers.GetGen(index);
+		Timer& timer = mTimers.GetPayload(index);
+		timer.call = std::forward<Task>(task);
+		timer.queue = q;
+		timer.period = periodTicks;
+		timer.cancelled = false;
+		wake = ArmTimer(index, due);
+	}
+
+	if (wake) {
+		mEvent.NotifyOne();
+	}
+	return TimerHandle(mTimerOwner, index, gen);
+}
+
+bool Service::ArmTimer(uint32_t index, uint64_t due) {
+	mTimers.Insert(index, due);
+	mTimerNum = mTimers.Size();
+	if (due < mTimerDue.load()) {
+		mTimerDue = due;
+	}
+	// the keeper (if any) sleeps past the new due
+	return due < mKeeperDue.load();
+}
+
+bool Service::CancelTimer(uint32_t index, uint32_t gen) {
+	std::unique_lock<std::mutex> lock(mTimersMutex);
+	if (mTimers.GetGen(index) != gen) {
+		return false;
+	}
+	Timer& timer = mTimers.GetPayload(index);
+	if (timer.cancelled) {
+		return false;
+	}
+
+	if (mTimers.IsLinked(index)) {
+		mTimers.Remove(index);
+		mTimerNum = mTimers.Size();
+		FreeTimer(index, timer);
+		return true;
+	}
+
+	// posted but not finished, RunTimer frees it.
+	// a one shot timer already running has claimed the flag, see RunTimer
+	return !timer.cancelled.exchange(true);
+}
+
+void Service::CancelTimers(ITaskQueue* q) {
+	std::unique_lock<std::mutex> lock(mTimersMutex);
+	// free nodes have no queue
+	for (uint32_t index = 0; index < mTimers.Capacity(); index++) {
+		Timer& timer = mTimers.GetPayload(index);
+		if (timer.queue != q) {
+			continue;
+		}
+		if (mTimers.IsLinked(index)) {
+			mTimers.Remove(index);
+			FreeTimer(index, timer);
+		} else {
+			timer.cancelled = true;
+		}
+	}
+	mTimerNum = mTimers.Size();
+}
+
+void Service::FreeTimer(uint32_t index, Timer& timer) {
+	timer.call.Reset();
+	timer.queue = nullptr;
+	mTimers.Free(index);
+}
+
+void Service::PollTimers() {
+	if (mTimerNum.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+	uint64_t now = GetTimerMicros() / K_TIMER_TICK_MICROS;
+	if (now < mTimerDue.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// someone else is turning the wheel
+	std::unique_lock<std::mutex> lock(mTimersMutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+	mTimers.Advance(now, [this](uint32_t index) {
+		Timer* timer = &mTimers.GetPayload(index);
+		timer->queue->Post([this, index, timer]() { RunTimer(index, timer); });
+	});
+	mTimerNum = mTimers.Size();
+	mTimerDue = mTimers.GetNextDue();
+}
+
+void Service::RunTimer(uint32_t index, Timer* timer) {
+	// nodes don't move, timer stays valid until freed below.
+	// a one shot timer sets the flag itself, so Cancel can't claim it after the run starts
+	bool run = timer->period == 0 ? !timer->cancelled.exchange(true) : !timer->cancelled;
+	if (run) {
+		timer->call();
+	}
+
+	bool wake = false;
+	{
+		std::unique_lock<std::mutex> lock(mTimersMutex);
+		if (timer->period == 0 || timer->cancelled || mStopping) {
+			FreeTimer(index, *timer);
+			return;
+		}
+
+		// next period after now, skip the missed ones
+		uint64_t now = GetTimerMicros() / K_TIMER_TICK_MICROS;
+		uint64_t due = mTimers.GetDue(index) + timer->period;
+		if (due <= now) {
+			due += ((now - due) / timer->period + 1) * timer->period;
+		}
+		wake = ArmTimer(index, due);
+	}
+
+	if (wake) {
+		mEvent.NotifyOne();
+	}
+}
+
+
+// === Task Queue ===
+TaskQueue::TaskQueue(Service& service, ETaskPriority priority, const char* kind) :
+	mService(service),
+	mPriority(priority) {
+#if Z_SCHED_STATS
+	mStats = Stats::AddQueue(kind, priority);
+#else
+	(void)kind;
+#endif
+}
+
+TaskQueue::~TaskQueue() {
+#if Z_SCHED_STATS
+	Stats::RemoveQueue(mStats);
+#endif
+}
+
+void TaskQueue::SetName(const char* name) {
+#if Z_SCHED_STATS
+	Stats::SetQueueName(mStats, name);
+#else
+	(void)name;
+#endif
 }
 
 
 // === Starnd Task Queue === 
 void StrandTaskQueue::Post(Task&& task) {
-	// insert task node before head
-	Node* new_node = new Node(std::forward<Task>(task));
-	new_node->next = mTasksHead.load();
-	// if task_head == new_node->next, task_head = new_node
-	// if task_head != new_node->next, new_node->next = task_head 
-	while (!mTasksHead.compare_exchange_weak(new_node->next, new_node));
+	Node* node = Pool::New(std::forward<Task>(task));
+#if Z_SCHED_STATS
+	node->postTime = Stats::Now();
+#endif
+	PushNode(node);
 
 	// add to service if accu == 0
-	if (mAccu.fetch_add(1) == 0) {
+	int accu = mAccu.fetch_add(1);
+#if Z_SCHED_STATS
+	Stats::OnPost(mStats, accu + 1);
+#endif
+	if (accu == 0) {
 		mService.AddWaitingTaskQueue(this);
 	}
 }
 
-StrandTaskQueue::Node* StrandTaskQueue::ReverseListOrder(Node* cur, Node** head) {
-	cur->next ? ReverseListOrder(cur->next, head)->next = cur : *head = cur;
-	return cur;
+void StrandTaskQueue::PushNode(Node* node) {
+	node->next.store(nullptr, std::memory_order_relaxed);
+	Node* prev = mTasksHead.exchange(node, std::memory_order_acq_rel);
+	// between exchange and store the list is broken, PopNode sees it as empty
+	prev->next.store(node, std::memory_order_release);
+}
+
+StrandTaskQueue::~StrandTaskQueue() {
+	// tasks left by a cancelled service
+	while (Node* node = PopNode()) {
+		Pool::Delete(node);
+	}
+}
+
+StrandTaskQueue::Node* StrandTaskQueue::PopNode() {
+	Node* tail = mTasksTail;
+	Node* next = tail->next.load(std::memory_order_acquire);
+
+	// skip stub
+	if (tail == &mStub) {
+		if (next == nullptr) {
+			return nullptr;
+		}
+		mTasksTail = next;
+		tail = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next) {
+		mTasksTail = next;
+		return tail;
+	}
+
+	// tail is not the last one, a post is in progress
+	if (tail != mTasksHead.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+
+	// tail is the last one, push stub behind so tail can be taken
+	PushNode(&mStub);
+	next = tail->next.load(std::memory_order_acquire);
+	if (next) {
+		mTasksTail = next;
+		return tail;
+	}
+	return nullptr;
 }
 
 void StrandTaskQueue::OnSched() {
 	/* if post(task) in another thread when scheduler.
 			post thread: add task --> accu.fetch_add()
-			sched thread: accu.load() --> swap tasks --> run tasks --> accu.compare()
+			sched thread: accu.load() --> pop tasks --> run tasks --> accu.compare()
 
 		1. accu.fetch_add() << accu.load() << accu.compare().
 			the task already append to queue and will be called later, no need to enter wait queue again.
@@ -65,28 +601,53 @@ void StrandTaskQueue::OnSched() {
 			compare fail and enter wait queue again here.
 		3. accu.load() << accu.compare() << accu.fetch_add().
 			compare ok and accu set to zero, enter wait queue in post thred.
+
+		a post still in progress stops PopNode early, its fetch_add comes later and
+		falls into case 2 or 3.
 	*/
 
 	bool true_ = true, false_ = false;
 	CHECK(mInSched.compare_exchange_strong(false_, true), "Strand enter sched failed.");
 
 	int cur_accu = mAccu.load();
-	Node* head = mTasksHead.exchange(nullptr);
+	ITaskQueue* prevQueue = tCurTaskQueue;
+	tCurTaskQueue = this;
 
-	// call all tasks in reversed order
-	if (head) {
-		ReverseListOrder(head, &head)->next = nullptr;
-		while (head) {
-			Node* old_head = head;
-			head = head->next;
+	// call tasks in post order until the drain quantum is used up
+	std::chrono::steady_clock::time_point begin;
+	if (mDrainMicros > 0) {
+		begin = std::chrono::steady_clock::now();
+	}
+	uint32_t count = 0;
+	bool quantumOut = false;
+	while (Node* node = PopNode()) {
+#if Z_SCHED_STATS
+		uint64_t start = Stats::Now();
+		node->call();
+		Stats::OnRun(mStats, node->postTime, start, Stats::Now());
+#else
+		node->call();
+#endif
+		Pool::Delete(node);
 
-			old_head->call();
-			delete old_head;
+		count++;
+		if ((mDrainTasks > 0 && count >= mDrainTasks) ||
+			(mDrainMicros > 0 && std::chrono::steady_clock::now() - begin >= std::chrono::microseconds(mDrainMicros)) ||
+			mService.ShouldYield(mPriority)) {
+			quantumOut = true;
+			break;
 		}
 	}
 
+	tCurTaskQueue = prevQueue;
 	CHECK(mInSched.compare_exchange_strong(true_, false), "Strand leave sched failed.");
 
+	// tasks left, accu stays non zero so posts won't add it again
+	if (quantumOut) {
+		mService.YieldTaskQueue(this);
+		return;
+	}
+
 	// if accu == cur_accu, set accu == 0 and do nothing
 	// if accu != cur_accu, add to service
 	if (!mAccu.compare_exchange_strong(cur_accu, 0)) {
@@ -95,33 +656,135 @@ void StrandTaskQueue::OnSched() {
 };
 
 
+void StrandTaskQueue::WaitIdle() {
+	CHECK(GetCurrentTaskQueue() != this, "StrandTaskQueue waits for itself.");
+	// OnSched zeroes accu last, nothing touches the strand after it
+	while (mAccu.load(std::memory_order_acquire) != 0) {
+		if (mService.IsCancelled()) {
+			if (!mInSched.load(std::memory_order_acquire)) {
+				return;
+			}
+			std::this_thread::yield();
+		} else if (!mService.RunPendingQueue()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+
 // === Parallel Task Queue === 
 void ParallelTaskQueue::Post(Task&& task) {
-	std::unique_lock<std::mutex> lock(mTasksListMutex);
-	mTasksList.emplace_back(task);
-	if (++mTasksNum == 1) {
+	Entry entry(std::forward<Task>(task));
+#if Z_SCHED_STATS
+	entry.postTime = Stats::Now();
+#endif
+	if (!mTasks.TryPush(std::move(entry))) {
+		std::unique_lock<std::mutex> lock(mOverflowMutex);
+		mOverflowTasks.emplace_back(std::move(entry));
+		mOverflowNum.fetch_add(1);
+	}
+
+	// count after the task is visible, whoever moves the count 0 -> 1 requeues it
+	int num = ++mTasksNum;
+#if Z_SCHED_STATS
+	Stats::OnPost(mStats, num);
+#endif
+	if (mService.IsWorkStealing()) {
+		// one ticket per task, idle workers steal them one by one
+		mRefs.fetch_add(1);
 		mService.AddWaitingTaskQueue(this);
+	} else if (num == 1) {
+		mRefs.fetch_add(1);
+		mService.AddWaitingTaskQueue(this);
+	}
+}
+
+ParallelTaskQueue::~ParallelTaskQueue() {
+	WaitIdle();
+}
+
+void ParallelTaskQueue::WaitIdle() {
+	CHECK(GetCurrentTaskQueue() != this, "ParallelTaskQueue waits for itself.");
+	while (!IsIdle()) {
+		if (mService.IsCancelled()) {
+			if (mRunning.load(std::memory_order_acquire) == 0) {
+				return;
+			}
+			std::this_thread::yield();
+		} else if (!mService.RunPendingQueue()) {
+			std::this_thread::yield();
+		}
 	}
 }
 
+bool ParallelTaskQueue::PopTask(Entry& entry) {
+	if (mTasks.TryPop(entry)) {
+		return true;
+	}
+	if (mOverflowNum.load() > 0) {
+		std::unique_lock<std::mutex> lock(mOverflowMutex);
+		if (mOverflowTasks.size() > 0) {
+			entry = std::move(mOverflowTasks.front());
+			mOverflowTasks.pop_front();
+			mOverflowNum.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ParallelTaskQueue::RunTask(Entry& entry) {
+#if Z_SCHED_STATS
+	uint64_t start = Stats::Now();
+	entry.call();
+	Stats::OnRun(mStats, entry.postTime, start, Stats::Now());
+#else
+	entry.call();
+#endif
+}
+
 void ParallelTaskQueue::OnSched() {
-	while (true) {
-		std::unique_lock<std::mutex> lock(mTasksListMutex);
-		if (mTasksList.size() == 0) {
+	// the entry or the shared take this call came with is given back at the end,
+	// after it nothing touches the queue but mRunning
+	mRunning.fetch_add(1);
+	Entry entry;
+	ITaskQueue* prevQueue = tCurTaskQueue;
+	if (mService.IsWorkStealing()) {
+		// each ticket runs only one task
+		if (!PopTask(entry)) {
+			// the ticket's task is still being pushed by another thread (ring slot
+			// taken but not published yet), pass the ticket on instead of losing it.
+			// the ticket keeps its ref
+			std::this_thread::yield();
+			mService.AddWaitingTaskQueue(this);
+			mRunning.fetch_sub(1, std::memory_order_release);
 			return;
 		}
-		Task task = std::forward<Task>(mTasksList.front());
-		mTasksList.pop_front();
 		--mTasksNum;
+		tCurTaskQueue = this;
+		RunTask(entry);
+		tCurTaskQueue = prevQueue;
+		mRefs.fetch_sub(1, std::memory_order_release);
+		mRunning.fetch_sub(1, std::memory_order_release);
+		return;
+	}
 
-		lock.unlock();
-
-		task();
+	// the queue stays in the wait queue while it has tasks, so stopping early is fine
+	tCurTaskQueue = this;
+	while (PopTask(entry)) {
+		--mTasksNum;
+		RunTask(entry);
+		if (mService.ShouldYield(mPriority)) {
+			break;
+		}
 	}
+	tCurTaskQueue = prevQueue;
+	mRefs.fetch_sub(1, std::memory_order_release);
+	mRunning.fetch_sub(1, std::memory_order_release);
 };
 
 
 
 
 }
-}
\ No newline at end of file
+}
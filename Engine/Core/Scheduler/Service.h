@@ -7,15 +7,36 @@
 #include <unordered_set>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <chrono>
+#include <algorithm>
 
 #include <Core/CoreHeader.h>
-
+#include "EventCount.h"
+#include "WorkStealingDeque.h"
+#include "MPMCQueue.h"
+#include "NodePool.h"
+#include "RingBuffer.h"
+#include "Task.h"
+#include "TimerWheel.h"
+
+// scheduler stats and tracing (see Stats.h), off by default
+#ifndef Z_SCHED_STATS
+#define Z_SCHED_STATS 0
+#endif
 
 namespace z {
 namespace sched {
 
-// Task
-typedef std::function<void()> Task;
+// queues of higher priority are scheduled first
+enum ETaskPriority {
+	// must finish this frame
+	PRIORITY_CRITICAL = 0,
+	PRIORITY_NORMAL,
+	// streaming, decoding..., never takes all workers (see Service::SetBackgroundWorkerLimit)
+	PRIORITY_BACKGROUND,
+	PRIORITY_NUM,
+};
 
 // TaskQueue Interface
 class ITaskQueue {
@@ -25,23 +46,209 @@ public:
 	virtual void OnSched() = 0;
 
 	virtual bool ShouldPopWhenSched() = 0;
+	// a worker took the queue and left it waiting for others (ShouldPopWhenSched
+	// false), under the service's lock. its OnSched follows
+	virtual void OnTakenShared() = 0;
 	virtual bool SingleTheradSched() = 0;
+	virtual ETaskPriority GetPriority() = 0;
 private:
 
 };
 
+// queue whose task the calling thread is running, nullptr outside of tasks
+ITaskQueue* GetCurrentTaskQueue();
+
 
 // Service
+enum EServiceMode {
+	// all workers share one locked wait queue
+	SERVICE_SHARED_QUEUE = 0,
+	// every worker owns a deque and steals from others when idle,
+	// queues posted from outside go through the injection queue (mWaitQueue)
+	SERVICE_WORK_STEALING,
+};
+
+// spin rounds before a worker parks, adapted between min and max
+const uint32_t K_WORKER_SPIN_MIN = 4;
+const uint32_t K_WORKER_SPIN_MAX = 64;
+
+// timer resolution, timers fire on the first tick at or after their due time
+const uint32_t K_TIMER_TICK_MICROS = 1000;
+
+class Service;
+class QueueStats;
+
+// returned by timed posts, empty handles are invalid
+class TimerHandle {
+public:
+	TimerHandle() {}
+
+	/* the timer won't fire again, a run already started still finishes.
+		false if it has fired (one shot), was cancelled before or its service is gone
+	*/
+	bool Cancel();
+
+	bool IsValid() const {
+		return !mService.expired();
+	}
+
+private:
+	friend class Service;
+	TimerHandle(const std::weak_ptr<Service>& service, uint32_t index, uint32_t gen) :
+		mService(service),
+		mIndex(index),
+		mGen(gen) {
+	}
+
+	// expires with the service, a handle may outlive it
+	std::weak_ptr<Service> mService;
+	uint32_t mIndex{ 0 };
+	uint32_t mGen{ 0 };
+};
+
 class Service {
 public:
-	Service();
+	Service(EServiceMode mode = SERVICE_SHARED_QUEUE, int workerNum = 1);
+	// return after Stop()
 	void Run();
+	/* ask all Run() to return, a stopped service can't run again.
+		drain: queues posted before Stop (and what they post) still run
+		!drain: pending tasks are dropped, running tasks finish
+	   timers not fired yet are dropped either way
+	*/
+	void Stop(bool drain = true);
+
 	void AddWaitingTaskQueue(ITaskQueue* q);
+	// requeue behind queues posted earlier, used when a queue gives up the thread
+	void YieldTaskQueue(ITaskQueue* q);
+
+	/* post task to q after delay, then every period if period > 0.
+		runs of one timer never overlap, periods missed by a late run are skipped.
+	   q is kept as a raw pointer: before q is destroyed call CancelTimers(q),
+		then let q go idle, a run posted before the cancel still comes to q and
+		frees the timer there. the schedulers do both in their destructors
+	*/
+	TimerHandle AddTimer(ITaskQueue* q, std::chrono::microseconds delay,
+		std::chrono::microseconds period, Task&& task);
+
+	// cancel every timer posting to q, see AddTimer
+	void CancelTimers(ITaskQueue* q);
+
+	/* run one waiting queue on the calling thread, false if none was found.
+		lets a thread waiting for a result help, see Future::Wait
+	*/
+	bool RunPendingQueue();
+
+	bool IsWorkStealing() const {
+		return mMode == SERVICE_WORK_STEALING;
+	}
+
+	int GetWorkerNum() const {
+		return mWorkerNum;
+	}
+
+	// Stop(false) was called, waiting queues won't run any more
+	bool IsCancelled() const {
+		return mCancelled.load();
+	}
+
+	// queues of higher priority are waiting or the service is cancelled, long drains stop early
+	bool ShouldYield(ETaskPriority priority) const {
+		if (mCancelled.load(std::memory_order_relaxed)) {
+			return true;
+		}
+		for (int p = 0; p < priority; p++) {
+			if (mPriorityNum[p].load(std::memory_order_relaxed) > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// at most num workers run background queues at once, default is all workers but one
+	void SetBackgroundWorkerLimit(int num) {
+		mBackgroundLimit = std::max(1, num);
+	}
 
 private:
-	std::list<ITaskQueue*> mWaitQueue;
+	void RunSharedQueue();
+	void RunWorkStealing();
+
+	// spin, then park on mEvent. nullptr when the service stops
+	template<typename FindFunc>
+	ITaskQueue* WaitTaskQueue(FindFunc find, uint32_t& spinLimit);
+
+	/* background slots. after running a background queue a worker holds on to
+	   its slot (held), so the next background queue doesn't need it again and
+	   nobody is woken up for it. the slot is given back when the worker picks
+	   something else.
+	*/
+	void RunTaskQueue(ITaskQueue* q, bool& held);
+	bool TryEnterBackground(bool& held);
+	ITaskQueue* ReleaseBackground(ITaskQueue* found, bool& held);
+
+	void PushWaitQueue(ITaskQueue* q);
+	ITaskQueue* TakeSharedQueue(bool& held);
+	ITaskQueue* PopInjectQueue(int priority);
+	ITaskQueue* StealTaskQueue(int self, int priority, uint32_t& seed);
+	ITaskQueue* FindTaskQueue(int self, uint32_t& seed, uint32_t& tick, bool& held);
+	ITaskQueue* FindTaskQueue(int self, int priority, uint32_t& seed, uint32_t& tick);
+
+	// timers
+	struct Timer {
+		Task call;
+		ITaskQueue* queue{ nullptr };
+		uint64_t period{ 0 };
+		std::atomic<bool> cancelled{ false };
+	};
+
+	friend class TimerHandle;
+	bool CancelTimer(uint32_t index, uint32_t gen);
+	// mTimersMutex held, node unlinked
+	void FreeTimer(uint32_t index, Timer& timer);
+	uint64_t GetTimerMicros() const;
+	// fire due timers, cheap when nothing is due
+	void PollTimers();
+	void RunTimer(uint32_t index, Timer* timer);
+	// mTimersMutex held, true if a parked worker should wake up for it
+	bool ArmTimer(uint32_t index, uint64_t due);
+	// park, sleep no longer than the next timer if no other worker does
+	void Park(EventCount::Key key);
+
+	EServiceMode mMode;
+	int mWorkerNum;
+
+	// shared queues, or injection queues of work stealing. one per priority
+	RingBuffer<ITaskQueue*> mWaitQueue[PRIORITY_NUM];
 	std::mutex mWaitQueueMutex;
-	std::condition_variable mWaitQueueCond;
+	// all priorities, and each priority
+	std::atomic<int> mWaitQueueNum{ 0 };
+	std::atomic<int> mPriorityNum[PRIORITY_NUM] = {};
+
+	// work stealing, mDeques[priority][worker]
+	std::vector<std::unique_ptr<WorkStealingDeque<ITaskQueue*>>> mDeques[PRIORITY_NUM];
+	std::atomic<int> mRegisteredWorkers{ 0 };
+
+	// workers running background queues
+	std::atomic<int> mBackgroundRunning{ 0 };
+	int mBackgroundLimit;
+
+	// timers, the wheel turns on whichever worker polls first
+	TimerWheel<Timer> mTimers;
+	std::mutex mTimersMutex;
+	std::chrono::steady_clock::time_point mTimerEpoch;
+	std::atomic<size_t> mTimerNum{ 0 };
+	std::atomic<uint64_t> mTimerDue{ ~uint64_t(0) };
+	// due tick the timer keeper sleeps until, ~0 when no one keeps timers
+	std::atomic<uint64_t> mKeeperDue{ ~uint64_t(0) };
+
+	// parking
+	EventCount mEvent;
+	std::atomic<bool> mStopping{ false };
+	std::atomic<bool> mCancelled{ false };
+
+	// doesn't own the service, TimerHandles watch it. last member, the first one destroyed
+	std::shared_ptr<Service> mTimerOwner{ this, [](Service*) {} };
 
 	Service(Service const&) = delete;
 	void operator =(Service const&) = delete;
@@ -51,28 +258,59 @@ private:
 // TaskQueue
 class TaskQueue : public ITaskQueue {
 public:
-	TaskQueue(Service& service) : mService(service) {}
+	// kind names the queue in stats until SetName
+	TaskQueue(Service& service, ETaskPriority priority, const char* kind = "queue");
+	~TaskQueue();
+
+	ETaskPriority GetPriority() override {
+		return mPriority;
+	}
+
+	// shown in stats snapshots and traces, does nothing without Z_SCHED_STATS
+	void SetName(const char* name);
+
 protected:
 	Service& mService;
+	ETaskPriority mPriority;
+#if Z_SCHED_STATS
+	QueueStats* mStats{ nullptr };
+#endif
 };
 
 
 // StrandTaskQueue
+// default drain quantum, the strand requeues itself after this many tasks or micro seconds,
+// or as soon as Service::ShouldYield
+const uint32_t K_STRAND_DRAIN_TASKS = 256;
+const uint32_t K_STRAND_DRAIN_MICROS = 1000;
+
 class StrandTaskQueue : public TaskQueue {
 private:
 	struct Node {
 		Task call;
-		Node* next;
-		Node(Task&& call) : call(call), next(nullptr) {}
+		std::atomic<Node*> next{ nullptr };
+#if Z_SCHED_STATS
+		uint64_t postTime{ 0 };
+#endif
+		Node() {}
+		Node(Task&& call) : call(std::move(call)) {}
 	};
+	typedef NodePool<Node> Pool;
 
 public:
-	StrandTaskQueue(Service& service) : TaskQueue(service) {}
+	StrandTaskQueue(Service& service, ETaskPriority priority = PRIORITY_NORMAL) :
+		TaskQueue(service, priority, "strand"),
+		mTasksHead(&mStub),
+		mTasksTail(&mStub) {
+	}
+	~StrandTaskQueue();
 
 	bool ShouldPopWhenSched() override {
 		return true;
 	}
 
+	void OnTakenShared() override {}
+
 	bool SingleTheradSched() override {
 		return true;
 	}
@@ -80,11 +318,29 @@ public:
 	void Post(Task&& task) override;
 	void OnSched();
 
+	/* help the service until no task is queued or running, not from a task of
+	   this strand. once the service is cancelled only a running drain is waited for
+	*/
+	void WaitIdle();
+
+	// 0 means no limit, call before posting
+	void SetDrainQuantum(uint32_t tasks, uint32_t micros) {
+		mDrainTasks = tasks;
+		mDrainMicros = micros;
+	}
+
 private:
-	Node* ReverseListOrder(Node* cur, Node** head);
+	// intrusive mpsc queue (D. Vyukov), post threads push at head, sched thread pops at tail
+	void PushNode(Node* node);
+	Node* PopNode();
 
 	std::atomic<int> mAccu{ 0 };
-	std::atomic<Node*> mTasksHead{ nullptr };
+	std::atomic<Node*> mTasksHead;
+	Node* mTasksTail;
+	Node mStub;
+
+	uint32_t mDrainTasks{ K_STRAND_DRAIN_TASKS };
+	uint32_t mDrainMicros{ K_STRAND_DRAIN_MICROS };
 
 	std::atomic<bool> mInSched{ false };
 };
@@ -92,12 +348,31 @@ private:
 
 // ParallelTaskQueue
 class ParallelTaskQueue : public TaskQueue {
+private:
+	struct Entry {
+		Task call;
+#if Z_SCHED_STATS
+		uint64_t postTime{ 0 };
+#endif
+		Entry() {}
+		Entry(Task&& call) : call(std::move(call)) {}
+	};
 
 public:
-	ParallelTaskQueue(Service& service) : TaskQueue(service) {}
+	ParallelTaskQueue(Service& service, ETaskPriority priority = PRIORITY_NORMAL, size_t capacity = 4096) :
+		TaskQueue(service, priority, "parallel"),
+		mTasks(capacity) {
+	}
+	// waits until idle
+	~ParallelTaskQueue();
 
 	bool ShouldPopWhenSched() override {
-		return mTasksNum == 0;
+		// may be negative for a while, a task can be taken before its post counted
+		return mTasksNum <= 0;
+	}
+
+	void OnTakenShared() override {
+		mRefs.fetch_add(1);
 	}
 
 	bool SingleTheradSched() override {
@@ -107,10 +382,37 @@ public:
 	void Post(Task&& task) override;
 	void OnSched() override;
 
+	/* no worker holds the queue: it isn't waiting in the service and no thread
+	   is in its OnSched. a task may signal its owner while the worker still
+	   runs the queue, the owner waits for this before destroying it
+	*/
+	bool IsIdle() const {
+		return mRefs.load(std::memory_order_acquire) == 0 && mRunning.load(std::memory_order_acquire) == 0;
+	}
+
+	/* help the service until idle, not from a task of this queue. once the
+	   service is cancelled waiting entries never run, only threads in OnSched
+	   are waited for
+	*/
+	void WaitIdle();
+
 private:
-	std::list<Task> mTasksList;
-	std::mutex mTasksListMutex;
+	bool PopTask(Entry& entry);
+	void RunTask(Entry& entry);
+
+	// lock free ring, tasks only go to the locked overflow list when it is full
+	MPMCQueue<Entry> mTasks;
+	std::list<Entry> mOverflowTasks;
+	std::mutex mOverflowMutex;
+	std::atomic<int> mOverflowNum{ 0 };
+
 	std::atomic<int> mTasksNum{0};
+
+	/* entries in the service and workers taking it, one each. OnSched gives
+	   back the one it came with, mRunning is the last thing it touches
+	*/
+	std::atomic<int> mRefs{ 0 };
+	std::atomic<int> mRunning{ 0 };
 };
 
 
@@ -0,0 +1,297 @@
+#include "Stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace z {
+namespace sched {
+
+namespace {
+
+struct TraceEvent {
+	uint32_t Queue;
+	uint64_t Post;
+	uint64_t Start;
+	uint64_t End;
+};
+
+// one per thread that runs tasks, reused after the thread exits
+struct ThreadStats {
+	int Index{ 0 };
+	std::atomic<bool> InUse{ false };
+
+	Histogram Wait[PRIORITY_NUM];
+	Histogram Run[PRIORITY_NUM];
+	std::atomic<uint64_t> Steals{ 0 };
+	std::atomic<uint64_t> StealMisses{ 0 };
+
+	/* trace buffer, filled by the owner only.
+		owner: TraceNum = 0 --> TraceGen = gen (release) --> events --> TraceNum (release)
+		reader: TraceGen (acquire) --> TraceNum (acquire) --> events before TraceNum
+	*/
+	std::unique_ptr<TraceEvent[]> Trace;
+	std::atomic<uint32_t> TraceGen{ 0 };
+	std::atomic<uint32_t> TraceNum{ 0 };
+};
+
+struct Registry {
+	std::mutex Mutex;
+	std::vector<std::unique_ptr<ThreadStats>> Threads;
+	std::vector<QueueStats*> Queues;
+	// names outlive their queues, trace events may still refer to them
+	std::unordered_map<uint32_t, std::string> Names;
+	uint32_t NextQueueId{ 1 };
+
+	std::atomic<bool> Tracing{ false };
+	std::atomic<uint32_t> TraceGen{ 0 };
+};
+
+Registry& GetRegistry() {
+	static Registry registry;
+	return registry;
+}
+
+ThreadStats* AcquireThreadStats() {
+	Registry& registry = GetRegistry();
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	for (std::unique_ptr<ThreadStats>& stats : registry.Threads) {
+		if (!stats->InUse.load()) {
+			stats->InUse = true;
+			return stats.get();
+		}
+	}
+	registry.Threads.emplace_back(new ThreadStats());
+	ThreadStats* stats = registry.Threads.back().get();
+	stats->Index = (int)registry.Threads.size() - 1;
+	stats->InUse = true;
+	return stats;
+}
+
+struct LocalStats {
+	ThreadStats* Stats{ AcquireThreadStats() };
+
+	~LocalStats() {
+		Stats->InUse = false;
+	}
+};
+
+ThreadStats& GetThreadStats() {
+	static thread_local LocalStats local;
+	return *local.Stats;
+}
+
+void WriteJsonString(std::ostream& os, const std::string& s) {
+	os << '"';
+	for (char c : s) {
+		if (c == '"' || c == '\\') {
+			os << '\\' << c;
+		} else if ((unsigned char)c < 0x20) {
+			os << ' ';
+		} else {
+			os << c;
+		}
+	}
+	os << '"';
+}
+
+}
+
+
+// === Histogram ===
+void HistogramSnapshot::Add(const Histogram& h) {
+	for (uint32_t i = 0; i < Histogram::K_BUCKET_NUM; i++) {
+		Buckets[i] += h.mBuckets[i].load(std::memory_order_relaxed);
+	}
+	Count += h.mCount.load(std::memory_order_relaxed);
+	Sum += h.mSum.load(std::memory_order_relaxed);
+	Max = std::max(Max, h.mMax.load(std::memory_order_relaxed));
+}
+
+uint64_t HistogramSnapshot::Percentile(double p) const {
+	if (Count == 0) {
+		return 0;
+	}
+	uint64_t rank = (uint64_t)(p / 100.0 * Count + 0.5);
+	rank = std::min(std::max<uint64_t>(rank, 1), Count);
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i + 1 < Histogram::K_BUCKET_NUM; i++) {
+		seen += Buckets[i];
+		if (seen >= rank) {
+			return std::min(Histogram::BucketLow(i + 1) - 1, Max);
+		}
+	}
+	return Max;
+}
+
+
+// === Stats ===
+QueueStats* Stats::AddQueue(const char* kind, ETaskPriority priority) {
+	Registry& registry = GetRegistry();
+	QueueStats* queue = new QueueStats();
+	queue->Kind = kind;
+	queue->Priority = priority;
+
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	queue->Id = registry.NextQueueId++;
+	registry.Queues.push_back(queue);
+	registry.Names[queue->Id] = std::string(kind) + "#" + std::to_string(queue->Id);
+	return queue;
+}
+
+void Stats::RemoveQueue(QueueStats* queue) {
+	Registry& registry = GetRegistry();
+	{
+		std::unique_lock<std::mutex> lock(registry.Mutex);
+		registry.Queues.erase(std::find(registry.Queues.begin(), registry.Queues.end(), queue));
+	}
+	delete queue;
+}
+
+void Stats::SetQueueName(QueueStats* queue, const char* name) {
+	Registry& registry = GetRegistry();
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	registry.Names[queue->Id] = name;
+}
+
+void Stats::OnRun(QueueStats* queue, uint64_t postTime, uint64_t start, uint64_t end) {
+	ThreadStats& stats = GetThreadStats();
+	stats.Wait[queue->Priority].Record(start > postTime ? start - postTime : 0);
+	stats.Run[queue->Priority].Record(end - start);
+
+	Registry& registry = GetRegistry();
+	if (!registry.Tracing.load(std::memory_order_relaxed)) {
+		return;
+	}
+	uint32_t gen = registry.TraceGen.load(std::memory_order_relaxed);
+	if (stats.TraceGen.load(std::memory_order_relaxed) != gen) {
+		if (!stats.Trace) {
+			stats.Trace.reset(new TraceEvent[K_TRACE_EVENT_NUM]);
+		}
+		stats.TraceNum.store(0, std::memory_order_relaxed);
+		stats.TraceGen.store(gen, std::memory_order_release);
+	}
+	uint32_t num = stats.TraceNum.load(std::memory_order_relaxed);
+	if (num < K_TRACE_EVENT_NUM) {
+		stats.Trace[num] = { queue->Id, postTime, start, end };
+		stats.TraceNum.store(num + 1, std::memory_order_release);
+	}
+}
+
+void Stats::OnSteal(bool got) {
+	ThreadStats& stats = GetThreadStats();
+	std::atomic<uint64_t>& counter = got ? stats.Steals : stats.StealMisses;
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+StatsSnapshot Stats::Snapshot() {
+	Registry& registry = GetRegistry();
+	StatsSnapshot snapshot;
+
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	for (std::unique_ptr<ThreadStats>& stats : registry.Threads) {
+		for (int p = 0; p < PRIORITY_NUM; p++) {
+			snapshot.Wait[p].Add(stats->Wait[p]);
+			snapshot.Run[p].Add(stats->Run[p]);
+		}
+		snapshot.Steals += stats->Steals.load(std::memory_order_relaxed);
+		snapshot.StealMisses += stats->StealMisses.load(std::memory_order_relaxed);
+	}
+	for (QueueStats* queue : registry.Queues) {
+		QueueSnapshot q;
+		q.Id = queue->Id;
+		q.Name = registry.Names[queue->Id];
+		q.Priority = queue->Priority;
+		q.Depth.Add(queue->Depth);
+		snapshot.Queues.push_back(std::move(q));
+	}
+	return snapshot;
+}
+
+void Stats::Reset() {
+	Registry& registry = GetRegistry();
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	for (std::unique_ptr<ThreadStats>& stats : registry.Threads) {
+		for (int p = 0; p < PRIORITY_NUM; p++) {
+			stats->Wait[p].Reset();
+			stats->Run[p].Reset();
+		}
+		stats->Steals.store(0, std::memory_order_relaxed);
+		stats->StealMisses.store(0, std::memory_order_relaxed);
+	}
+	for (QueueStats* queue : registry.Queues) {
+		queue->Depth.Reset();
+	}
+}
+
+void Stats::StartTrace() {
+	Registry& registry = GetRegistry();
+	registry.TraceGen.fetch_add(1);
+	registry.Tracing = true;
+}
+
+void Stats::StopTrace() {
+	GetRegistry().Tracing = false;
+}
+
+void Stats::WriteChromeTrace(std::ostream& os) {
+	Registry& registry = GetRegistry();
+	std::unique_lock<std::mutex> lock(registry.Mutex);
+	uint32_t gen = registry.TraceGen.load();
+
+	// collect first, ts is relative to the earliest event
+	struct ThreadTrace {
+		int Index;
+		const TraceEvent* Events;
+		uint32_t Num;
+	};
+	std::vector<ThreadTrace> traces;
+	uint64_t begin = ~uint64_t(0);
+	for (std::unique_ptr<ThreadStats>& stats : registry.Threads) {
+		if (stats->TraceGen.load(std::memory_order_acquire) != gen) {
+			continue;
+		}
+		uint32_t num = stats->TraceNum.load(std::memory_order_acquire);
+		if (num == 0) {
+			continue;
+		}
+		traces.push_back({ stats->Index, stats->Trace.get(), num });
+		for (uint32_t i = 0; i < num; i++) {
+			begin = std::min(begin, stats->Trace[i].Post);
+		}
+	}
+
+	auto micros = [begin](uint64_t t) {
+		return double(t - begin) / 1000.0;
+	};
+
+	std::ios::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
+	os << std::fixed << std::setprecision(3);
+
+	os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	for (const ThreadTrace& trace : traces) {
+		os << (first ? "\n" : ",\n");
+		first = false;
+		os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << trace.Index
+			<< ",\"args\":{\"name\":\"sched " << trace.Index << "\"}}";
+
+		for (uint32_t i = 0; i < trace.Num; i++) {
+			const TraceEvent& e = trace.Events[i];
+			os << ",\n{\"name\":";
+			WriteJsonString(os, registry.Names[e.Queue]);
+			os << ",\"cat\":\"sched\",\"ph\":\"X\",\"pid\":0,\"tid\":" << trace.Index
+				<< ",\"ts\":" << micros(e.Start) << ",\"dur\":" << micros(e.End) - micros(e.Start)
+				<< ",\"args\":{\"wait_us\":" << micros(e.Start) - micros(e.Post) << "}}";
+		}
+	}
+	os << "\n]}\n";
+	os.flags(flags);
+	os.precision(precision);
+}
+
+}
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Service.h"
+
+namespace z {
+namespace sched {
+
+/*
+Log linear histogram, 4 buckets per power of two (error < 25%).
+values are usually nano seconds or task counts.
+
+Record is for the owning thread only, RecordShared for any thread. readers
+may sum it up at any time, all fields are relaxed atomics.
+*/
+class Histogram {
+public:
+	static const uint32_t K_SUB_BITS = 2;
+	static const uint32_t K_SUB_NUM = 1 << K_SUB_BITS;
+	static const uint32_t K_BUCKET_NUM = (64 - K_SUB_BITS + 1) * K_SUB_NUM;
+
+	static uint32_t BucketOf(uint64_t v) {
+		if (v < K_SUB_NUM) {
+			return (uint32_t)v;
+		}
+		uint32_t e = Log2(v);
+		return (e - K_SUB_BITS + 1) * K_SUB_NUM + (uint32_t)((v >> (e - K_SUB_BITS)) & (K_SUB_NUM - 1));
+	}
+
+	// smallest value of bucket b
+	static uint64_t BucketLow(uint32_t b) {
+		if (b < K_SUB_NUM) {
+			return b;
+		}
+		uint32_t e = b / K_SUB_NUM + K_SUB_BITS - 1;
+		return uint64_t(K_SUB_NUM + b % K_SUB_NUM) << (e - K_SUB_BITS);
+	}
+
+	void Record(uint64_t v) {
+		Bump(mBuckets[BucketOf(v)], 1);
+		Bump(mCount, 1);
+		Bump(mSum, v);
+		if (v > mMax.load(std::memory_order_relaxed)) {
+			mMax.store(v, std::memory_order_relaxed);
+		}
+	}
+
+	void RecordShared(uint64_t v) {
+		mBuckets[BucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+		mCount.fetch_add(1, std::memory_order_relaxed);
+		mSum.fetch_add(v, std::memory_order_relaxed);
+		uint64_t max = mMax.load(std::memory_order_relaxed);
+		while (v > max && !mMax.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+		}
+	}
+
+	// racing records may survive a reset
+	void Reset() {
+		for (std::atomic<uint64_t>& bucket : mBuckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		mCount.store(0, std::memory_order_relaxed);
+		mSum.store(0, std::memory_order_relaxed);
+		mMax.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	friend struct HistogramSnapshot;
+
+	static uint32_t Log2(uint64_t v) {
+		uint32_t e = 0;
+		while (v >>= 1) {
+			e++;
+		}
+		return e;
+	}
+
+	// single writer, a plain load and store instead of a locked add
+	static void Bump(std::atomic<uint64_t>& a, uint64_t v) {
+		a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+	}
+
+	std::atomic<uint64_t> mBuckets[K_BUCKET_NUM] = {};
+	std::atomic<uint64_t> mCount{ 0 };
+	std::atomic<uint64_t> mSum{ 0 };
+	std::atomic<uint64_t> mMax{ 0 };
+};
+
+struct HistogramSnapshot {
+	uint64_t Count{ 0 };
+	uint64_t Sum{ 0 };
+	uint64_t Max{ 0 };
+	std::vector<uint64_t> Buckets = std::vector<uint64_t>(Histogram::K_BUCKET_NUM, 0);
+
+	void Add(const Histogram& h);
+
+	double Mean() const {
+		return Count > 0 ? double(Sum) / Count : 0.0;
+	}
+
+	// upper bound of the bucket the p-th (0..100) percentile falls in, never above Max
+	uint64_t Percentile(double p) const;
+};
+
+
+// per queue, created by TaskQueue when stats are compiled in
+class QueueStats {
+public:
+	uint32_t Id{ 0 };
+	const char* Kind{ "" };
+	ETaskPriority Priority{ PRIORITY_NORMAL };
+	// tasks in the queue right after each post
+	Histogram Depth;
+};
+
+struct QueueSnapshot {
+	uint32_t Id{ 0 };
+	std::string Name;
+	ETaskPriority Priority{ PRIORITY_NORMAL };
+	HistogramSnapshot Depth;
+};
+
+struct StatsSnapshot {
+	// nano seconds, by priority of the queue
+	HistogramSnapshot Wait[PRIORITY_NUM];
+	HistogramSnapshot Run[PRIORITY_NUM];
+	// steals that got a queue, and sweeps over all victims that got nothing
+	uint64_t Steals{ 0 };
+	uint64_t StealMisses{ 0 };
+	// live queues
+	std::vector<QueueSnapshot> Queues;
+};
+
+
+/*
+Scheduler instrumentation, compiled in with Z_SCHED_STATS=1 (see Service.h).
+when it is 0 the scheduler never calls in here, snapshots stay empty.
+
+	wait: post to start of each task
+	run: duration of each task
+	depth: queue length sampled on post, per queue
+	steals: work stealing only
+
+every thread records into its own histograms, Snapshot() sums them up and
+can be called while workers run. between StartTrace and StopTrace every task
+run is also logged into a per thread buffer (first K_TRACE_EVENT_NUM per
+thread), WriteChromeTrace dumps them as trace event json for chrome://tracing
+or Perfetto.
+*/
+const uint32_t K_TRACE_EVENT_NUM = 1 << 16;
+
+class Stats {
+public:
+	static uint64_t Now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static StatsSnapshot Snapshot();
+	static void Reset();
+
+	// a new trace drops the last one, don't start one while writing
+	static void StartTrace();
+	static void StopTrace();
+	static void WriteChromeTrace(std::ostream& os);
+
+	// hooks of the scheduler
+	static QueueStats* AddQueue(const char* kind, ETaskPriority priority);
+	static void RemoveQueue(QueueStats* queue);
+	static void SetQueueName(QueueStats* queue, const char* name);
+
+	static void OnPost(QueueStats* queue, int64_t depth) {
+		queue->Depth.RecordShared(depth > 0 ? depth : 0);
+	}
+
+	static void OnRun(QueueStats* queue, uint64_t postTime, uint64_t start, uint64_t end);
+	static void OnSteal(bool got);
+};
+
+}	// namespace sched
+}	// namespace z
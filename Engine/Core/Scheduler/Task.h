@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// inline buffer of sched::Task, callables larger than this go to heap
+#ifndef Z_SCHED_TASK_INLINE_SIZE
+#define Z_SCHED_TASK_INLINE_SIZE 64
+#endif
+
+namespace z {
+namespace sched {
+
+/*
+Move only void() callable with small buffer.
+
+callables that fit in InlineSize (and are nothrow movable) are stored inline,
+so building and moving a task doesn't touch the heap. bigger ones are boxed.
+*/
+template<size_t InlineSize>
+class TTask {
+private:
+	struct Ops {
+		void (*Invoke)(void* storage);
+		void (*Move)(void* dst, void* src);
+		void (*Destroy)(void* storage);
+	};
+
+	template<typename F>
+	struct InlineOps {
+		static void Invoke(void* s) { (*(F*)s)(); }
+		static void Move(void* d, void* s) { new (d) F(std::move(*(F*)s)); ((F*)s)->~F(); }
+		static void Destroy(void* s) { ((F*)s)->~F(); }
+		static constexpr Ops Table = { &Invoke, &Move, &Destroy };
+	};
+
+	template<typename F>
+	struct HeapOps {
+		static void Invoke(void* s) { (**(F**)s)(); }
+		static void Move(void* d, void* s) { *(F**)d = *(F**)s; }
+		static void Destroy(void* s) { delete *(F**)s; }
+		static constexpr Ops Table = { &Invoke, &Move, &Destroy };
+	};
+
+	template<typename F>
+	using EnableIfCallable = std::enable_if_t<
+		!std::is_same_v<std::decay_t<F>, TTask> && std::is_invocable_v<std::decay_t<F>&>>;
+
+public:
+	template<typename F>
+	static constexpr bool IsInline =
+		sizeof(F) <= InlineSize &&
+		alignof(F) <= alignof(std::max_align_t) &&
+		std::is_nothrow_move_constructible_v<F>;
+
+	// ctor
+	TTask() noexcept {}
+	TTask(std::nullptr_t) noexcept {}
+
+	template<typename F, typename = EnableIfCallable<F>>
+	TTask(F&& f) {
+		using Fn = std::decay_t<F>;
+		if constexpr (IsInline<Fn>) {
+			new (mStorage) Fn(std::forward<F>(f));
+			mOps = &InlineOps<Fn>::Table;
+		} else {
+			*(Fn**)mStorage = new Fn(std::forward<F>(f));
+			mOps = &HeapOps<Fn>::Table;
+		}
+	}
+
+	TTask(TTask&& other) noexcept {
+		MoveFrom(other);
+	}
+
+	TTask& operator = (TTask&& other) noexcept {
+		if (this != &other) {
+			Reset();
+			MoveFrom(other);
+		}
+		return *this;
+	}
+
+	TTask(TTask const&) = delete;
+	TTask& operator = (TTask const&) = delete;
+
+	~TTask() {
+		Reset();
+	}
+
+	void operator()() {
+		mOps->Invoke(mStorage);
+	}
+
+	explicit operator bool() const {
+		return mOps != nullptr;
+	}
+
+	void Reset() {
+		if (mOps) {
+			mOps->Destroy(mStorage);
+			mOps = nullptr;
+		}
+	}
+
+private:
+	void MoveFrom(TTask& other) {
+		mOps = other.mOps;
+		if (mOps) {
+			mOps->Move(mStorage, other.mStorage);
+			other.mOps = nullptr;
+		}
+	}
+
+	Ops const* mOps{ nullptr };
+	alignas(std::max_align_t) unsigned char mStorage[InlineSize < sizeof(void*) ? sizeof(void*) : InlineSize];
+};
+
+typedef TTask<Z_SCHED_TASK_INLINE_SIZE> Task;
+
+}	// namespace sched
+}	// namespace z
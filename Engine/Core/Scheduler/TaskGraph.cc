@@ -0,0 +1,175 @@
+#include "TaskGraph.h"
+
+#include <thread>
+
+namespace z {
+namespace sched {
+
+TaskGraph::TaskGraph(Worker* worker, ETaskPriority priority) :
+	mService(worker->GetService()),
+	mTaskQueue(worker->GetService(), priority) {
+	mTaskQueue.SetName("graph");
+}
+
+TaskGraph::~TaskGraph() {
+	CHECK(IsDone(), "TaskGraph destroyed while running.");
+	// started and polled with IsDone, the last node's worker may still be in the queue
+	mTaskQueue.WaitIdle();
+}
+
+TaskNodeId TaskGraph::AddNode(const char* name, Task&& work, bool onCaller) {
+	CHECK(IsDone(), "TaskGraph changed while running.");
+	Node node;
+	node.Name = name;
+	node.Work = std::move(work);
+	node.OnCaller = onCaller;
+	mNodes.push_back(std::move(node));
+	mBuilt = false;
+	return TaskNodeId(mNodes.size() - 1);
+}
+
+void TaskGraph::AddEdge(TaskNodeId before, TaskNodeId after) {
+	CHECK(IsDone(), "TaskGraph changed while running.");
+	CHECK(before < mNodes.size() && after < mNodes.size(), "TaskGraph edge to unknown node.");
+	mNodes[before].Successors.push_back(after);
+	mNodes[after].PredecessorNum++;
+	mBuilt = false;
+}
+
+bool TaskGraph::Build() {
+	// kahn, nodes left with predecessors are on a cycle
+	size_t num = mNodes.size();
+	std::vector<int> pending(num);
+	mRoots.clear();
+	mOrder.clear();
+	mCallerNum = 0;
+	for (size_t i = 0; i < num; i++) {
+		pending[i] = mNodes[i].PredecessorNum;
+		if (pending[i] == 0) {
+			mRoots.push_back(TaskNodeId(i));
+			mOrder.push_back(TaskNodeId(i));
+		}
+		mCallerNum += mNodes[i].OnCaller ? 1 : 0;
+	}
+	for (size_t i = 0; i < mOrder.size(); i++) {
+		for (TaskNodeId next : mNodes[mOrder[i]].Successors) {
+			if (--pending[next] == 0) {
+				mOrder.push_back(next);
+			}
+		}
+	}
+	if (mOrder.size() != num) {
+		for (size_t i = 0; i < num; i++) {
+			if (pending[i] > 0) {
+				Log<LERROR>("TaskGraph cycle through node", mNodes[i].Name);
+				break;
+			}
+		}
+		mOrder.clear();
+		return false;
+	}
+
+	mPending.reset(new std::atomic<int>[num]);
+	mCallerSlots.reset(new std::atomic<TaskNodeId>[mCallerNum]);
+	for (uint32_t i = 0; i < mCallerNum; i++) {
+		mCallerSlots[i].store(0, std::memory_order_relaxed);
+	}
+	mBuilt = true;
+	return true;
+}
+
+void TaskGraph::Start() {
+	CHECK(IsDone(), "TaskGraph started while running.");
+	if (!mBuilt) {
+		CHECK(Build(), "TaskGraph has a cycle.");
+	}
+	if (mNodes.empty()) {
+		return;
+	}
+
+	for (size_t i = 0; i < mNodes.size(); i++) {
+		mPending[i].store(mNodes[i].PredecessorNum, std::memory_order_relaxed);
+	}
+	mCallerPushed.store(0, std::memory_order_relaxed);
+	mCallerPopped = 0;
+	mRemaining.store((int)mNodes.size(), std::memory_order_relaxed);
+	mFinished.store(false, std::memory_order_relaxed);
+
+	// the posts publish the stores above
+	for (TaskNodeId id : mRoots) {
+		Schedule(id);
+	}
+}
+
+void TaskGraph::Wait() {
+	uint32_t spin = 0;
+	while (!IsDone()) {
+		if (RunCallerNode() || mService.RunPendingQueue()) {
+			spin = 0;
+			continue;
+		}
+		// the last node is notifying, done in a moment
+		if (mRemaining.load(std::memory_order_acquire) == 0 || spin < K_WORKER_SPIN_MAX) {
+			spin++;
+			CpuRelax();
+			continue;
+		}
+		// a worker keeps helping, others sleep until a caller node comes or all are done
+		if (GetCurrentTaskQueue() != nullptr) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		EventCount::Key key = mEvent.PrepareWait();
+		bool callerReady = mCallerPopped < mCallerNum &&
+			mCallerSlots[mCallerPopped].load(std::memory_order_acquire) != 0;
+		if (callerReady || mRemaining.load(std::memory_order_acquire) == 0) {
+			mEvent.CancelWait();
+			continue;
+		}
+		mEvent.Wait(key);
+	}
+	// the last node is done, the worker that ran it lets go of the queue in a moment
+	mTaskQueue.WaitIdle();
+}
+
+void TaskGraph::Schedule(TaskNodeId id) {
+	if (!mNodes[id].OnCaller) {
+		mTaskQueue.Post([this, id]() { RunNode(id); });
+		return;
+	}
+	uint32_t slot = mCallerPushed.fetch_add(1, std::memory_order_relaxed);
+	mCallerSlots[slot].store(id + 1, std::memory_order_release);
+	mEvent.NotifyAll();
+}
+
+bool TaskGraph::RunCallerNode() {
+	if (mCallerPopped >= mCallerNum) {
+		return false;
+	}
+	TaskNodeId slot = mCallerSlots[mCallerPopped].load(std::memory_order_acquire);
+	if (slot == 0) {
+		return false;
+	}
+	mCallerSlots[mCallerPopped].store(0, std::memory_order_relaxed);
+	mCallerPopped++;
+	RunNode(slot - 1);
+	return true;
+}
+
+void TaskGraph::RunNode(TaskNodeId id) {
+	Node& node = mNodes[id];
+	node.Work();
+	for (TaskNodeId next : node.Successors) {
+		if (mPending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Schedule(next);
+		}
+	}
+	if (mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		mEvent.NotifyAll();
+		mFinished.store(true, std::memory_order_release);
+	}
+}
+
+}
+}
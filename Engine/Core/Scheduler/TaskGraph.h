@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "Service.h"
+#include "Worker.h"
+
+namespace z {
+namespace sched {
+
+// index of a node in its graph
+typedef uint32_t TaskNodeId;
+
+/*
+Nodes and edges declared once, run as many times as wanted (once per frame).
+
+	TaskGraph graph(worker);
+	TaskNodeId input = graph.AddNode("input", []() { ... }, true);
+	TaskNodeId anim = graph.AddNode("anim", []() { ... });
+	TaskNodeId physics = graph.AddNode("physics", []() { ... });
+	graph.AddEdge(input, anim);
+	graph.AddEdge(input, physics);
+	...
+	graph.Run();
+
+a node is posted the moment its last predecessor finishes, counted down on an
+atomic per node. Run allocates nothing, node tasks are stored inline in the
+parallel queue. caller nodes only run on the thread waiting in Run/Wait, for
+work tied to it (window, input, device).
+
+nodes and edges can't change while the graph runs, one run at a time.
+*/
+class TaskGraph {
+public:
+	TaskGraph(Worker* worker, ETaskPriority priority = PRIORITY_NORMAL);
+	~TaskGraph();
+
+	// work runs once each Run, onCaller: only on the thread in Run/Wait
+	TaskNodeId AddNode(const char* name, Task&& work, bool onCaller = false);
+	// after runs once before finishes
+	void AddEdge(TaskNodeId before, TaskNodeId after);
+
+	/* sort the nodes, false with an error log if edges make a cycle.
+		Start builds the graph if it changed since
+	*/
+	bool Build();
+
+	// all nodes, each one after its predecessors. valid after Build
+	const std::vector<TaskNodeId>& GetTopologicalOrder() const {
+		return mOrder;
+	}
+
+	size_t GetNodeNum() const {
+		return mNodes.size();
+	}
+
+	const char* GetNodeName(TaskNodeId id) const {
+		return mNodes[id].Name;
+	}
+
+	// post the roots and return
+	void Start();
+	// help the service and run caller nodes until all nodes are done and the
+	// queue is idle, the graph can be destroyed after
+	void Wait();
+	void Run() {
+		Start();
+		Wait();
+	}
+
+	bool IsDone() const {
+		return mFinished.load(std::memory_order_acquire);
+	}
+
+	// see TaskQueue::SetName
+	void SetName(const char* name) {
+		mTaskQueue.SetName(name);
+	}
+
+private:
+	struct Node {
+		const char* Name;
+		Task Work;
+		std::vector<TaskNodeId> Successors;
+		int PredecessorNum{ 0 };
+		bool OnCaller{ false };
+	};
+
+	// last predecessor done, post it or hand it to the caller
+	void Schedule(TaskNodeId id);
+	void RunNode(TaskNodeId id);
+	// pop a ready caller node, false if none
+	bool RunCallerNode();
+
+	Service& mService;
+	ParallelTaskQueue mTaskQueue;
+
+	std::vector<Node> mNodes;
+	std::vector<TaskNodeId> mRoots;
+	std::vector<TaskNodeId> mOrder;
+	bool mBuilt{ false };
+
+	// predecessors not done yet, reset at Start
+	std::unique_ptr<std::atomic<int>[]> mPending;
+	std::atomic<int> mRemaining{ 0 };
+	// set after the last node notified, nothing but the queue (see Wait) touches the graph then
+	std::atomic<bool> mFinished{ true };
+
+	/* ready caller nodes, a slot per caller node. each node is pushed once a
+	   run, so producers reserve slots with a counter and the caller reads them
+	   in order. 0 is empty, else id + 1
+	*/
+	std::unique_ptr<std::atomic<TaskNodeId>[]> mCallerSlots;
+	std::atomic<uint32_t> mCallerPushed{ 0 };
+	uint32_t mCallerPopped{ 0 };
+	uint32_t mCallerNum{ 0 };
+
+	// the thread in Wait parks here
+	EventCount mEvent;
+
+	TaskGraph(TaskGraph const&) = delete;
+	void operator =(TaskGraph const&) = delete;
+};
+
+}	// namespace sched
+}	// namespace z
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace z {
+namespace sched {
+
+/*
+Hierarchical timer wheel (Varghese & Lauck), not thread safe.
+
+4 levels of 256 slots, level n slot spans 256^n ticks, so 2^32 ticks in all.
+a timer goes to the lowest level its delay fits in, and moves down one level
+when the wheel turns over the slot it sits in (cascade).
+
+	Insert/Remove: O(1), unlink from an index linked list
+	Advance: O(1) per tick and per expired timer, empty stretches are skipped
+
+timers are addressed by index. nodes live in fixed chunks and never move, so
+payload references stay valid until Free. Gen changes on Free, a stale
+(index, gen) pair can be detected with GetGen.
+*/
+template<typename T>
+class TimerWheel {
+private:
+	static const uint32_t K_SLOT_BITS = 8;
+	static const uint32_t K_SLOT_NUM = 1 << K_SLOT_BITS;
+	static const uint32_t K_SLOT_MASK = K_SLOT_NUM - 1;
+	static const uint32_t K_LEVEL_NUM = 4;
+	static const uint32_t K_CHUNK_SIZE = 1024;
+	static const uint32_t K_UNLINKED = 0xffffffff;
+
+	struct Node {
+		T Payload;
+		uint64_t Due{ 0 };
+		uint32_t Prev{ K_NIL };
+		uint32_t Next{ K_NIL };
+		uint32_t Gen{ 0 };
+		uint32_t Slot{ K_UNLINKED };
+	};
+
+public:
+	static const uint32_t K_NIL = 0xffffffff;
+
+	TimerWheel() {
+		for (uint32_t i = 0; i < K_LEVEL_NUM * K_SLOT_NUM; i++) {
+			mSlots[i] = K_NIL;
+		}
+	}
+
+	uint64_t GetTick() const {
+		return mCurrent;
+	}
+
+	// timers linked in the wheel
+	size_t Size() const {
+		return mCount;
+	}
+
+	// nodes ever allocated, indices are below it
+	uint32_t Capacity() const {
+		return (uint32_t)mChunks.size() * K_CHUNK_SIZE;
+	}
+
+	uint32_t Alloc() {
+		if (mFreeHead == K_NIL) {
+			Grow();
+		}
+		uint32_t index = mFreeHead;
+		mFreeHead = GetNode(index).Next;
+		GetNode(index).Next = K_NIL;
+		return index;
+	}
+
+	// node must be unlinked
+	void Free(uint32_t index) {
+		Node& node = GetNode(index);
+		node.Gen++;
+		node.Next = mFreeHead;
+		mFreeHead = index;
+	}
+
+	T& GetPayload(uint32_t index) {
+		return GetNode(index).Payload;
+	}
+
+	uint32_t GetGen(uint32_t index) const {
+		return GetNode(index).Gen;
+	}
+
+	uint64_t GetDue(uint32_t index) const {
+		return GetNode(index).Due;
+	}
+
+	bool IsLinked(uint32_t index) const {
+		return GetNode(index).Slot != K_UNLINKED;
+	}
+
+	// a due already passed fires on next Advance
+	void Insert(uint32_t index, uint64_t due) {
+		Node& node = GetNode(index);
+		node.Due = due;
+		Link(index, SlotOf(due));
+		mCount++;
+	}
+
+	void Remove(uint32_t index) {
+		Unlink(index);
+		mCount--;
+	}
+
+	// turn the wheel to tick `now`, expired timers are unlinked then passed to onExpire(index)
+	template<typename F>
+	void Advance(uint64_t now, F onExpire) {
+		while (mCurrent < now) {
+			if (mCount == 0) {
+				mCurrent = now;
+				break;
+			}
+			// nothing on level 0, jump to the tick before next cascade
+			if (mLevelCount[0] == 0) {
+				uint64_t last = mCurrent | K_SLOT_MASK;
+				if (last >= now) {
+					mCurrent = now;
+					break;
+				}
+				mCurrent = last;
+			}
+
+			mCurrent++;
+			if ((mCurrent & K_SLOT_MASK) == 0) {
+				Cascade(1);
+			}
+
+			uint32_t slot = mCurrent & K_SLOT_MASK;
+			while (mSlots[slot] != K_NIL) {
+				uint32_t index = mSlots[slot];
+				Remove(index);
+				onExpire(index);
+			}
+		}
+	}
+
+	// no timer fires before the returned tick, ~0 if the wheel is empty.
+	// exact for level 0, otherwise the next cascade
+	uint64_t GetNextDue() const {
+		if (mCount == 0) {
+			return ~uint64_t(0);
+		}
+		if (mLevelCount[0] > 0) {
+			for (uint64_t tick = mCurrent + 1; tick <= mCurrent + K_SLOT_NUM; tick++) {
+				if (mSlots[tick & K_SLOT_MASK] != K_NIL) {
+					return tick;
+				}
+			}
+		}
+		return (mCurrent | K_SLOT_MASK) + 1;
+	}
+
+private:
+	Node& GetNode(uint32_t index) {
+		return mChunks[index / K_CHUNK_SIZE][index % K_CHUNK_SIZE];
+	}
+
+	const Node& GetNode(uint32_t index) const {
+		return mChunks[index / K_CHUNK_SIZE][index % K_CHUNK_SIZE];
+	}
+
+	void Grow() {
+		uint32_t base = (uint32_t)mChunks.size() * K_CHUNK_SIZE;
+		mChunks.emplace_back(new Node[K_CHUNK_SIZE]);
+		Node* chunk = mChunks.back().get();
+		for (uint32_t i = 0; i < K_CHUNK_SIZE; i++) {
+			chunk[i].Next = i + 1 < K_CHUNK_SIZE ? base + i + 1 : mFreeHead;
+		}
+		mFreeHead = base;
+	}
+
+	uint32_t SlotOf(uint64_t due) const {
+		if (due <= mCurrent) {
+			due = mCurrent + 1;
+		}
+		uint64_t delta = due - mCurrent;
+		for (uint32_t level = 0; level < K_LEVEL_NUM - 1; level++) {
+			if (delta < (uint64_t(1) << (K_SLOT_BITS * (level + 1)))) {
+				return level * K_SLOT_NUM + ((due >> (K_SLOT_BITS * level)) & K_SLOT_MASK);
+			}
+		}
+		// farther than the wheel reaches, park on the top level and cascade again later
+		uint64_t maxDelta = (uint64_t(1) << (K_SLOT_BITS * K_LEVEL_NUM)) - 1;
+		if (delta > maxDelta) {
+			due = mCurrent + maxDelta;
+		}
+		uint32_t top = K_LEVEL_NUM - 1;
+		return top * K_SLOT_NUM + ((due >> (K_SLOT_BITS * top)) & K_SLOT_MASK);
+	}
+
+	void Link(uint32_t index, uint32_t slot) {
+		Node& node = GetNode(index);
+		node.Slot = slot;
+		node.Prev = K_NIL;
+		node.Next = mSlots[slot];
+		if (node.Next != K_NIL) {
+			GetNode(node.Next).Prev = index;
+		}
+		mSlots[slot] = index;
+		mLevelCount[slot / K_SLOT_NUM]++;
+	}
+
+	void Unlink(uint32_t index) {
+		Node& node = GetNode(index);
+		if (node.Prev != K_NIL) {
+			GetNode(node.Prev).Next = node.Next;
+		} else {
+			mSlots[node.Slot] = node.Next;
+		}
+		if (node.Next != K_NIL) {
+			GetNode(node.Next).Prev = node.Prev;
+		}
+		mLevelCount[node.Slot / K_SLOT_NUM]--;
+		node.Slot = K_UNLINKED;
+		node.Prev = node.Next = K_NIL;
+	}
+
+	// move timers of the current slot on `level` down, higher levels first
+	void Cascade(uint32_t level) {
+		uint32_t slot = (mCurrent >> (K_SLOT_BITS * level)) & K_SLOT_MASK;
+		if (slot == 0 && level + 1 < K_LEVEL_NUM) {
+			Cascade(level + 1);
+		}
+
+		uint32_t head = level * K_SLOT_NUM + slot;
+		while (mSlots[head] != K_NIL) {
+			uint32_t index = mSlots[head];
+			Unlink(index);
+			// due this tick goes to the level 0 slot about to expire
+			uint64_t due = GetNode(index).Due;
+			Link(index, due <= mCurrent ? (mCurrent & K_SLOT_MASK) : SlotOf(due));
+		}
+	}
+
+	uint32_t mSlots[K_LEVEL_NUM * K_SLOT_NUM];
+	uint32_t mLevelCount[K_LEVEL_NUM] = {};
+	uint64_t mCurrent{ 0 };
+	size_t mCount{ 0 };
+
+	std::vector<std::unique_ptr<Node[]>> mChunks;
+	uint32_t mFreeHead{ K_NIL };
+};
+
+}	// namespace sched
+}	// namespace z
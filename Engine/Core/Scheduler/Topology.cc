@@ -0,0 +1,268 @@
+#include "Topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#if defined(_WIN32)
+#include <Core/Platform/OSHeader.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace z {
+namespace sched {
+
+namespace {
+
+#if defined(__linux__)
+// first integer of a sysfs file, fallback if it is missing
+int ReadSysInt(const std::string& path, int fallback) {
+	std::ifstream file(path);
+	int value = fallback;
+	if (!(file >> value)) {
+		return fallback;
+	}
+	return value;
+}
+
+// "0-3,8,10-11"
+std::vector<int> ReadSysCpuList(const std::string& path) {
+	std::vector<int> list;
+	std::ifstream file(path);
+	std::string text;
+	if (!std::getline(file, text)) {
+		return list;
+	}
+	size_t pos = 0;
+	while (pos < text.size()) {
+		size_t end = text.find(',', pos);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		std::string range = text.substr(pos, end - pos);
+		size_t dash = range.find('-');
+		if (!range.empty()) {
+			int first = atoi(range.c_str());
+			int last = dash == std::string::npos ? first : atoi(range.c_str() + dash + 1);
+			for (int i = first; i <= last; i++) {
+				list.push_back(i);
+			}
+		}
+		pos = end + 1;
+	}
+	return list;
+}
+#endif
+
+}
+
+
+const CpuTopology& CpuTopology::Get() {
+	static CpuTopology topology = Query();
+	return topology;
+}
+
+#if defined(__linux__)
+CpuTopology CpuTopology::Query() {
+	std::vector<CpuInfo> cpus;
+	std::vector<int> coreIds;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		for (int i = 0; i < (int)std::max(1u, std::thread::hardware_concurrency()); i++) {
+			CPU_SET(i, &set);
+		}
+	}
+
+	std::map<int, int> nodeOf;
+	for (int node : ReadSysCpuList("/sys/devices/system/node/online")) {
+		for (int cpu : ReadSysCpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+			nodeOf[cpu] = node;
+		}
+	}
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (!CPU_ISSET(cpu, &set)) {
+			continue;
+		}
+		std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+		CpuInfo info;
+		info.Cpu = cpu;
+		info.Package = ReadSysInt(dir + "physical_package_id", 0);
+		info.Node = nodeOf.count(cpu) ? nodeOf[cpu] : 0;
+		cpus.push_back(info);
+		// no topology, every cpu is a core
+		coreIds.push_back(ReadSysInt(dir + "core_id", cpu));
+	}
+
+	return CpuTopology(cpus, coreIds);
+}
+
+bool CpuTopology::PinCurrentThread(int cpu) {
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	// 0 is the calling thread
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+int CpuTopology::GetCurrentCpu() {
+	return sched_getcpu();
+}
+
+#elif defined(_WIN32)
+CpuTopology CpuTopology::Query() {
+	std::vector<CpuInfo> cpus;
+	std::vector<int> coreIds;
+
+	DWORD_PTR processMask = 0, systemMask = 0;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+		processMask = ~DWORD_PTR(0);
+	}
+
+	DWORD size = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+	std::vector<char> buffer(size);
+	auto* infos = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)buffer.data();
+	if (size == 0 || !GetLogicalProcessorInformationEx(RelationAll, infos, &size)) {
+		size = 0;
+	}
+
+	// records are variable sized. group 0 only
+	std::map<int, int> coreOf, packageOf, nodeOf;
+	int coreIndex = 0, packageIndex = 0;
+	for (DWORD offset = 0; offset < size;) {
+		auto* info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buffer.data() + offset);
+		for (int cpu = 0; cpu < (int)sizeof(KAFFINITY) * 8; cpu++) {
+			KAFFINITY bit = KAFFINITY(1) << cpu;
+			if (info->Relationship == RelationProcessorCore && info->Processor.GroupMask[0].Group == 0 &&
+				(info->Processor.GroupMask[0].Mask & bit)) {
+				coreOf[cpu] = coreIndex;
+			} else if (info->Relationship == RelationProcessorPackage && info->Processor.GroupMask[0].Group == 0 &&
+				(info->Processor.GroupMask[0].Mask & bit)) {
+				packageOf[cpu] = packageIndex;
+			} else if (info->Relationship == RelationNumaNode && info->NumaNode.GroupMask.Group == 0 &&
+				(info->NumaNode.GroupMask.Mask & bit)) {
+				nodeOf[cpu] = (int)info->NumaNode.NodeNumber;
+			}
+		}
+		coreIndex += info->Relationship == RelationProcessorCore ? 1 : 0;
+		packageIndex += info->Relationship == RelationProcessorPackage ? 1 : 0;
+		offset += info->Size;
+	}
+
+	for (int cpu = 0; cpu < (int)sizeof(DWORD_PTR) * 8; cpu++) {
+		if (!(processMask & (DWORD_PTR(1) << cpu)) || (size > 0 && !coreOf.count(cpu))) {
+			continue;
+		}
+		CpuInfo info;
+		info.Cpu = cpu;
+		info.Package = packageOf.count(cpu) ? packageOf[cpu] : 0;
+		info.Node = nodeOf.count(cpu) ? nodeOf[cpu] : 0;
+		cpus.push_back(info);
+		coreIds.push_back(coreOf.count(cpu) ? coreOf[cpu] : cpu);
+	}
+
+	return CpuTopology(cpus, coreIds);
+}
+
+bool CpuTopology::PinCurrentThread(int cpu) {
+	if (cpu < 0 || cpu >= (int)sizeof(DWORD_PTR) * 8) {
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+}
+
+int CpuTopology::GetCurrentCpu() {
+	return (int)GetCurrentProcessorNumber();
+}
+
+#else
+CpuTopology CpuTopology::Query() {
+	std::vector<CpuInfo> cpus;
+	std::vector<int> coreIds;
+	for (int cpu = 0; cpu < (int)std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+		CpuInfo info;
+		info.Cpu = cpu;
+		cpus.push_back(info);
+		coreIds.push_back(cpu);
+	}
+	return CpuTopology(cpus, coreIds);
+}
+
+bool CpuTopology::PinCurrentThread(int cpu) {
+	return false;
+}
+
+int CpuTopology::GetCurrentCpu() {
+	return -1;
+}
+#endif
+
+CpuTopology::CpuTopology(std::vector<CpuInfo> cpus, const std::vector<int>& coreIds) :
+	mCpus(std::move(cpus)) {
+	// core ids are only unique in a package
+	std::map<std::pair<int, int>, int> cores;
+	std::map<int, int> siblings;
+	std::set<int> nodes;
+	for (size_t i = 0; i < mCpus.size(); i++) {
+		CpuInfo& info = mCpus[i];
+		auto key = std::make_pair(info.Package, coreIds[i]);
+		auto it = cores.find(key);
+		if (it == cores.end()) {
+			it = cores.emplace(key, (int)cores.size()).first;
+		}
+		info.Core = it->second;
+		info.Sibling = siblings[info.Core]++;
+		nodes.insert(info.Node);
+	}
+	mCoreNum = (int)cores.size();
+	mNodeNum = (int)nodes.size();
+}
+
+std::vector<int> CpuTopology::Place(int num, EPlacement placement) const {
+	std::vector<int> result(num, -1);
+	if (placement == PLACEMENT_NONE || mCpus.empty()) {
+		return result;
+	}
+
+	std::vector<CpuInfo> order = mCpus;
+	if (placement == PLACEMENT_SPREAD) {
+		// rank of each core in its node, so nodes take turns
+		std::map<int, std::set<int>> nodeCores;
+		for (const CpuInfo& info : mCpus) {
+			nodeCores[info.Node].insert(info.Core);
+		}
+		auto rankOf = [&nodeCores](const CpuInfo& info) {
+			const std::set<int>& cores = nodeCores[info.Node];
+			return (int)std::distance(cores.begin(), cores.find(info.Core));
+		};
+		std::stable_sort(order.begin(), order.end(), [&rankOf](const CpuInfo& a, const CpuInfo& b) {
+			return std::make_tuple(a.Sibling, rankOf(a), a.Node) < std::make_tuple(b.Sibling, rankOf(b), b.Node);
+		});
+	} else {
+		std::stable_sort(order.begin(), order.end(), [](const CpuInfo& a, const CpuInfo& b) {
+			return std::make_tuple(a.Node, a.Package, a.Core, a.Sibling) < std::make_tuple(b.Node, b.Package, b.Core, b.Sibling);
+		});
+	}
+
+	for (int i = 0; i < num; i++) {
+		result[i] = order[i % order.size()].Cpu;
+	}
+	return result;
+}
+
+}
+}
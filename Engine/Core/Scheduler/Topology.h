@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+namespace z {
+namespace sched {
+
+// a logical cpu the process is allowed to run on
+struct CpuInfo {
+	// os index, what PinCurrentThread takes
+	int Cpu{ 0 };
+	// physical core, dense over the cores the process may use
+	int Core{ 0 };
+	int Package{ 0 };
+	// numa node
+	int Node{ 0 };
+	// 0 for the first hardware thread of its core, 1 for its smt sibling...
+	int Sibling{ 0 };
+};
+
+// how ThreadWorker pins its threads
+enum EPlacement {
+	// no pinning, the os moves workers around
+	PLACEMENT_NONE = 0,
+	/* one worker per physical core, round robin over numa nodes, smt siblings
+	   only when every core has a worker. a strand keeps its worker busy with a
+	   serial chain of tasks, a sibling running other work halves its cache and
+	   throughput.
+	*/
+	PLACEMENT_SPREAD,
+	// fill a core's siblings, then the next core, stay on as few nodes as possible
+	PLACEMENT_COMPACT,
+};
+
+/*
+Cpus, cores and numa nodes of the machine, limited to the process affinity.
+
+	linux: sched_getaffinity, /sys/devices/system/cpu/cpuN/topology, /sys/devices/system/node
+	win32: GetLogicalProcessorInformationEx, processor group 0 only
+	others: hardware_concurrency cpus, each one a core, pinning fails
+*/
+class CpuTopology {
+public:
+	/* cpus with Cpu, Package and Node set, coreIds holds the os core id of each
+	   (unique in a package). Core and Sibling are filled in here
+	*/
+	CpuTopology(std::vector<CpuInfo> cpus, const std::vector<int>& coreIds);
+
+	// queried on first use
+	static const CpuTopology& Get();
+	static CpuTopology Query();
+
+	const std::vector<CpuInfo>& GetCpus() const {
+		return mCpus;
+	}
+
+	int GetCoreNum() const {
+		return mCoreNum;
+	}
+
+	int GetNodeNum() const {
+		return mNodeNum;
+	}
+
+	// os cpu of each of num workers, -1 for not pinned. wraps around if num > cpus
+	std::vector<int> Place(int num, EPlacement placement) const;
+
+	// false if the os refuses or can't pin
+	static bool PinCurrentThread(int cpu);
+	// cpu the calling thread runs on right now, -1 if unknown
+	static int GetCurrentCpu();
+
+private:
+	std::vector<CpuInfo> mCpus;
+	int mCoreNum{ 0 };
+	int mNodeNum{ 0 };
+};
+
+}	// namespace sched
+}	// namespace z
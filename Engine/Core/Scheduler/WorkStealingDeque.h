@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+namespace z {
+namespace sched {
+
+/*
+Chase-Lev work stealing deque (weak memory model version, Le et al. 2013).
+
+	owner thread : Push / Pop at bottom (LIFO)
+	other threads: Steal at top (FIFO)
+
+the ring buffer grows when full, retired buffers are kept until the deque
+is destroyed because a thief may still read from them.
+*/
+template<typename T>
+class WorkStealingDeque {
+private:
+	struct Array {
+		int64_t Capacity;
+		int64_t Mask;
+		std::atomic<T>* Buffer;
+
+		Array(int64_t capacity) :
+			Capacity(capacity),
+			Mask(capacity - 1),
+			Buffer(new std::atomic<T>[capacity]) {
+		}
+
+		~Array() {
+			delete[] Buffer;
+		}
+
+		void Put(int64_t idx, T item) {
+			Buffer[idx & Mask].store(item, std::memory_order_relaxed);
+		}
+
+		T Get(int64_t idx) {
+			return Buffer[idx & Mask].load(std::memory_order_relaxed);
+		}
+
+		Array* Resize(int64_t bottom, int64_t top) {
+			Array* a = new Array(Capacity * 2);
+			for (int64_t i = top; i != bottom; i++) {
+				a->Put(i, Get(i));
+			}
+			return a;
+		}
+	};
+
+public:
+	// capacity must be power of 2
+	WorkStealingDeque(int64_t capacity = 1024) {
+		mArray.store(new Array(capacity), std::memory_order_relaxed);
+	}
+
+	~WorkStealingDeque() {
+		for (Array* a : mGarbage) {
+			delete a;
+		}
+		delete mArray.load();
+	}
+
+	bool Empty() const {
+		int64_t b = mBottom.load(std::memory_order_relaxed);
+		int64_t t = mTop.load(std::memory_order_relaxed);
+		return b <= t;
+	}
+
+	int64_t Size() const {
+		int64_t b = mBottom.load(std::memory_order_relaxed);
+		int64_t t = mTop.load(std::memory_order_relaxed);
+		return b > t ? b - t : 0;
+	}
+
+	// owner only
+	void Push(T item) {
+		int64_t b = mBottom.load(std::memory_order_relaxed);
+		int64_t t = mTop.load(std::memory_order_acquire);
+		Array* a = mArray.load(std::memory_order_relaxed);
+
+		if (b - t > a->Capacity - 1) {
+			mGarbage.push_back(a);
+			a = a->Resize(b, t);
+			mArray.store(a, std::memory_order_release);
+		}
+		a->Put(b, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		mBottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	// owner only
+	bool Pop(T& item) {
+		int64_t b = mBottom.load(std::memory_order_relaxed) - 1;
+		Array* a = mArray.load(std::memory_order_relaxed);
+		mBottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = mTop.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			// empty
+			mBottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		item = a->Get(b);
+		if (t == b) {
+			// last one, race with thieves
+			bool win = mTop.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+			mBottom.store(b + 1, std::memory_order_relaxed);
+			return win;
+		}
+		return true;
+	}
+
+	// any thread
+	bool Steal(T& item) {
+		int64_t t = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = mBottom.load(std::memory_order_acquire);
+
+		if (t >= b) {
+			return false;
+		}
+
+		Array* a = mArray.load(std::memory_order_acquire);
+		item = a->Get(t);
+		return mTop.compare_exchange_strong(t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+private:
+	alignas(64) std::atomic<int64_t> mTop{ 0 };
+	alignas(64) std::atomic<int64_t> mBottom{ 0 };
+	alignas(64) std::atomic<Array*> mArray{ nullptr };
+
+	// owner only
+	std::vector<Array*> mGarbage;
+
+	WorkStealingDeque(WorkStealingDeque const&) = delete;
+	void operator =(WorkStealingDeque const&) = delete;
+};
+
+}	// namespace sched
+}	// namespace z
@@ -4,21 +4,26 @@
 #include <vector>
 
 #include "Service.h"
+#include "Topology.h"
 
 namespace z {
 namespace sched {
 
 class Worker {
 public:
-	Worker() {
+	Worker(EServiceMode mode = SERVICE_SHARED_QUEUE, int workerNum = 1) :
+		mService(mode, workerNum) {
 	}
 
+	virtual ~Worker() {}
+
 	virtual void Run() {
 		mService.Run();
 	}
 
-	virtual void Stop() {
-	
+	// see Service::Stop
+	virtual void Stop(bool drain = true) {
+		mService.Stop(drain);
 	}
 	
 	Service& GetService() {
@@ -32,27 +37,50 @@ protected:
 
 class ThreadWorker : public Worker {
 public:
-	ThreadWorker(int n) : mThreadNum(n) {
+	ThreadWorker(int n, EServiceMode mode = SERVICE_SHARED_QUEUE, EPlacement placement = PLACEMENT_NONE) :
+		Worker(mode, n),
+		mThreadNum(n),
+		mPlacement(placement) {
 		mThreads.resize(n);
 	}
 
+	~ThreadWorker() override {
+		Stop();
+	}
+
 	void Run() override {
+		mCpus = CpuTopology::Get().Place(mThreadNum, mPlacement);
 		for (int i = 0; i < mThreadNum; i++) {
-			mThreads[i] = std::thread([this]() {
+			int cpu = mCpus[i];
+			mThreads[i] = std::thread([this, cpu]() {
+				if (cpu >= 0 && !CpuTopology::PinCurrentThread(cpu)) {
+					Log<LWARN>("pin worker to cpu", cpu, "failed");
+				}
 				this->GetService().Run();
 
 			});
 		}
 	}
 
-	void Stop() override {
+	// cpu each thread is pinned to, -1 if not. valid after Run
+	const std::vector<int>& GetWorkerCpus() const {
+		return mCpus;
+	}
+
+	// wait until all threads return
+	void Stop(bool drain = true) override {
+		mService.Stop(drain);
 		for (int i = 0; i < mThreadNum; i++) {
-			mThreads[i].join();
+			if (mThreads[i].joinable()) {
+				mThreads[i].join();
+			}
 		}
 	}
 
 private:
 	int mThreadNum;
+	EPlacement mPlacement;
+	std::vector<int> mCpus;
 	std::vector<std::thread> mThreads;
 };
 
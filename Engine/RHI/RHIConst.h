@@ -122,8 +122,13 @@ enum ERHIInputSemantic {
 	SEMANTIC_UV1,
 	SEMANTIC_COLOR,
 	SEMANTIC_POSITION2D,
+	// packed, see Core/Math/Packing.h
+	SEMANTIC_QTANGENT,		// normal, tangent and binormal, snorm16 x 4
+	SEMANTIC_NORMAL_OCT,	// octahedral normal, snorm16 x 2
+	SEMANTIC_UV0_HALF,		// half x 2
+	SEMANTIC_UV1_HALF,
 
-	SEMANTIC_MAX = SEMANTIC_POSITION2D + 1
+	SEMANTIC_MAX = SEMANTIC_UV1_HALF + 1
 };
 
 struct RHIRenderState {
@@ -32,7 +32,12 @@ inline int GetSemanticSize(ERHIInputSemantic format) {
 	case SEMANTIC_POSITION2D:
 		return 8;
 	case SEMANTIC_COLOR:
+	case SEMANTIC_NORMAL_OCT:
+	case SEMANTIC_UV0_HALF:
+	case SEMANTIC_UV1_HALF:
 		return 4;
+	case SEMANTIC_QTANGENT:
+		return 8;
 
 	}
 	return 0;
@@ -316,6 +316,14 @@ if (strcmp(desc.SemanticName, #name) == 0 && desc.SemanticIndex == index && GetP
 	continue;	\
 }
 
+	// packed semantics, the shader declares floats and the input assembler unpacks
+#define APPEND_PACKED_SEMNATIC(desc, name, index, sem, format)	\
+if (strcmp(desc.SemanticName, #name) == 0 && desc.SemanticIndex == index) {	\
+	mInputSemantics.push_back(sem);		\
+	desc.Format = format;	\
+	continue;	\
+}
+
 	for (size_t i = 0; i < mInputELementsDesc.size(); i++) {
 		D3D12_INPUT_ELEMENT_DESC &desc = mInputELementsDesc[i];
 		CHECK_AND_APPEND_SEMNATIC(desc, POSITION, 0, SEMANTIC_POSITION);
@@ -328,6 +336,11 @@ if (strcmp(desc.SemanticName, #name) == 0 && desc.SemanticIndex == index && GetP
 		CHECK_AND_APPEND_SEMNATIC(desc, COLOR, 0, SEMANTIC_COLOR);
 		CHECK_AND_APPEND_SEMNATIC(desc, POSITION2D, 0, SEMANTIC_POSITION2D);
 
+		APPEND_PACKED_SEMNATIC(desc, QTANGENT, 0, SEMANTIC_QTANGENT, DXGI_FORMAT_R16G16B16A16_SNORM);
+		APPEND_PACKED_SEMNATIC(desc, NORMALOCT, 0, SEMANTIC_NORMAL_OCT, DXGI_FORMAT_R16G16_SNORM);
+		APPEND_PACKED_SEMNATIC(desc, UVHALF, 0, SEMANTIC_UV0_HALF, DXGI_FORMAT_R16G16_FLOAT);
+		APPEND_PACKED_SEMNATIC(desc, UVHALF, 1, SEMANTIC_UV1_HALF, DXGI_FORMAT_R16G16_FLOAT);
+
 		if (strcmp(desc.SemanticName, "COLOR") == 0) {
 			mInputSemantics.push_back(SEMANTIC_COLOR);
 			desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -339,6 +352,7 @@ if (strcmp(desc.SemanticName, #name) == 0 && desc.SemanticIndex == index && GetP
 	}
 
 #undef CHECK_AND_APPEND_SEMNATIC
+#undef APPEND_PACKED_SEMNATIC
 	return true;
 }
 
@@ -49,6 +49,8 @@ inline uint16_t GetPixelSize(DXGI_FORMAT format) {
 	case DXGI_FORMAT_R32_FLOAT:
 	case DXGI_FORMAT_D24_UNORM_S8_UINT:
 	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_FLOAT:
 		return 4;
 	case DXGI_FORMAT_R32G32_FLOAT:
 		return 8;
@@ -56,6 +58,7 @@ inline uint16_t GetPixelSize(DXGI_FORMAT format) {
 		return 12;
 	case DXGI_FORMAT_R16G16B16A16_UINT:
 	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
 		return 8;
 	case DXGI_FORMAT_R32G32B32A32_FLOAT:
 		return 16;
@@ -43,6 +43,41 @@ void RenderMesh::GetVertex(ERHIInputSemantic sem, int count, math::Vector3F &v)
     memcpy(v.value, mVertexData.data() + offset, 12);
 }
 
+void RenderMesh::GetVertices(ERHIInputSemantic sem, uint32_t begin, uint32_t num, math::SoAVector3F out) {
+    CHECK(HasSemantic(sem) && GetSemanticSize(sem) == 12);
+    CHECK((begin + num) * mVertexStride <= mVertexData.size());
+    const uint8_t* data = mVertexData.data() + begin * mVertexStride + mSemanticsOffset[sem];
+    for (uint32_t i = 0; i < num; i++, data += mVertexStride) {
+        float v[3];
+        memcpy(v, data, 12);
+        out.X[i] = v[0], out.Y[i] = v[1], out.Z[i] = v[2];
+    }
+}
+
+void RenderMesh::GetTriangles(int8_t idxGroup, int8_t vtxGroup, uint32_t begin, uint32_t num, math::SoATriangleF out) {
+    CHECK(HasSemantic(SEMANTIC_POSITION) && GetSemanticSize(SEMANTIC_POSITION) == 12);
+    CHECK((begin + num) * 3 <= GetIndexCount(idxGroup));
+    const uint8_t* index = mIndexData.data() + (GetIndexOffset(idxGroup) + begin * 3) * mIndexStride;
+    const uint8_t* vertex = mVertexData.data() + GetVertexOffset(vtxGroup) * mVertexStride + mSemanticsOffset[SEMANTIC_POSITION];
+    size_t vertexNum = mVertexData.size() / mVertexStride - GetVertexOffset(vtxGroup);
+    for (uint32_t i = 0; i < num; i++) {
+        math::Vector3F p[3];
+        for (int k = 0; k < 3; k++, index += mIndexStride) {
+            uint32_t idx = 0;
+            if (mIndexStride == 2) {
+                uint16_t idx16;
+                memcpy(&idx16, index, 2);
+                idx = idx16;
+            } else {
+                memcpy(&idx, index, 4);
+            }
+            CHECK(idx < vertexNum);
+            memcpy(p[k].value, vertex + idx * mVertexStride, 12);
+        }
+        out.Set(i, p[0], p[1], p[2]);
+    }
+}
+
 void RenderMesh::CopyVertex(uint32_t begin, uint32_t size, const void* data, int8_t idx) {
 	CHECK(begin % mVertexStride == 0 && size % mVertexStride == 0);
 
@@ -67,6 +67,10 @@ public:
     bool HasSemantic(ERHIInputSemantic sem);
     void GetVertex(ERHIInputSemantic sem, int count, math::Vector2F &v);
     void GetVertex(ERHIInputSemantic sem, int count, math::Vector3F &v);
+    // num vertices from begin, split into the arrays of out
+    void GetVertices(ERHIInputSemantic sem, uint32_t begin, uint32_t num, math::SoAVector3F out);
+    // positions of num triangles of an index group from triangle begin, indices based at the vertex group
+    void GetTriangles(int8_t idxGroup, int8_t vtxGroup, uint32_t begin, uint32_t num, math::SoATriangleF out);
 
 private:
 	bool mIsDynamic;
@@ -31,8 +31,8 @@ public:
 
 		// opaque
 		for (auto item : sceneCol->FilterItems(RENDER_SET_OPAQUE)) {
-			sceneCol->RetriveSceneParams(item->Material);
-			item->Draw();
+			sceneCol->RetriveSceneParams(item->Item->Material);
+			item->Item->Draw(item->WorldMatrix);
 		}
 	
 		return mRT;
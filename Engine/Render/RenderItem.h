@@ -14,7 +14,7 @@ class RenderItem : public RefCounter{
 public:
 	ERenderSet RenderSet;
 
-	math::Matrix4F WorldMatrix;
+	math::Affine3x4 WorldMatrix;
 	RefCountPtr<RenderMesh> Mesh;
 	RefCountPtr<MaterialInstance> Material;
 
@@ -33,9 +33,10 @@ public:
 		mMeshVertexGroup = idx;
 	}
 
-	void RetriveItemParams() {
-		// parameter
-		Material->SetParameter("World", (const float*)&WorldMatrix, 16);
+	void RetriveItemParams(const math::Affine3x4& world) {
+		// parameter, the shader takes the full 4x4
+		math::Matrix4F world4 = world.ToMatrix4();
+		Material->SetParameter("World", (const float*)&world4, 16);
 
 		// render option
 		int option = GRenderOptions.HDR ? 1 : 0;
@@ -44,13 +45,22 @@ public:
 	}
 
 
+	void RetriveItemParams() {
+		RetriveItemParams(WorldMatrix);
+	}
+
 	void Draw() {
+		Draw(WorldMatrix);
+	}
+
+	// world: the matrix collected with the item, see SceneCollection
+	void Draw(const math::Affine3x4& world) {
 		auto [vb, ib] = Mesh->GetRHIResource();
 		int num = Mesh->GetIndexCount(mMeshIndexGroup);
 		int baseIndex = Mesh->GetIndexOffset(mMeshIndexGroup);
 		int baseVertex = Mesh->GetVertexOffset(mMeshVertexGroup);
 
-		RetriveItemParams();
+		RetriveItemParams(world);
 		RenderStage::Apply();
 		GDevice->DrawIndexed(Material->GetShaderInstance(), vb, ib, Material->mRState, num, baseIndex, baseVertex);
 	}
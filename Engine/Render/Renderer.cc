@@ -20,7 +20,9 @@ Renderer::Renderer() :
 	mViewportWidth(0),
 	mViewportHeight(0) {
 	MaterialManager::LoadShaders(GApp->GetRootPath() / "Shader");
-	mSceneCol = new SceneCollection();
+	for (int i = 0; i < K_SCENE_COLLECTION_NUM; i++) {
+		mSceneCols[i] = new SceneCollection();
+	}
 
 	// render steps
 	mRenderSteps[RENDER_STEP_IMGUI] = new IMGuiStep();
@@ -39,7 +41,12 @@ Renderer::~Renderer() {
 
 
 SceneCollection* Renderer::GetSceneCollection() {
-	return mSceneCol;
+	return mSceneCols[mFrontCol];
+}
+
+void Renderer::SwapCollection() {
+	mFrontCol = mBackCol;
+	mBackCol = (mBackCol + 1) % K_SCENE_COLLECTION_NUM;
 }
 
 void Renderer::Resize(uint32_t width, uint32_t height) {
@@ -67,10 +74,11 @@ void Renderer::Tick() {
 	}
 
 
-	mSceneCol->Reset();
+	SceneCollection* collection = mSceneCols[mBackCol];
+	collection->Reset();
 	Scene* scn = GDirector->GetCurScene();
 	if (scn) {	
-		scn->CollectRender(mSceneCol);;
+		scn->CollectRender(collection);
 	}
 
 }
@@ -99,9 +107,10 @@ void Renderer::Render() {
 
 	// Editor Items
 	RenderStage::CurStage()->SetRenderTarget(mBackRT, GetDepthStencil());
-	for (auto item : mSceneCol->FilterItems(RENDER_SET_EDITOR)) {
-		mSceneCol->RetriveSceneParams(item->Material);
-		item->Draw();
+	SceneCollection* sceneCol = GetSceneCollection();
+	for (auto item : sceneCol->FilterItems(RENDER_SET_EDITOR)) {
+		sceneCol->RetriveSceneParams(item->Item->Material);
+		item->Item->Draw(item->WorldMatrix);
 	}
 
 	// === Post Process ===
@@ -14,15 +14,23 @@ namespace z {
 class SceneCollection;
 class RenderItem;
 
+// scene collections: one rendered, one collected into while it renders
+const int K_SCENE_COLLECTION_NUM = 2;
+
 class Renderer : public RefCounter {
 public:
 	Renderer();
 	virtual ~Renderer();
 
 	void Resize(uint32_t width, uint32_t height);
+	// collect the scene into the back collection
 	void Tick();
+	// the back collection is rendered next, call when neither Tick nor Render runs
+	void SwapCollection();
+	// draw the front collection
 	void Render();
 	
+	// the collection being rendered
 	SceneCollection* GetSceneCollection();
 
 	DepthStencil *GetDepthStencil() {
@@ -40,7 +48,10 @@ private:
 
 	std::unordered_map<ERenderStep, RefCountPtr<RenderStep>> mRenderSteps;
 
-	RefCountPtr<SceneCollection> mSceneCol;
+	RefCountPtr<SceneCollection> mSceneCols[K_SCENE_COLLECTION_NUM];
+	// front is rendered, back is collected
+	int mFrontCol{ 0 };
+	int mBackCol{ 1 };
 	
 
 };
@@ -7,8 +7,19 @@
 
 namespace z {
 
+/*
+What the scene hands to the renderer for one frame. items are kept with the
+world matrix they had when collected, so the scene can move on while this
+collection renders (see Director::SetPipelined). the render side only reads
+items through the raw pointers of FilterItems
+*/
 class SceneCollection : public RefCounter {
 public:
+	struct CollectedItem {
+		RefCountPtr<RenderItem> Item;
+		math::Affine3x4 WorldMatrix;
+	};
+
 	void Reset() {
 		mRenderItems.clear();
 	}
@@ -20,14 +31,14 @@ public:
 	}
 
 	void PushRenderItem(RenderItem* item) {
-		mRenderItems.push_back(item);
+		mRenderItems.push_back({ item, item->WorldMatrix });
 	}
 
-	std::vector<RenderItem*> FilterItems(ERenderSet rset) {
-		std::vector<RenderItem*> result;
+	std::vector<const CollectedItem*> FilterItems(ERenderSet rset) const {
+		std::vector<const CollectedItem*> result;
 		for (auto& item : mRenderItems) {
-			if (item->RenderSet == rset) {
-				result.push_back(item);
+			if (item.Item->RenderSet == rset) {
+				result.push_back(&item);
 			}
 		}
 		return result;
@@ -53,7 +64,7 @@ public:
 	math::Vector4F ShaderParams[SP_MAX];
 
 private:
-	std::vector<RefCountPtr<RenderItem>> mRenderItems;
+	std::vector<CollectedItem> mRenderItems;
 	
 	math::Vector3F mCameraPos;
 	math::Matrix4F mViewMatrix;
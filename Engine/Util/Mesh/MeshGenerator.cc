@@ -102,9 +102,22 @@ RenderMesh* MeshGenerator::CreateSphere(float radius, uint32_t sliceCount, uint3
 	float phiStep = math::K_PI / stackCount;
 	float thetaStep = 2.0f * math::K_PI / sliceCount;
 
+	// sin and cos of the stack angles, then of the slice angles the rings share
+	std::vector<float> angles(stackCount + sliceCount + 1), sins(angles.size()), coss(angles.size());
+	for (uint32_t i = 0; i < stackCount; ++i) {
+		angles[i] = i * phiStep;
+	}
+	for (uint32_t j = 0; j <= sliceCount; ++j) {
+		angles[stackCount + j] = j * thetaStep;
+	}
+	math::SinCos(angles.data(), sins.data(), coss.data(), angles.size());
+	const float* sinTheta = &sins[stackCount];
+	const float* cosTheta = &coss[stackCount];
+
 	// Compute vertices for each stack ring (do not count the poles as rings).
 	for (uint32_t i = 1; i <= stackCount - 1; ++i) {
 		float phi = i * phiStep;
+		float sinPhi = sins[i], cosPhi = coss[i];
 
 		// Vertices of ring.
 		for (uint32_t j = 0; j <= sliceCount; ++j) {
@@ -113,17 +126,12 @@ RenderMesh* MeshGenerator::CreateSphere(float radius, uint32_t sliceCount, uint3
 			Vertex v;
 
 			// spherical to cartesian
-			v.Position.x = radius * sinf(phi) * cosf(theta);
-			v.Position.y = radius * cosf(phi);
-			v.Position.z = radius * sinf(phi) * sinf(theta);
+			v.Normal = math::Vector3F(sinPhi * cosTheta[j], cosPhi, sinPhi * sinTheta[j]);
+			v.Position = v.Normal * radius;
 
-			// Partial derivative of P with respect to theta
-			v.TangentU.x = -radius * sinf(phi) * sinf(theta);
-			v.TangentU.y = 0.0f;
-			v.TangentU.z = +radius * sinf(phi) * cosf(theta);
+			// Partial derivative of P with respect to theta, normalized (sin(phi) > 0)
+			v.TangentU = math::Vector3F(-sinTheta[j], 0.0f, cosTheta[j]);
 
-			v.TangentU = math::Normalize(v.TangentU);
-			v.Normal = math::Normalize(v.Position);
 			v.TexC.x = theta / math::K_2PI;
 			v.TexC.y = phi / math::K_PI;
 
@@ -216,6 +224,24 @@ void MeshGenerator::Subdivide(MeshData& meshData) {
 		meshData.Indices32.push_back(i * 6 + 1);
 		meshData.Indices32.push_back(i * 6 + 4);
 	}
+
+	// normals and tangents of the midpoints, 3 per triangle, normalized in bulk
+	uint32_t midNum = numTris * 3;
+	std::vector<float> soa(midNum * 6);
+	math::SoAVector3F normals{ &soa[0], &soa[midNum], &soa[midNum * 2] };
+	math::SoAVector3F tangents{ &soa[midNum * 3], &soa[midNum * 4], &soa[midNum * 5] };
+	for (uint32_t i = 0; i < midNum; ++i) {
+		const Vertex& v = meshData.Vertices[(i / 3) * 6 + 3 + i % 3];
+		normals.Set(i, v.Normal);
+		tangents.Set(i, v.TangentU);
+	}
+	math::NormalizeVectors(normals, normals, midNum);
+	math::NormalizeVectors(tangents, tangents, midNum);
+	for (uint32_t i = 0; i < midNum; ++i) {
+		Vertex& v = meshData.Vertices[(i / 3) * 6 + 3 + i % 3];
+		v.Normal = normals.Get(i);
+		v.TangentU = tangents.Get(i);
+	}
 }
 
 MeshGenerator::Vertex MeshGenerator::MidPoint(const Vertex& v0, const Vertex& v1) {
@@ -229,11 +255,12 @@ MeshGenerator::Vertex MeshGenerator::MidPoint(const Vertex& v0, const Vertex& v1
 	math::Vector2F tex1 = v1.TexC;
 
 	// Compute the midpoints of all the attributes.  Vectors need to be normalized
-	// since linear interpolating can make them not unit length.  
+	// since linear interpolating can make them not unit length, Subdivide does
+	// that for all midpoints at once.
 	Vertex v;
 	v.Position = 0.5f * (p0 + p1);
-	v.Normal = math::Normalize(0.5f * (n0 + n1));
-	v.TangentU = math::Normalize(0.5f * (tan0 + tan1));
+	v.Normal = 0.5f * (n0 + n1);
+	v.TangentU = 0.5f * (tan0 + tan1);
 	v.TexC = 0.5f * (tex0 + tex1);
 	return v;
 }
@@ -323,18 +350,29 @@ RenderMesh* MeshGenerator::CreateCylinder(float bottomRadius, float topRadius, f
 
 	uint32_t ringCount = stackCount + 1;
 
+	// one ring of sin and cos for the rings and both caps
+	float dTheta = 2.0f * math::K_PI / sliceCount;
+	std::vector<float> angles(sliceCount + 1), sins(sliceCount + 1), coss(sliceCount + 1);
+	for (uint32_t j = 0; j <= sliceCount; ++j) {
+		angles[j] = j * dTheta;
+	}
+	math::SinCos(angles.data(), sins.data(), coss.data(), angles.size());
+
+	// the normal is (height * c, dr, height * s) over its length, the same for all
+	float dr = bottomRadius - topRadius;
+	float normalScale = 1.0f / std::sqrt(height * height + dr * dr);
+
 	// Compute vertices for each stack ring starting at the bottom and moving up.
 	for (uint32_t i = 0; i < ringCount; ++i) {
 		float y = -0.5f * height + i * stackHeight;
 		float r = bottomRadius + i * radiusStep;
 
 		// vertices of ring
-		float dTheta = 2.0f * math::K_PI / sliceCount;
 		for (uint32_t j = 0; j <= sliceCount; ++j) {
 			Vertex vertex;
 
-			float c = cosf(j * dTheta);
-			float s = sinf(j * dTheta);
+			float c = coss[j];
+			float s = sins[j];
 
 			vertex.Position = math::Vector3F(r * c, y, r * s);
 
@@ -363,9 +401,8 @@ RenderMesh* MeshGenerator::CreateCylinder(float bottomRadius, float topRadius, f
 			// This is unit length.
 			vertex.TangentU = math::Vector3F(-s, 0.0f, c);
 
-			float dr = bottomRadius - topRadius;
-			math::Vector3F bitangent(dr * c, -height, dr * s);
-			vertex.Normal = math::Normalize(math::Cross(vertex.TangentU, bitangent));
+			// cross(TangentU, bitangent), bitangent = (dr * c, -height, dr * s)
+			vertex.Normal = math::Vector3F(height * c, dr, height * s) * normalScale;
 
 			meshData.Vertices.push_back(vertex);
 		}
@@ -388,23 +425,22 @@ RenderMesh* MeshGenerator::CreateCylinder(float bottomRadius, float topRadius, f
 		}
 	}
 
-	BuildCylinderTopCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
-	BuildCylinderBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
+	BuildCylinderTopCap(topRadius, height, sliceCount, sins.data(), coss.data(), meshData);
+	BuildCylinderBottomCap(bottomRadius, height, sliceCount, sins.data(), coss.data(), meshData);
 
 	return ConvertToMesh(meshData);
 }
 //
-void MeshGenerator::BuildCylinderTopCap(float bottomRadius, float topRadius, float height,
-	uint32_t sliceCount, uint32_t stackCount, MeshData& meshData) {
+void MeshGenerator::BuildCylinderTopCap(float topRadius, float height,
+	uint32_t sliceCount, const float* sins, const float* coss, MeshData& meshData) {
 	uint32_t baseIndex = (uint32_t)meshData.Vertices.size();
 
 	float y = 0.5f * height;
-	float dTheta = 2.0f * math::K_PI / sliceCount;
 
 	// Duplicate cap ring vertices because the texture coordinates and normals differ.
 	for (uint32_t i = 0; i <= sliceCount; ++i) {
-		float x = topRadius * cosf(i * dTheta);
-		float z = topRadius * sinf(i * dTheta);
+		float x = topRadius * coss[i];
+		float z = topRadius * sins[i];
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
@@ -427,8 +463,8 @@ void MeshGenerator::BuildCylinderTopCap(float bottomRadius, float topRadius, flo
 	}
 }
 //
-void MeshGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadius, float height,
-	uint32_t sliceCount, uint32_t stackCount, MeshData& meshData)
+void MeshGenerator::BuildCylinderBottomCap(float bottomRadius, float height,
+	uint32_t sliceCount, const float* sins, const float* coss, MeshData& meshData)
 {
 	// 
 	// Build bottom cap.
@@ -438,10 +474,9 @@ void MeshGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadius,
 	float y = -0.5f * height;
 
 	// vertices of ring
-	float dTheta = 2.0f * math::K_PI / sliceCount;
 	for (uint32_t i = 0; i <= sliceCount; ++i) {
-		float x = bottomRadius * cosf(i * dTheta);
-		float z = bottomRadius * sinf(i * dTheta);
+		float x = bottomRadius * coss[i];
+		float z = bottomRadius * sins[i];
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
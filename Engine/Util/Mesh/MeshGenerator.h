@@ -46,8 +46,9 @@ public:
 private:
 	static void Subdivide(MeshData& meshData);
 	static Vertex MidPoint(const Vertex& v0, const Vertex& v1);
-	static void BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32_t sliceCount, uint32_t stackCount, MeshData& meshData);
-	static void BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32_t sliceCount, uint32_t stackCount, MeshData& meshData);
+	// sins and coss: the sliceCount + 1 ring angles
+	static void BuildCylinderTopCap(float topRadius, float height, uint32_t sliceCount, const float* sins, const float* coss, MeshData& meshData);
+	static void BuildCylinderBottomCap(float bottomRadius, float height, uint32_t sliceCount, const float* sins, const float* coss, MeshData& meshData);
 };
 
 }
@@ -32,6 +32,8 @@ class Module(object):
         self.TYPE = tp
         self.excludes = None
         self.vsfolder = None
+        # override CMAKE_CXX_STANDARD for this target
+        self.cxx_standard = None
 
 class CMakeBuilder(object):
     def __init__(self):
@@ -70,6 +72,8 @@ class CMakeBuilder(object):
 
         if target.vsfolder:
             output += T.TARGET_FOLDER_TEMPLATE.replace("%NAME%", target.NAME).replace("%GROUP_KEY%", target.vsfolder)
+        if target.cxx_standard:
+            output += T.TARGET_STANDARD_TEMPLATE.replace("%NAME%", target.NAME).replace("%STD%", str(target.cxx_standard))
 
         self.AppendOutput(output)
 
@@ -93,6 +97,8 @@ class CMakeBuilder(object):
 
         if target.vsfolder:
             output += T.TARGET_FOLDER_TEMPLATE.replace("%NAME%", target.NAME).replace("%GROUP_KEY%", target.vsfolder)
+        if target.cxx_standard:
+            output += T.TARGET_STANDARD_TEMPLATE.replace("%NAME%", target.NAME).replace("%STD%", str(target.cxx_standard))
 
         self.AppendOutput(output)
 
@@ -15,6 +15,10 @@ TARGET_FOLDER_TEMPLATE = '''\
 set_property(TARGET %NAME% PROPERTY FOLDER %GROUP_KEY%)
 '''
 
+TARGET_STANDARD_TEMPLATE = '''\
+set_property(TARGET %NAME% PROPERTY CXX_STANDARD %STD%)
+'''
+
 HEADER_TEMPLATE = '''
 project(%PROJECT_NAME%)
 
@@ -1,12 +1,18 @@
 #include <Startup/Win32/win32App.h>
 #include <Util/Image/Image.h>
+#include <cstring>
 
 using namespace z;
 
-int main(int argc, char *argv) {
+int main(int argc, char *argv[]) {
 
 	z::Win32App app;
 	app.SetEditorUIEnable(true);
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-pipelined") == 0) {
+			app.SetFramePipelined(true);
+		}
+	}
     if (app.Init()) app.Run();
     return 0;
 }
\ No newline at end of file
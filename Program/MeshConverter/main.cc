@@ -1,4 +1,5 @@
 #include <Core/CoreHeader.h>
+#include <Core/Scheduler/Parallel.h>
 #include <RHI/RHIConst.h>
 #include <Util/Mesh/ZMeshLoader.h>
 
@@ -12,11 +13,15 @@
 #include <cstdint>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <thread>
 
 using namespace z;
 
 class MeshLoader {
 public:
+	explicit MeshLoader(sched::ParallelScheduler& sc) : mSched(sc) {}
+
 	bool LoadMesh(std::string const& mesh_path) {
 		Assimp::Importer importer;
 		const aiScene* scn = importer.ReadFile(mesh_path, aiProcess_Triangulate |  aiProcess_FlipUVs);
@@ -49,9 +54,10 @@ public:
 		ss_bin.write((char*)& header, sizeof(z::SubMeshFileHeader));
 
 		for (size_t i = 0; i < mIS.size(); i++) {
-			for (size_t j = 0; j < mIS[i].size(); j++) {
-				mIS[i][j] += base;
-			}
+			std::vector<uint32_t>& is = mIS[i];
+			sched::ParallelFor(mSched, 0, is.size(), [&is, base](size_t j) {
+				is[j] += base;
+			});
 			base += mVSnum[i];
 
 			ss_bin.write((char*)mIS[i].data(), mIS[i].size() * sizeof(uint32_t));
@@ -69,6 +75,8 @@ public:
 
 
 private:
+	sched::ParallelScheduler& mSched;
+
 	std::vector<std::vector<float>> mVS;
 	std::vector<uint32_t> mVSnum;
 	std::vector<std::vector<uint32_t>> mIS;
@@ -97,53 +105,71 @@ private:
 		std::vector<float> vs;
 		std::vector<uint32_t> is;
 
-		for (size_t i = 0; i < mesh->mNumVertices; i++) {
+		// floats of a vertex, each vertex is written to its own slot in parallel
+		size_t stride = 0;
+		stride += mesh->HasPositions() ? 3 : 0;
+		stride += mesh->HasNormals() ? 3 : 0;
+		stride += mesh->HasTangentsAndBitangents() ? 6 : 0;
+		stride += mesh->HasTextureCoords(0) ? 2 : 0;
+		stride += mesh->HasTextureCoords(1) ? 2 : 0;
+		vs.resize(mesh->mNumVertices * stride);
+
+		sched::ParallelFor(mSched, 0, mesh->mNumVertices, [&vs, mesh, stride](size_t i) {
+			float* v = vs.data() + i * stride;
 			// position
 			if (mesh->HasPositions()) {
-				vs.push_back(mesh->mVertices[i].x * 0.1f);
-				vs.push_back(mesh->mVertices[i].y * 0.1f);
-				vs.push_back(mesh->mVertices[i].z * 0.1f);
+				*v++ = mesh->mVertices[i].x * 0.1f;
+				*v++ = mesh->mVertices[i].y * 0.1f;
+				*v++ = mesh->mVertices[i].z * 0.1f;
 			}
 
 			// normal
 			if (mesh->HasNormals()) {
-				vs.push_back(mesh->mNormals[i].x);
-				vs.push_back(mesh->mNormals[i].y);
-				vs.push_back(mesh->mNormals[i].z);
+				*v++ = mesh->mNormals[i].x;
+				*v++ = mesh->mNormals[i].y;
+				*v++ = mesh->mNormals[i].z;
 			}
 
 			// tangents
 			if (mesh->HasTangentsAndBitangents()) {
-				vs.push_back(mesh->mTangents[i].x);
-				vs.push_back(mesh->mTangents[i].y);
-				vs.push_back(mesh->mTangents[i].z);
+				*v++ = mesh->mTangents[i].x;
+				*v++ = mesh->mTangents[i].y;
+				*v++ = mesh->mTangents[i].z;
 
-				vs.push_back(mesh->mBitangents[i].x);
-				vs.push_back(mesh->mBitangents[i].y);
-				vs.push_back(mesh->mBitangents[i].z);
+				*v++ = mesh->mBitangents[i].x;
+				*v++ = mesh->mBitangents[i].y;
+				*v++ = mesh->mBitangents[i].z;
 			}
 
 			// uv1
 			if (mesh->HasTextureCoords(0)) {
-				vs.push_back(mesh->mTextureCoords[0][i].x);
-				vs.push_back(mesh->mTextureCoords[0][i].y);
+				*v++ = mesh->mTextureCoords[0][i].x;
+				*v++ = mesh->mTextureCoords[0][i].y;
 			}
 
 			// uv2
 			if (mesh->HasTextureCoords(1)) {
-				vs.push_back(mesh->mTextureCoords[1][i].x);
-				vs.push_back(mesh->mTextureCoords[1][i].y);
+				*v++ = mesh->mTextureCoords[1][i].x;
+				*v++ = mesh->mTextureCoords[1][i].y;
 			}
-		}
-
-		// index
-		for (size_t i = 0; i < mesh->mNumFaces; i++) {
-			aiFace face = mesh->mFaces[i];
-
+		});
+
+		// index, faces are triangles after aiProcess_Triangulate but points and lines stay,
+		// a scan of the index counts gives where each face goes
+		std::vector<uint32_t> faceEnd(mesh->mNumFaces);
+		sched::ParallelFor(mSched, 0, mesh->mNumFaces, [&faceEnd, mesh](size_t i) {
+			faceEnd[i] = mesh->mFaces[i].mNumIndices;
+		});
+		sched::ParallelScan(mSched, faceEnd.begin(), faceEnd.end(), faceEnd.begin(), 0u,
+			[](uint32_t a, uint32_t b) { return a + b; });
+		is.resize(faceEnd.empty() ? 0 : faceEnd.back());
+		sched::ParallelFor(mSched, 0, mesh->mNumFaces, [&is, &faceEnd, mesh](size_t i) {
+			const aiFace& face = mesh->mFaces[i];
+			uint32_t* out = is.data() + faceEnd[i] - face.mNumIndices;
 			for (size_t j = 0; j < face.mNumIndices; j++) {
-				is.push_back(face.mIndices[j]);
+				out[j] = face.mIndices[j];
 			}
-		}
+		});
 
 		header.IndexCount[header.IndexNum++] = is.size();
 		header.VertCount += mesh->mNumVertices;
@@ -197,6 +223,10 @@ int main(int argc, char* argv[]) {
 		Log<LERROR>("File Not Exist");
 		return 0;
 	}
-	MeshLoader().LoadMesh(f);
+	sched::ThreadWorker worker(std::max(1u, std::thread::hardware_concurrency()), sched::SERVICE_WORK_STEALING);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+	MeshLoader(sc).LoadMesh(f);
+	worker.Stop();
 	return 0;
 }
\ No newline at end of file
@@ -57,4 +57,26 @@ float3 DecodeGamma(float3 Color) {
 
 float3 EncodeGamma(float3 Color) {
 	return pow(abs(Color), 1 / 2.2);
-}
\ No newline at end of file
+}
+// packed vertex attributes, encoded by Core/Math/Packing.h
+
+float3 DecodeOctNormal(float2 e) {
+	float3 n = float3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0) {
+		n.xy = (1.0 - abs(n.yx)) * (n.xy >= 0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+float3 QuaternionRotate(float4 q, float3 v) {
+	float3 t = 2 * cross(q.xyz, v);
+	return v + q.w * t + cross(q.xyz, t);
+}
+
+// w carries the handedness, q and -q are the same rotation
+void DecodeQTangent(float4 q, out float3 normal, out float3 tangent, out float3 binormal) {
+	q = normalize(q);
+	tangent = QuaternionRotate(q, float3(1, 0, 0));
+	normal = QuaternionRotate(q, float3(0, 0, 1));
+	binormal = cross(normal, tangent) * (q.w < 0 ? -1.0 : 1.0);
+}
@@ -0,0 +1,65 @@
+# -*- coding: utf-8 -*-
+# compare two json files of a benchmark suite (see BenchSchedSuite.cc, BenchMathSuite.cc)
+#   python BenchCompare.py base.json new.json [threshold]
+# prints the change of every median, exits with 1 if any got worse than threshold (default 0.1 = 10%)
+
+from __future__ import print_function
+
+import json
+import sys
+
+
+def key_of(result):
+    return (result["name"], result["mode"], result["threads"], result["metric"])
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data, dict((key_of(r), r) for r in data["results"])
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("usage: BenchCompare.py base.json new.json [threshold]")
+        return 2
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.1
+    base_data, base = load(sys.argv[1])
+    new_data, new = load(sys.argv[2])
+
+    if base_data.get("build") != new_data.get("build"):
+        print("build base", base_data.get("build"))
+        print("build new ", new_data.get("build"))
+
+    regressions = 0
+    for key in sorted(new.keys()):
+        if key not in base:
+            print("%-40s new" % "/".join(str(k) for k in key))
+            continue
+        b = base[key]["median"]
+        n = new[key]["median"]
+        if b == 0:
+            continue
+        # positive change is better
+        change = (n - b) / b
+        if new[key]["better"] == "lower":
+            change = -change
+        mark = ""
+        if change < -threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        elif change > threshold:
+            mark = "  improved"
+        print("%-40s %12.4g -> %12.4g %s %+6.1f%%%s" % (
+            "/".join(str(k) for k in key), b, n, new[key]["unit"], change * 100, mark))
+
+    for key in sorted(base.keys()):
+        if key not in new:
+            print("%-40s missing" % "/".join(str(k) for k in key))
+
+    print("%d regression(s) over %.0f%%" % (regressions, threshold * 100))
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,228 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace z;
+using namespace z::math;
+
+namespace {
+
+const int K_MATRIX_NUM = 1024;
+const int K_ROUNDS = 2000;
+
+std::vector<Matrix4F> GMatrices;
+std::vector<Vector4F> GVectors;
+// results are stored whole, or the compiler drops what isn't read
+std::vector<Matrix4F> GOutMatrices;
+std::vector<Vector4F> GOutVectors;
+std::vector<Quaternion> GQuaternions;
+std::vector<Quaternion> GOutQuaternions;
+std::vector<Affine3x4> GAffines;
+std::vector<Affine3x4> GOutAffines;
+
+// ns per call of op(i), over K_ROUNDS passes of the matrix array
+template<typename Op>
+double Measure(Op&& op) {
+	auto begin = std::chrono::steady_clock::now();
+	for (int r = 0; r < K_ROUNDS; r++) {
+		for (int i = 0; i < K_MATRIX_NUM; i++) {
+			op(i);
+		}
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+	return ns / (double(K_ROUNDS) * K_MATRIX_NUM);
+}
+
+const size_t K_BATCH_NUM = 10000;
+const int K_BATCH_ROUNDS = 200;
+
+// ns per item of a batch kernel run over K_BATCH_NUM items
+template<typename Op>
+double MeasureBatch(Op&& op) {
+	auto begin = std::chrono::steady_clock::now();
+	for (int r = 0; r < K_BATCH_ROUNDS; r++) {
+		op();
+	}
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+	return ns / (double(K_BATCH_ROUNDS) * K_BATCH_NUM);
+}
+
+void Report(const char* name, double simd, double scalar) {
+	Log<LINFO>(name, "simd", simd, "ns scalar", scalar, "ns speedup", scalar / simd);
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	GMatrices.resize(K_MATRIX_NUM);
+	GVectors.resize(K_MATRIX_NUM);
+	GOutMatrices.resize(K_MATRIX_NUM);
+	GOutVectors.resize(K_MATRIX_NUM);
+	GQuaternions.resize(K_MATRIX_NUM);
+	GOutQuaternions.resize(K_MATRIX_NUM);
+	GAffines.resize(K_MATRIX_NUM);
+	GOutAffines.resize(K_MATRIX_NUM);
+	for (int i = 0; i < K_MATRIX_NUM; i++) {
+		GMatrices[i] = MatrixTransform(Vector3F(dist(rng), dist(rng), dist(rng))) *
+			MatrixRotationAxis(Vector3F(dist(rng), dist(rng), dist(rng)), dist(rng));
+		GVectors[i] = Vector4F(dist(rng), dist(rng), dist(rng), 1.0f);
+		GQuaternions[i] = Quaternion::FromAxisAngle(Vector3F(dist(rng), dist(rng), dist(rng)), dist(rng));
+		GAffines[i] = Affine3x4(GMatrices[i]);
+	}
+	const int last = K_MATRIX_NUM - 1;
+
+	Log<LINFO>("math backend", Z_MATH_SIMD, "(0 scalar, 1 sse, 2 avx),", K_MATRIX_NUM, "matrices x", K_ROUNDS);
+	Report("multiply ",
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i] * GMatrices[last - i]; }),
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i].MulScalar(GMatrices[last - i]); }));
+	Report("transform",
+		Measure([&](int i) { GOutVectors[i] = GMatrices[i] * GVectors[i]; }),
+		Measure([&](int i) { GOutVectors[i] = GMatrices[i].TransformScalar(GVectors[i]); }));
+	Report("transpose",
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i].GetTranspose(); }),
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i].GetTransposeScalar(); }));
+	Report("inverse  ",
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i].GetInverse(); }),
+		Measure([&](int i) { GOutMatrices[i] = GMatrices[i].GetInverseScalar(); }));
+	Report("quat mul ",
+		Measure([&](int i) { GOutQuaternions[i] = GQuaternions[i] * GQuaternions[last - i]; }),
+		Measure([&](int i) { GOutQuaternions[i] = GQuaternions[i].MulScalar(GQuaternions[last - i]); }));
+	// the transforms of the matrices above, against multiply and inverse
+	Report("affine mul",
+		Measure([&](int i) { GOutAffines[i] = GAffines[i] * GAffines[last - i]; }),
+		Measure([&](int i) { GOutAffines[i] = GAffines[i].MulScalar(GAffines[last - i]); }));
+	Report("affine inv",
+		Measure([&](int i) { GOutAffines[i] = GAffines[i].GetInverse(); }),
+		Measure([&](int i) { GOutAffines[i] = GAffines[i].GetInverseScalar(); }));
+
+	// soa batches, 10k instances as culling would see them
+	std::vector<float> batchIn(K_BATCH_NUM * 6), batchOut(K_BATCH_NUM * 6);
+	for (size_t i = 0; i < K_BATCH_NUM * 3; i++) {
+		batchIn[i] = dist(rng);
+		batchIn[i + K_BATCH_NUM * 3] = batchIn[i] + std::abs(dist(rng));
+	}
+	auto soa = [](std::vector<float>& data, size_t first) {
+		return SoAVector3F{ &data[first * K_BATCH_NUM], &data[(first + 1) * K_BATCH_NUM], &data[(first + 2) * K_BATCH_NUM] };
+	};
+	SoAVector3F points = soa(batchIn, 0), pointsOut = soa(batchOut, 0);
+	SoABoxF boxes{ soa(batchIn, 0), soa(batchIn, 3) }, boxesOut{ soa(batchOut, 0), soa(batchOut, 3) };
+	const Matrix4F& m = GMatrices[0];
+	Box bounds;
+
+	Log<LINFO>("batch", K_BATCH_NUM, "items x", K_BATCH_ROUNDS, ", ns per item");
+	Report("points   ",
+		MeasureBatch([&]() { TransformPoints(m, points, pointsOut, K_BATCH_NUM); }),
+		MeasureBatch([&]() { TransformPointsScalar(m, points, pointsOut, K_BATCH_NUM); }));
+	Report("normals  ",
+		MeasureBatch([&]() { TransformNormals(m, points, pointsOut, K_BATCH_NUM); }),
+		MeasureBatch([&]() { TransformNormalsScalar(m, points, pointsOut, K_BATCH_NUM); }));
+	Report("bounds   ",
+		MeasureBatch([&]() { ComputeBounds(points, K_BATCH_NUM, bounds); }),
+		MeasureBatch([&]() { ComputeBoundsScalar(points, K_BATCH_NUM, bounds); }));
+	Report("boxes    ",
+		MeasureBatch([&]() { TransformBoxes(m, boxes, boxesOut, K_BATCH_NUM); }),
+		MeasureBatch([&]() { TransformBoxesScalar(m, boxes, boxesOut, K_BATCH_NUM); }));
+
+	// a camera just outside the boxes, three quarters of them visible
+	Camera cam(Vector3F(0, 0, -10), Vector3F(0, 0, 0));
+	cam.SetPerspective(K_PI / 3, 16.0f / 9.0f, 0.1f, 1000.0f);
+	Frustum frustum(cam.GetViewProjectMatrix());
+	std::vector<uint32_t> visible(GetMaskWords(K_BATCH_NUM));
+	Report("cull box ",
+		MeasureBatch([&]() { CullBoxes(frustum, boxes, K_BATCH_NUM, visible.data()); }),
+		MeasureBatch([&]() { CullBoxesScalar(frustum, boxes, K_BATCH_NUM, visible.data()); }));
+	Report("cull sph ",
+		MeasureBatch([&]() { CullSpheres(frustum, points, &batchIn[K_BATCH_NUM * 3], K_BATCH_NUM, visible.data()); }),
+		MeasureBatch([&]() { CullSpheresScalar(frustum, points, &batchIn[K_BATCH_NUM * 3], K_BATCH_NUM, visible.data()); }));
+	size_t visibleNum = 0;
+	for (size_t i = 0; i < K_BATCH_NUM; i++) {
+		visibleNum += IsMaskSet(visible.data(), i);
+	}
+	Log<LINFO>("visible", visibleNum, "of", K_BATCH_NUM);
+
+	// picking, a mesh of nanosuit's size as a cloud of small triangles
+	const size_t triNum = 100000;
+	std::vector<float> triData(triNum * 9);
+	SoATriangleF tris{
+		{ &triData[0], &triData[triNum], &triData[triNum * 2] },
+		{ &triData[triNum * 3], &triData[triNum * 4], &triData[triNum * 5] },
+		{ &triData[triNum * 6], &triData[triNum * 7], &triData[triNum * 8] } };
+	for (size_t i = 0; i < triNum; i++) {
+		Vector3F p(dist(rng), dist(rng), dist(rng));
+		tris.Set(i, p, p + Vector3F(dist(rng), dist(rng), dist(rng)) * 0.05f, p + Vector3F(dist(rng), dist(rng), dist(rng)) * 0.05f);
+	}
+	Ray ray(Vector3F(0, 0, -20), Vector3F(0.01f, 0.02f, 1));
+	float hitT = K_MAXFLOAT;
+	size_t hitIndex = 0;
+	auto pick = [&](auto&& kernel) {
+		auto begin = std::chrono::steady_clock::now();
+		for (int r = 0; r < K_BATCH_ROUNDS; r++) {
+			hitT = K_MAXFLOAT;
+			kernel(ray, tris, triNum, hitT, hitIndex);
+		}
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / K_BATCH_ROUNDS;
+	};
+	Report("pick     ",
+		pick([](const Ray& r, SoATriangleF t, size_t n, float& ht, size_t& hi) { return IntersectTriangles(r, t, n, ht, hi); }),
+		pick([](const Ray& r, SoATriangleF t, size_t n, float& ht, size_t& hi) { return IntersectTrianglesScalar(r, t, n, ht, hi); }));
+	Log<LINFO>("pick over", triNum, "triangles, hit", hitIndex, "at", hitT);
+	// vertex packing, the float streams of 10k vertices
+	std::vector<uint16_t> halfs(K_BATCH_NUM * 3);
+	std::vector<int16_t> snorms(K_BATCH_NUM * 3);
+	for (size_t i = 0; i < K_BATCH_NUM; i++) {
+		points.Set(i, Normalize(points.Get(i) + Vector3F(0, 0, 0.01f)));
+	}
+	Report("half     ",
+		MeasureBatch([&]() { FloatToHalf(&batchIn[0], halfs.data(), K_BATCH_NUM); }),
+		MeasureBatch([&]() { FloatToHalfScalar(&batchIn[0], halfs.data(), K_BATCH_NUM); }));
+	Report("unhalf   ",
+		MeasureBatch([&]() { HalfToFloat(halfs.data(), &batchOut[0], K_BATCH_NUM); }),
+		MeasureBatch([&]() { HalfToFloatScalar(halfs.data(), &batchOut[0], K_BATCH_NUM); }));
+	Report("snorm16  ",
+		MeasureBatch([&]() { PackSnorm16(&batchIn[0], snorms.data(), K_BATCH_NUM); }),
+		MeasureBatch([&]() { PackSnorm16Scalar(&batchIn[0], snorms.data(), K_BATCH_NUM); }));
+	Report("oct      ",
+		MeasureBatch([&]() { PackNormalsOct(points, snorms.data(), K_BATCH_NUM); }),
+		MeasureBatch([&]() { PackNormalsOctScalar(points, snorms.data(), K_BATCH_NUM); }));
+
+	// the ring tables of the mesh generators, angles as a sphere of 10k vertices has
+	std::vector<float> angles(K_BATCH_NUM);
+	for (size_t i = 0; i < K_BATCH_NUM; i++) {
+		angles[i] = (float)i * K_2PI / 100.0f;
+	}
+	float* sins = &batchOut[0];
+	float* coss = &batchOut[K_BATCH_NUM];
+	Report("sincos   ",
+		MeasureBatch([&]() { SinCos(angles.data(), sins, coss, K_BATCH_NUM); }),
+		MeasureBatch([&]() { SinCosScalar(angles.data(), sins, coss, K_BATCH_NUM); }));
+	Report("sincos std",
+		MeasureBatch([&]() { SinCos(angles.data(), sins, coss, K_BATCH_NUM); }),
+		MeasureBatch([&]() {
+			for (size_t i = 0; i < K_BATCH_NUM; i++) {
+				sins[i] = std::sin(angles[i]);
+				coss[i] = std::cos(angles[i]);
+			}
+		}));
+	Report("atan2    ",
+		MeasureBatch([&]() { Atan2(&batchIn[0], &batchIn[K_BATCH_NUM], sins, K_BATCH_NUM); }),
+		MeasureBatch([&]() { Atan2Scalar(&batchIn[0], &batchIn[K_BATCH_NUM], sins, K_BATCH_NUM); }));
+	Report("rsqrt    ",
+		MeasureBatch([&]() { Rsqrt(&batchIn[K_BATCH_NUM * 3], sins, K_BATCH_NUM); }),
+		MeasureBatch([&]() { RsqrtScalar(&batchIn[K_BATCH_NUM * 3], sins, K_BATCH_NUM); }));
+	Report("normalize",
+		MeasureBatch([&]() { NormalizeVectors(soa(batchIn, 3), pointsOut, K_BATCH_NUM); }),
+		MeasureBatch([&]() { NormalizeVectorsScalar(soa(batchIn, 3), pointsOut, K_BATCH_NUM); }));
+
+	// keeps bounds alive
+	if (bounds.MinP.x > bounds.MaxP.x) {
+		Log<LINFO>("bounds", bounds);
+	}
+	return 0;
+}
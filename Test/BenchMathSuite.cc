@@ -0,0 +1,290 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Client/Entity/Transform.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace z;
+using namespace z::math;
+
+/*
+Core/Math benchmark suite, every case runs `repeat` times after a warm up run.
+results go to the log, and with --json to a file for BenchCompare.py.
+
+	BenchMathSuite [--json out.json] [--repeat R] [--filter name]
+
+mode "default" is the function the engine calls, simd when the backend has
+it, "scalar" its *Scalar reference. every case is timed twice, in ns/item:
+	*_warm: K_WARM_NUM items, passed over K_WARM_PASSES times, they stay in L2
+	*_cold: K_COLD_NUM items in one pass, after sweeping K_EVICT_BYTES
+		evicted them, as the first pass over the scene in a frame
+
+	mat_mul, mat_inverse, mat_transform: Matrix4F * Matrix4F, GetInverse, * Vector4F
+	affine_mul, affine_inverse, quat_mul: Affine3x4 and Quaternion
+	normalize, cross: Vector3F
+	rotation_axis: MatrixRotationAxis
+	get_transform: Transform::GetTransform, a world transform rebuild
+	points, normalize_soa, sincos: the SoA kernels of Batch.h and FastMath.h
+*/
+
+namespace {
+
+const size_t K_WARM_NUM = 1024;
+const int K_WARM_PASSES = 200;
+const size_t K_COLD_NUM = 64 * 1024;
+const size_t K_EVICT_BYTES = 64 * 1024 * 1024;
+
+double Seconds(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// inputs and outputs of every case, K_COLD_NUM items, warm runs use the front
+struct Data {
+	std::vector<Matrix4F> MatA, MatB, MatOut;
+	std::vector<Affine3x4> AffA, AffB, AffOut;
+	std::vector<Quaternion> QuatA, QuatB, QuatOut;
+	std::vector<Vector4F> Vec4, Vec4Out;
+	std::vector<Vector3F> Vec3A, Vec3B, Vec3Out;
+	std::vector<float> Angles, Sins, Coss;
+	std::vector<Transform> Transforms;
+	// x, y, z of the inputs then of the outputs
+	std::vector<float> SoAData;
+	SoAVector3F SoAIn, SoAOut;
+
+	Data() {
+		std::mt19937 rng(25);
+		std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+		auto vec3 = [&]() { return Vector3F(dist(rng), dist(rng), dist(rng)); };
+		size_t n = K_COLD_NUM;
+		MatA.resize(n), MatB.resize(n), MatOut.resize(n);
+		AffA.resize(n), AffB.resize(n), AffOut.resize(n);
+		QuatA.resize(n), QuatB.resize(n), QuatOut.resize(n);
+		Vec4.resize(n), Vec4Out.resize(n);
+		Vec3A.resize(n), Vec3B.resize(n), Vec3Out.resize(n);
+		Angles.resize(n), Sins.resize(n), Coss.resize(n);
+		Transforms.resize(n);
+		SoAData.resize(n * 6);
+		SoAIn = { &SoAData[0], &SoAData[n], &SoAData[n * 2] };
+		SoAOut = { &SoAData[n * 3], &SoAData[n * 4], &SoAData[n * 5] };
+		for (size_t i = 0; i < n; i++) {
+			MatA[i] = MatrixTransform(vec3()) * MatrixRotationAxis(vec3(), dist(rng));
+			MatB[i] = MatrixRotationAxis(vec3(), dist(rng)) * MatrixTransform(vec3());
+			AffA[i] = Affine3x4(MatA[i]);
+			AffB[i] = Affine3x4(MatB[i]);
+			QuatA[i] = Quaternion::FromAxisAngle(vec3(), dist(rng));
+			QuatB[i] = Quaternion::FromAxisAngle(vec3(), dist(rng));
+			Vec4[i] = Vector4F(vec3(), 1.0f);
+			Vec3A[i] = vec3();
+			Vec3B[i] = vec3();
+			Angles[i] = dist(rng);
+			Transforms[i].SetPostion(vec3());
+			Transforms[i].SetRotation(QuatA[i]);
+			Transforms[i].SetScale(Vector3F(1.0f) + vec3() * 0.05f);
+			SoAIn.Set(i, vec3());
+		}
+	}
+};
+
+// runs the items [0, num)
+typedef std::function<void(size_t num)> KernelFunc;
+
+// a kernel of op(i) per item
+template<typename Op>
+KernelFunc Each(Op op) {
+	return [op](size_t num) {
+		for (size_t i = 0; i < num; i++) {
+			op(i);
+		}
+	};
+}
+
+
+struct Result {
+	std::string Name;
+	std::string Mode;
+	int Threads;
+	std::string Metric;
+	std::string Unit;
+	// "lower" or "higher"
+	std::string Better;
+	double Median;
+	double Min;
+	double Max;
+};
+
+struct Options {
+	std::string JsonPath;
+	std::string Filter;
+	int Repeat{ 5 };
+};
+
+class Suite {
+public:
+	explicit Suite(const Options& options) : mOptions(options), mEvict(K_EVICT_BYTES / sizeof(uint64_t), 1) {}
+
+	// name_warm and name_cold of one kernel
+	void Run(const std::string& name, const char* mode, KernelFunc func) {
+		RunCase(name + "_warm", mode, [&]() {
+			auto begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < K_WARM_PASSES; i++) {
+				func(K_WARM_NUM);
+			}
+			return Seconds(begin) * 1e9 / (double(K_WARM_PASSES) * K_WARM_NUM);
+		});
+		RunCase(name + "_cold", mode, [&]() {
+			Evict();
+			auto begin = std::chrono::steady_clock::now();
+			func(K_COLD_NUM);
+			return Seconds(begin) * 1e9 / K_COLD_NUM;
+		});
+	}
+
+	void WriteJson(std::ostream& os) const {
+		os << "{\n";
+		os << "  \"suite\": \"math\",\n";
+		os << "  \"build\": {\"compiler\": \"" << CompilerName() << "\", \"debug\": " << IsDebug()
+			<< ", \"math_simd\": \"" << BackendName() << "\"},\n";
+		os << "  \"machine\": {\"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n";
+		os << "  \"repeat\": " << mOptions.Repeat << ", \"warm_items\": " << K_WARM_NUM
+			<< ", \"cold_items\": " << K_COLD_NUM << ", \"evict_bytes\": " << K_EVICT_BYTES << ",\n";
+		os << "  \"results\": [";
+		for (size_t i = 0; i < mResults.size(); i++) {
+			const Result& r = mResults[i];
+			os << (i == 0 ? "\n" : ",\n");
+			os << "    {\"name\": \"" << r.Name << "\", \"mode\": \"" << r.Mode << "\", \"threads\": " << r.Threads
+				<< ", \"metric\": \"" << r.Metric << "\", \"unit\": \"" << r.Unit << "\", \"better\": \"" << r.Better
+				<< "\", \"median\": " << r.Median << ", \"min\": " << r.Min << ", \"max\": " << r.Max << "}";
+		}
+		os << "\n  ]\n}\n";
+	}
+
+private:
+	// run returns ns per item of one run
+	void RunCase(const std::string& name, const char* mode, const std::function<double()>& run) {
+		if (!mOptions.Filter.empty() && name.find(mOptions.Filter) == std::string::npos) {
+			return;
+		}
+
+		run();
+		std::vector<double> values;
+		for (int i = 0; i < mOptions.Repeat; i++) {
+			values.push_back(run());
+		}
+		std::sort(values.begin(), values.end());
+
+		Result result{ name, mode, 1, "time", "ns/item", "lower", values[values.size() / 2], values.front(), values.back() };
+		Log<LINFO>(name, mode, result.Median, "min", result.Min, "max", result.Max, result.Unit);
+		mResults.push_back(result);
+	}
+
+	// read and write a buffer larger than the last level cache
+	void Evict() {
+		uint64_t sum = 0;
+		for (uint64_t& v : mEvict) {
+			sum += v;
+			v = sum;
+		}
+		mEvictSink = sum;
+	}
+
+	static const char* BackendName() {
+		switch (Z_MATH_SIMD) {
+		case Z_MATH_SIMD_AVX: return "avx";
+		case Z_MATH_SIMD_SSE: return "sse";
+		default: return "scalar";
+		}
+	}
+
+	static std::string CompilerName() {
+#if defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#else
+		return "unknown";
+#endif
+	}
+
+	static int IsDebug() {
+#if defined(NDEBUG)
+		return 0;
+#else
+		return 1;
+#endif
+	}
+
+	Options mOptions;
+	std::vector<Result> mResults;
+	std::vector<uint64_t> mEvict;
+	volatile uint64_t mEvictSink{ 0 };
+};
+
+}
+
+
+int main(int argc, char* argv[]) {
+	Options options;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--json") {
+			options.JsonPath = argv[i + 1];
+		} else if (arg == "--repeat") {
+			options.Repeat = std::max(1, atoi(argv[i + 1]));
+		} else if (arg == "--filter") {
+			options.Filter = argv[i + 1];
+		} else {
+			Log<LERROR>("unknown option", arg);
+			return 1;
+		}
+	}
+
+	Data d;
+	Suite suite(options);
+
+	suite.Run("mat_mul", "default", Each([&](size_t i) { d.MatOut[i] = d.MatA[i] * d.MatB[i]; }));
+	suite.Run("mat_mul", "scalar", Each([&](size_t i) { d.MatOut[i] = d.MatA[i].MulScalar(d.MatB[i]); }));
+	suite.Run("mat_inverse", "default", Each([&](size_t i) { d.MatOut[i] = d.MatA[i].GetInverse(); }));
+	suite.Run("mat_inverse", "scalar", Each([&](size_t i) { d.MatOut[i] = d.MatA[i].GetInverseScalar(); }));
+	suite.Run("mat_transform", "default", Each([&](size_t i) { d.Vec4Out[i] = d.MatA[i] * d.Vec4[i]; }));
+	suite.Run("mat_transform", "scalar", Each([&](size_t i) { d.Vec4Out[i] = d.MatA[i].TransformScalar(d.Vec4[i]); }));
+	suite.Run("affine_mul", "default", Each([&](size_t i) { d.AffOut[i] = d.AffA[i] * d.AffB[i]; }));
+	suite.Run("affine_mul", "scalar", Each([&](size_t i) { d.AffOut[i] = d.AffA[i].MulScalar(d.AffB[i]); }));
+	suite.Run("affine_inverse", "default", Each([&](size_t i) { d.AffOut[i] = d.AffA[i].GetInverse(); }));
+	suite.Run("affine_inverse", "scalar", Each([&](size_t i) { d.AffOut[i] = d.AffA[i].GetInverseScalar(); }));
+	suite.Run("quat_mul", "default", Each([&](size_t i) { d.QuatOut[i] = d.QuatA[i] * d.QuatB[i]; }));
+	suite.Run("quat_mul", "scalar", Each([&](size_t i) { d.QuatOut[i] = d.QuatA[i].MulScalar(d.QuatB[i]); }));
+
+	// single implementation ones
+	suite.Run("normalize", "default", Each([&](size_t i) { d.Vec3Out[i] = Normalize(d.Vec3A[i]); }));
+	suite.Run("cross", "default", Each([&](size_t i) { d.Vec3Out[i] = Cross(d.Vec3A[i], d.Vec3B[i]); }));
+	suite.Run("rotation_axis", "default", Each([&](size_t i) { d.MatOut[i] = MatrixRotationAxis(d.Vec3A[i], d.Angles[i]); }));
+	suite.Run("get_transform", "default", Each([&](size_t i) { d.AffOut[i] = d.Transforms[i].GetTransform(); }));
+
+	suite.Run("points", "default", [&](size_t num) { TransformPoints(d.MatA[0], d.SoAIn, d.SoAOut, num); });
+	suite.Run("points", "scalar", [&](size_t num) { TransformPointsScalar(d.MatA[0], d.SoAIn, d.SoAOut, num); });
+	suite.Run("normalize_soa", "default", [&](size_t num) { NormalizeVectors(d.SoAIn, d.SoAOut, num); });
+	suite.Run("normalize_soa", "scalar", [&](size_t num) { NormalizeVectorsScalar(d.SoAIn, d.SoAOut, num); });
+	suite.Run("sincos", "default", [&](size_t num) { SinCos(d.Angles.data(), d.Sins.data(), d.Coss.data(), num); });
+	suite.Run("sincos", "scalar", [&](size_t num) { SinCosScalar(d.Angles.data(), d.Sins.data(), d.Coss.data(), num); });
+
+	if (!options.JsonPath.empty()) {
+		std::ofstream file(options.JsonPath);
+		if (!file) {
+			Log<LERROR>("can't write", options.JsonPath);
+			return 1;
+		}
+		suite.WriteJson(file);
+		Log<LINFO>("results written to", options.JsonPath);
+	}
+	return 0;
+}
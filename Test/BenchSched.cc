@@ -0,0 +1,469 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace z;
+
+// count every heap allocation of the process
+static std::atomic<int64_t> GAllocCount{ 0 };
+
+void* operator new(size_t size) {
+	GAllocCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+/* the pair is malloc and free, gcc only sees free on what operator new returned
+   once both are inlined
+*/
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// a few hundred cycles of work per task
+uint32_t TinyWork(uint32_t seed) {
+	for (int i = 0; i < 64; i++) {
+		seed = seed * 1664525u + 1013904223u;
+	}
+	return seed;
+}
+
+struct FanOutContext {
+	sched::ParallelScheduler* Sched;
+	std::atomic<int> Done{ 0 };
+	std::atomic<uint32_t> Sink{ 0 };
+};
+
+// binary task tree, every task posts its children from a worker thread
+void FanOut(FanOutContext* ctx, int depth) {
+	if (depth > 0) {
+		ctx->Sched->PostPar([ctx, depth]() { FanOut(ctx, depth - 1); });
+		ctx->Sched->PostPar([ctx, depth]() { FanOut(ctx, depth - 1); });
+	}
+	ctx->Sink.fetch_add(TinyWork(depth), std::memory_order_relaxed);
+	ctx->Done.fetch_add(1, std::memory_order_release);
+}
+
+double RunFanOut(sched::EServiceMode mode, int threads, int depth) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+
+	FanOutContext ctx;
+	ctx.Sched = &sc;
+	int total = (1 << (depth + 1)) - 1;
+
+	auto begin = std::chrono::steady_clock::now();
+	sc.PostPar([&ctx, depth]() { FanOut(&ctx, depth); });
+	while (ctx.Done.load(std::memory_order_acquire) < total) {
+		std::this_thread::yield();
+	}
+	auto end = std::chrono::steady_clock::now();
+	worker.Stop();
+
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+
+// the old ParallelTaskQueue storage, as the contention baseline
+class LockedTaskList {
+public:
+	LockedTaskList(size_t) {}
+
+	bool TryPush(sched::Task&& task) {
+		std::unique_lock<std::mutex> lock(mMutex);
+		mTasks.emplace_back(std::move(task));
+		return true;
+	}
+
+	bool TryPop(sched::Task& task) {
+		std::unique_lock<std::mutex> lock(mMutex);
+		if (mTasks.size() == 0) {
+			return false;
+		}
+		task = std::move(mTasks.front());
+		mTasks.pop_front();
+		return true;
+	}
+
+private:
+	std::list<sched::Task> mTasks;
+	std::mutex mMutex;
+};
+
+// producers push `total` tasks, consumers pop and run them
+template<typename Queue>
+double RunContention(int producers, int consumers, int total) {
+	Queue queue(4096);
+	std::atomic<int> done{ 0 };
+	std::atomic<uint32_t> sink{ 0 };
+	std::vector<std::thread> threads;
+
+	auto begin = std::chrono::steady_clock::now();
+	for (int p = 0; p < producers; p++) {
+		int num = total / producers + (p < total % producers ? 1 : 0);
+		threads.emplace_back([&queue, &sink, num]() {
+			for (int i = 0; i < num; i++) {
+				sched::Task task = [&sink, i]() { sink.fetch_add(TinyWork(i), std::memory_order_relaxed); };
+				while (!queue.TryPush(std::move(task))) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (int c = 0; c < consumers; c++) {
+		threads.emplace_back([&queue, &done, total]() {
+			sched::Task task;
+			while (done.load(std::memory_order_relaxed) < total) {
+				if (queue.TryPop(task)) {
+					task();
+					done.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+
+// one strand gets a burst of posts, another strand posts a probe right after.
+// return how long the probe waits on a single worker thread.
+double RunStrandBurst(uint32_t drainTasks, uint32_t drainMicros, int burst) {
+	sched::ThreadWorker worker(1);
+	sched::StrandScheduler busy(&worker);
+	sched::StrandScheduler probe(&worker);
+	busy.SetStrandDrainQuantum(drainTasks, drainMicros);
+
+	std::atomic<uint32_t> sink{ 0 };
+	std::atomic<int> order{ 0 };
+	std::atomic<bool> ordered{ true };
+	for (int i = 0; i < burst; i++) {
+		busy.PostStrand([&sink, &order, &ordered, i]() {
+			sink.fetch_add(TinyWork(i), std::memory_order_relaxed);
+			if (order.fetch_add(1) != i) {
+				ordered = false;
+			}
+		});
+	}
+
+	std::atomic<bool> probed{ false };
+	auto begin = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point end;
+	probe.PostStrand([&probed, &end]() {
+		end = std::chrono::steady_clock::now();
+		probed = true;
+	});
+
+	worker.Run();
+	while (!probed || order.load() < burst) {
+		std::this_thread::yield();
+	}
+	worker.Stop();
+	CHECK(ordered, "strand order broken");
+
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// a typical job: a few pointers and values, 48 bytes of capture
+struct JobPayload {
+	std::atomic<int>* Done;
+	void* Data[4];
+	int Index;
+};
+
+template<typename Scheduler, typename PostFunc>
+double RunAllocPerPost(Scheduler* sc, PostFunc post, int num) {
+	std::atomic<int> done{ 0 };
+	auto postAll = [&]() {
+		done.store(0);
+		for (int i = 0; i < num; i++) {
+			JobPayload payload{ &done, {}, i };
+			post(sc, [payload]() { payload.Done->fetch_add(1, std::memory_order_release); });
+		}
+		while (done.load(std::memory_order_acquire) < num) {
+			std::this_thread::yield();
+		}
+	};
+
+	// warm up node pools and wait queues first
+	postAll();
+	int64_t before = GAllocCount.load();
+	postAll();
+	return double(GAllocCount.load() - before) / num;
+}
+
+double RunAllocPerFunction(int num) {
+	std::atomic<int> done{ 0 };
+	int64_t before = GAllocCount.load();
+	for (int i = 0; i < num; i++) {
+		JobPayload payload{ &done, {}, i };
+		std::function<void()> f = [payload]() { payload.Done->fetch_add(1); };
+		f();
+	}
+	return double(GAllocCount.load() - before) / num;
+}
+
+double RunAllocPerTask(int num) {
+	std::atomic<int> done{ 0 };
+	int64_t before = GAllocCount.load();
+	for (int i = 0; i < num; i++) {
+		JobPayload payload{ &done, {}, i };
+		sched::Task f = [payload]() { payload.Done->fetch_add(1); };
+		f();
+	}
+	return double(GAllocCount.load() - before) / num;
+}
+
+
+// context switches of this process so far, -1 if the platform can't tell
+int64_t GetContextSwitches() {
+#if defined(__linux__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_nvcsw + usage.ru_nivcsw;
+#else
+	return -1;
+#endif
+}
+
+int64_t NowNanos() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct WakeResult {
+	double MedianMicros;
+	double P99Micros;
+	double SwitchesPerRound;
+};
+
+// the pool goes idle between rounds, then gets `fan` tasks at once like a frame
+// kicking its jobs. measure post to first task run, and context switches.
+WakeResult RunWakeLatency(sched::EServiceMode mode, int threads, int fan, int rounds) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+
+	std::vector<double> latency;
+	std::atomic<int> done{ 0 };
+	std::atomic<int64_t> firstRun{ 0 };
+	std::atomic<uint32_t> sink{ 0 };
+
+	int64_t switches = GetContextSwitches();
+	for (int r = 0; r < rounds; r++) {
+		// long enough for workers to spin out and park
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+		done = 0;
+		firstRun = 0;
+
+		int64_t begin = NowNanos();
+		for (int i = 0; i < fan; i++) {
+			sc.PostPar([&done, &firstRun, &sink, i]() {
+				int64_t zero = 0;
+				firstRun.compare_exchange_strong(zero, NowNanos());
+				sink.fetch_add(TinyWork(i), std::memory_order_relaxed);
+				done.fetch_add(1, std::memory_order_release);
+			});
+		}
+		while (done.load(std::memory_order_acquire) < fan) {
+			std::this_thread::yield();
+		}
+		latency.push_back((firstRun.load() - begin) / 1000.0);
+	}
+	switches = switches < 0 ? -1 : GetContextSwitches() - switches;
+	worker.Stop();
+
+	std::sort(latency.begin(), latency.end());
+	WakeResult result;
+	result.MedianMicros = latency[latency.size() / 2];
+	result.P99Micros = latency[latency.size() * 99 / 100];
+	result.SwitchesPerRound = switches < 0 ? -1.0 : double(switches) / rounds;
+	return result;
+}
+
+
+// cost of arming and cancelling `num` timers that never fire
+void RunTimerInsertCancel(int num, double& insertNanos, double& cancelNanos) {
+	sched::ThreadWorker worker(1);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+
+	std::vector<sched::TimerHandle> handles(num);
+	uint32_t seed = 1;
+	auto begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < num; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		// 10s ~ 10min, spread over all wheel levels
+		std::chrono::microseconds delay(10000000ll + (seed % 600000) * 1000ll);
+		handles[i] = sc.PostParAfter(delay, []() {});
+	}
+	auto mid = std::chrono::steady_clock::now();
+	for (int i = 0; i < num; i++) {
+		CHECK(handles[i].Cancel(), "cancel pending timer failed");
+	}
+	auto end = std::chrono::steady_clock::now();
+	worker.Stop();
+
+	insertNanos = std::chrono::duration<double, std::nano>(mid - begin).count() / num;
+	cancelNanos = std::chrono::duration<double, std::nano>(end - mid).count() / num;
+}
+
+// fire `num` timers over 0 ~ 50ms, return how late they run
+WakeResult RunTimerLateness(int num) {
+	sched::ThreadWorker worker(2);
+	worker.Run();
+	sched::StrandScheduler sc(&worker);
+
+	std::vector<double> lateness(num);
+	std::atomic<int> done{ 0 };
+	std::atomic<int> early{ 0 };
+	for (int i = 0; i < num; i++) {
+		int64_t delayMicros = (i * 50000ll) / num;
+		int64_t due = NowNanos() + delayMicros * 1000;
+		sc.PostStrandAfter(std::chrono::microseconds(delayMicros), [&lateness, &done, &early, due, i]() {
+			int64_t late = NowNanos() - due;
+			if (late < 0) {
+				early++;
+			}
+			lateness[i] = late / 1000.0;
+			done.fetch_add(1, std::memory_order_release);
+		});
+	}
+	while (done.load(std::memory_order_acquire) < num) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	worker.Stop();
+	CHECK(early == 0, "timer fired early");
+
+	std::sort(lateness.begin(), lateness.end());
+	WakeResult result;
+	result.MedianMicros = lateness[num / 2];
+	result.P99Micros = lateness[num * 99 / 100];
+	result.SwitchesPerRound = 0;
+	return result;
+}
+
+// a 5ms periodic timer for 200ms, return how many times it ran
+int RunTimerPeriodic() {
+	sched::ThreadWorker worker(1);
+	worker.Run();
+	sched::StrandScheduler sc(&worker);
+
+	std::atomic<int> runs{ 0 };
+	sched::TimerHandle timer = sc.PostStrandEvery(std::chrono::milliseconds(5), [&runs]() { runs++; });
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	timer.Cancel();
+	int result = runs;
+	worker.Stop();
+	return result;
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	if (argc > 1) {
+		maxThreads = std::max(1, atoi(argv[1]));
+	}
+	int depth = 16;
+
+	Log<LINFO>("fan out", (1 << (depth + 1)) - 1, "tasks, 1 ~", maxThreads, "threads");
+	std::vector<int> threadNums;
+	for (int n = 1; n < maxThreads; n *= 2) {
+		threadNums.push_back(n);
+	}
+	threadNums.push_back(maxThreads);
+
+	for (int n : threadNums) {
+		double shared = RunFanOut(sched::SERVICE_SHARED_QUEUE, n, depth);
+		double stealing = RunFanOut(sched::SERVICE_WORK_STEALING, n, depth);
+		Log<LINFO>("threads", n, "shared(ms)", shared, "stealing(ms)", stealing);
+	}
+
+	int contentionTasks = 200000;
+	Log<LINFO>("parallel queue contention", contentionTasks, "tasks");
+	for (int producers : { 1, 2, 4, 8, 16 }) {
+		for (int consumers : { 1, 2, 4, 8, 16 }) {
+			double locked = RunContention<LockedTaskList>(producers, consumers, contentionTasks);
+			double lockfree = RunContention<sched::MPMCQueue<sched::Task>>(producers, consumers, contentionTasks);
+			Log<LINFO>("producers", producers, "consumers", consumers, "locked(ms)", locked, "lockfree(ms)", lockfree);
+		}
+	}
+
+	int burst = 100000;
+	Log<LINFO>("strand burst", burst, "posts, probe latency on another strand");
+	Log<LINFO>("no quantum(ms)", RunStrandBurst(0, 0, burst));
+	Log<LINFO>("default quantum(ms)", RunStrandBurst(sched::K_STRAND_DRAIN_TASKS, sched::K_STRAND_DRAIN_MICROS, burst));
+
+	int allocPosts = 2000;
+	sched::ThreadWorker* allocWorker = new sched::ThreadWorker(2);
+	allocWorker->Run();
+	sched::ComplexScheduler* allocSched = new sched::ComplexScheduler(allocWorker);
+	Log<LINFO>("allocations per post, capture", sizeof(JobPayload), "bytes");
+	Log<LINFO>("std::function", RunAllocPerFunction(allocPosts));
+	Log<LINFO>("sched::Task", RunAllocPerTask(allocPosts));
+	Log<LINFO>("PostStrand", RunAllocPerPost(allocSched,
+		[](sched::ComplexScheduler* sc, sched::Task&& task) { sc->PostStrand(std::move(task)); }, allocPosts));
+	Log<LINFO>("PostPar", RunAllocPerPost(allocSched,
+		[](sched::ComplexScheduler* sc, sched::Task&& task) { sc->PostPar(std::move(task)); }, allocPosts));
+	allocWorker->Stop();
+	delete allocSched;
+	delete allocWorker;
+
+	int wakeRounds = 2000;
+	Log<LINFO>("wake idle pool,", maxThreads, "threads,", wakeRounds, "rounds");
+	for (int fan : { 1, 4, 16 }) {
+		for (sched::EServiceMode mode : { sched::SERVICE_SHARED_QUEUE, sched::SERVICE_WORK_STEALING }) {
+			WakeResult wake = RunWakeLatency(mode, maxThreads, fan, wakeRounds);
+			Log<LINFO>(mode == sched::SERVICE_SHARED_QUEUE ? "shared" : "stealing", "tasks", fan,
+				"median(us)", wake.MedianMicros, "p99(us)", wake.P99Micros, "switches/round", wake.SwitchesPerRound);
+		}
+	}
+
+	int timerNum = 100000;
+	double insertNanos = 0, cancelNanos = 0;
+	RunTimerInsertCancel(timerNum, insertNanos, cancelNanos);
+	Log<LINFO>("timers", timerNum, "pending, insert(ns)", insertNanos, "cancel(ns)", cancelNanos);
+	WakeResult late = RunTimerLateness(10000);
+	Log<LINFO>("timer lateness, tick", sched::K_TIMER_TICK_MICROS, "us, median(us)", late.MedianMicros, "p99(us)", late.P99Micros);
+	Log<LINFO>("5ms periodic timer runs in 200ms", RunTimerPeriodic());
+	return 0;
+}
@@ -0,0 +1,603 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+#include <Core/Scheduler/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+/*
+Scheduler benchmark suite, every case runs `repeat` times after a warm up run.
+results go to the log, and with --json to a file for BenchCompare.py.
+
+	BenchSchedSuite [--json out.json] [--threads N] [--repeat R] [--filter name]
+
+	empty_par: 1M empty tasks posted from outside to a parallel queue
+	empty_strand: 1M empty tasks posted from outside to one strand
+	pingpong: a message bounced between two strands
+	fanout: a task posts 1M tiny tasks, the last one joins on a strand
+	mixed: 16 strands and a parallel queue loaded at once
+	cache_strands: one strand per thread, each sweeps its own L2 sized buffer,
+		with workers unpinned and spread over physical cores (see EPlacement)
+	par_for, par_reduce, par_scan, par_sort: Parallel.h algorithms over 4M items
+		(2M for sort), the calling thread helps the workers. *_serial is the
+		plain loop or std::sort they are compared with
+fanout, mixed and par_* run on 1 ~ N threads, speedup is against 1 thread,
+par_*_vs_serial against the serial loop.
+*/
+
+namespace {
+
+uint32_t TinyWork(uint32_t seed) {
+	for (int i = 0; i < 64; i++) {
+		seed = seed * 1664525u + 1013904223u;
+	}
+	return seed;
+}
+
+double Seconds(std::chrono::steady_clock::time_point begin) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void WaitFor(const std::atomic<int>& done, int num) {
+	while (done.load(std::memory_order_acquire) < num) {
+		std::this_thread::yield();
+	}
+}
+
+const char* ModeName(sched::EServiceMode mode) {
+	return mode == sched::SERVICE_SHARED_QUEUE ? "shared" : "stealing";
+}
+
+
+// return seconds of one run
+typedef std::function<double(sched::EServiceMode mode, int threads)> BenchFunc;
+
+const int K_EMPTY_TASKS = 1000000;
+
+double RunEmptyPar(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+
+	std::atomic<int> done{ 0 };
+	auto begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < K_EMPTY_TASKS; i++) {
+		sc.PostPar([&done]() { done.fetch_add(1, std::memory_order_release); });
+	}
+	WaitFor(done, K_EMPTY_TASKS);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+double RunEmptyStrand(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::StrandScheduler sc(&worker);
+
+	// only the strand thread touches it
+	int count = 0;
+	std::atomic<int> done{ 0 };
+	auto begin = std::chrono::steady_clock::now();
+	for (int i = 0; i < K_EMPTY_TASKS; i++) {
+		sc.PostStrand([&count, &done]() {
+			if (++count == K_EMPTY_TASKS) {
+				done.store(count, std::memory_order_release);
+			}
+		});
+	}
+	WaitFor(done, K_EMPTY_TASKS);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+
+const int K_PINGPONG_HOPS = 100000;
+
+struct PingPong {
+	sched::StrandScheduler* Strands[2];
+	std::atomic<int> Done{ 0 };
+};
+
+void Hop(PingPong* ctx, int hop) {
+	if (hop == K_PINGPONG_HOPS) {
+		ctx->Done.store(hop, std::memory_order_release);
+		return;
+	}
+	ctx->Strands[hop & 1]->PostStrand([ctx, hop]() { Hop(ctx, hop + 1); });
+}
+
+double RunPingPong(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::StrandScheduler ping(&worker);
+	sched::StrandScheduler pong(&worker);
+
+	PingPong ctx;
+	ctx.Strands[0] = &ping;
+	ctx.Strands[1] = &pong;
+	auto begin = std::chrono::steady_clock::now();
+	Hop(&ctx, 0);
+	WaitFor(ctx.Done, K_PINGPONG_HOPS);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+
+const int K_FANOUT_TASKS = 1000000;
+
+double RunFanOut(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler par(&worker);
+	sched::StrandScheduler join(&worker);
+
+	std::atomic<int> left{ K_FANOUT_TASKS };
+	std::atomic<uint32_t> sink{ 0 };
+	std::atomic<int> done{ 0 };
+	auto begin = std::chrono::steady_clock::now();
+	par.PostPar([&]() {
+		for (int i = 0; i < K_FANOUT_TASKS; i++) {
+			par.PostPar([&, i]() {
+				sink.fetch_add(TinyWork(i), std::memory_order_relaxed);
+				if (left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					join.PostStrand([&done]() { done.store(1, std::memory_order_release); });
+				}
+			});
+		}
+	});
+	WaitFor(done, 1);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+
+const int K_MIXED_STRANDS = 16;
+const int K_MIXED_STRAND_TASKS = 20000;
+const int K_MIXED_PAR_TASKS = K_MIXED_STRANDS * K_MIXED_STRAND_TASKS;
+
+double RunMixed(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler par(&worker);
+	std::vector<std::unique_ptr<sched::StrandScheduler>> strands;
+	for (int s = 0; s < K_MIXED_STRANDS; s++) {
+		strands.emplace_back(new sched::StrandScheduler(&worker));
+	}
+
+	std::atomic<uint32_t> sink{ 0 };
+	std::atomic<int> done{ 0 };
+	auto begin = std::chrono::steady_clock::now();
+	// interleave, like systems posting their jobs during a frame
+	for (int i = 0; i < K_MIXED_STRAND_TASKS; i++) {
+		for (int s = 0; s < K_MIXED_STRANDS; s++) {
+			strands[s]->PostStrand([&sink, &done, i]() {
+				sink.fetch_add(TinyWork(i), std::memory_order_relaxed);
+				done.fetch_add(1, std::memory_order_release);
+			});
+			par.PostPar([&sink, &done, i]() {
+				sink.fetch_add(TinyWork(i), std::memory_order_relaxed);
+				done.fetch_add(1, std::memory_order_release);
+			});
+		}
+	}
+	WaitFor(done, K_MIXED_STRANDS * K_MIXED_STRAND_TASKS + K_MIXED_PAR_TASKS);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+
+const int K_CACHE_BUFFER_WORDS = 48 * 1024;
+const int K_CACHE_STRAND_TASKS = 400;
+
+struct CacheStrand {
+	sched::StrandScheduler* Sched;
+	std::vector<uint32_t> Buffer = std::vector<uint32_t>(K_CACHE_BUFFER_WORDS, 1);
+	int Left{ K_CACHE_STRAND_TASKS };
+	std::atomic<int>* Done;
+};
+
+// sweep the buffer and post the next sweep to the same strand
+void SweepCache(CacheStrand* strand) {
+	uint32_t carry = 0;
+	for (uint32_t& v : strand->Buffer) {
+		v = v * 1664525u + 1013904223u + carry;
+		carry = v >> 28;
+	}
+	if (--strand->Left > 0) {
+		strand->Sched->PostStrand([strand]() { SweepCache(strand); });
+	} else {
+		strand->Done->fetch_add(1, std::memory_order_release);
+	}
+}
+
+double RunCacheStrands(sched::EServiceMode mode, int threads, sched::EPlacement placement) {
+	sched::ThreadWorker worker(threads, mode, placement);
+	worker.Run();
+	std::vector<std::unique_ptr<sched::StrandScheduler>> scheds;
+	std::vector<std::unique_ptr<CacheStrand>> strands;
+	std::atomic<int> done{ 0 };
+	for (int i = 0; i < threads; i++) {
+		scheds.emplace_back(new sched::StrandScheduler(&worker));
+		strands.emplace_back(new CacheStrand());
+		strands.back()->Sched = scheds.back().get();
+		strands.back()->Done = &done;
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	for (auto& strand : strands) {
+		CacheStrand* s = strand.get();
+		s->Sched->PostStrand([s]() { SweepCache(s); });
+	}
+	WaitFor(done, threads);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+
+const size_t K_PAR_ITEMS = 4 * 1024 * 1024;
+const size_t K_SORT_ITEMS = 2 * 1024 * 1024;
+
+const std::vector<float>& ParInput() {
+	static std::vector<float> input = []() {
+		std::vector<float> values(K_PAR_ITEMS);
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+		for (float& v : values) {
+			v = dist(rng);
+		}
+		return values;
+	}();
+	return input;
+}
+
+const std::vector<uint32_t>& SortInput() {
+	static std::vector<uint32_t> input = []() {
+		std::vector<uint32_t> values(K_SORT_ITEMS);
+		std::mt19937 rng(42);
+		for (uint32_t& v : values) {
+			v = rng();
+		}
+		return values;
+	}();
+	return input;
+}
+
+// a few flops per item, like a vertex transform
+inline float ParWork(float v) {
+	return std::sqrt(v * 3.0f + 1.0f) * v - 0.5f;
+}
+
+// time func on a new pool, starting the threads is not counted
+template<typename Func>
+double TimeParallel(sched::EServiceMode mode, int threads, Func func) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+	auto begin = std::chrono::steady_clock::now();
+	func(sc);
+	double seconds = Seconds(begin);
+	worker.Stop();
+	return seconds;
+}
+
+double RunForSerial(sched::EServiceMode, int) {
+	const std::vector<float>& in = ParInput();
+	std::vector<float> out(in.size());
+	auto begin = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < in.size(); i++) {
+		out[i] = ParWork(in[i]);
+	}
+	return Seconds(begin);
+}
+
+double RunParFor(sched::EServiceMode mode, int threads) {
+	const std::vector<float>& in = ParInput();
+	std::vector<float> out(in.size());
+	return TimeParallel(mode, threads, [&](sched::ParallelScheduler& sc) {
+		sched::ParallelFor(sc, 0, in.size(), [&](size_t i) { out[i] = ParWork(in[i]); });
+	});
+}
+
+double RunReduceSerial(sched::EServiceMode, int) {
+	const std::vector<float>& in = ParInput();
+	auto begin = std::chrono::steady_clock::now();
+	float sum = 0.0f;
+	for (float v : in) {
+		sum += ParWork(v);
+	}
+	volatile float sink = sum;
+	(void)sink;
+	return Seconds(begin);
+}
+
+double RunParReduce(sched::EServiceMode mode, int threads) {
+	const std::vector<float>& in = ParInput();
+	return TimeParallel(mode, threads, [&](sched::ParallelScheduler& sc) {
+		volatile float sink = sched::ParallelReduce(sc, 0, in.size(), 0.0f,
+			[&](size_t b, size_t e, float sum) {
+				for (size_t i = b; i < e; i++) {
+					sum += ParWork(in[i]);
+				}
+				return sum;
+			},
+			[](float a, float b) { return a + b; });
+		(void)sink;
+	});
+}
+
+double RunScanSerial(sched::EServiceMode, int) {
+	const std::vector<float>& in = ParInput();
+	std::vector<float> out(in.size());
+	auto begin = std::chrono::steady_clock::now();
+	float sum = 0.0f;
+	for (size_t i = 0; i < in.size(); i++) {
+		sum += in[i];
+		out[i] = sum;
+	}
+	return Seconds(begin);
+}
+
+double RunParScan(sched::EServiceMode mode, int threads) {
+	const std::vector<float>& in = ParInput();
+	std::vector<float> out(in.size());
+	return TimeParallel(mode, threads, [&](sched::ParallelScheduler& sc) {
+		sched::ParallelScan(sc, in.begin(), in.end(), out.begin(), 0.0f, [](float a, float b) { return a + b; });
+	});
+}
+
+double RunSortSerial(sched::EServiceMode, int) {
+	std::vector<uint32_t> values = SortInput();
+	auto begin = std::chrono::steady_clock::now();
+	std::sort(values.begin(), values.end());
+	return Seconds(begin);
+}
+
+double RunParSort(sched::EServiceMode mode, int threads) {
+	std::vector<uint32_t> values = SortInput();
+	return TimeParallel(mode, threads, [&](sched::ParallelScheduler& sc) {
+		sched::ParallelSort(sc, values.begin(), values.end(), std::less<uint32_t>());
+	});
+}
+
+
+struct Result {
+	std::string Name;
+	std::string Mode;
+	int Threads;
+	std::string Metric;
+	std::string Unit;
+	// "lower" or "higher"
+	std::string Better;
+	double Median;
+	double Min;
+	double Max;
+};
+
+struct Options {
+	std::string JsonPath;
+	std::string Filter;
+	int MaxThreads{ 1 };
+	int Repeat{ 5 };
+};
+
+class Suite {
+public:
+	explicit Suite(const Options& options) : mOptions(options) {}
+
+	/* run a case, scale turns seconds of one run into the metric.
+		per item metrics (ns/task) are lower is better, rates higher.
+	*/
+	void Run(const char* name, sched::EServiceMode mode, int threads, BenchFunc func,
+		const char* metric, const char* unit, const char* better, std::function<double(double)> scale) {
+		if (!mOptions.Filter.empty() && std::string(name).find(mOptions.Filter) == std::string::npos) {
+			return;
+		}
+
+		func(mode, threads);
+		std::vector<double> values;
+		for (int i = 0; i < mOptions.Repeat; i++) {
+			values.push_back(scale(func(mode, threads)));
+		}
+		std::sort(values.begin(), values.end());
+
+		Result result{ name, ModeName(mode), threads, metric, unit, better,
+			values[values.size() / 2], values.front(), values.back() };
+		Log<LINFO>(name, result.Mode, "threads", threads, metric, result.Median,
+			"min", result.Min, "max", result.Max, unit);
+		mResults.push_back(result);
+	}
+
+	// median of name/mode at 1 thread over median at each thread count
+	void AddSpeedup(const char* name, sched::EServiceMode mode) {
+		AddSpeedup(name, name, "_speedup", mode);
+	}
+
+	// median of base/mode at 1 thread over median of name at each thread count
+	void AddSpeedup(const char* name, const char* baseName, const char* suffix, sched::EServiceMode mode) {
+		const Result* base = Find(baseName, ModeName(mode), 1);
+		if (!base) {
+			return;
+		}
+		std::vector<Result> speedups;
+		for (const Result& r : mResults) {
+			if (r.Name == name && r.Mode == base->Mode && r.Metric == base->Metric) {
+				double speedup = base->Median / r.Median;
+				speedups.push_back({ std::string(name) + suffix, r.Mode, r.Threads, "speedup", "x", "higher",
+					speedup, speedup, speedup });
+			}
+		}
+		for (const Result& s : speedups) {
+			Log<LINFO>(s.Name, s.Mode, "threads", s.Threads, "x", s.Median);
+		}
+		mResults.insert(mResults.end(), speedups.begin(), speedups.end());
+	}
+
+	void WriteJson(std::ostream& os) const {
+		os << "{\n";
+		os << "  \"suite\": \"sched\",\n";
+		os << "  \"build\": {\"compiler\": \"" << CompilerName() << "\", \"debug\": " << IsDebug()
+			<< ", \"task_inline_size\": " << Z_SCHED_TASK_INLINE_SIZE << ", \"sched_stats\": " << Z_SCHED_STATS << "},\n";
+		const sched::CpuTopology& topology = sched::CpuTopology::Get();
+		os << "  \"machine\": {\"hardware_threads\": " << std::thread::hardware_concurrency()
+			<< ", \"cpus\": " << topology.GetCpus().size() << ", \"cores\": " << topology.GetCoreNum()
+			<< ", \"numa_nodes\": " << topology.GetNodeNum() << "},\n";
+		os << "  \"repeat\": " << mOptions.Repeat << ",\n";
+		os << "  \"results\": [";
+		for (size_t i = 0; i < mResults.size(); i++) {
+			const Result& r = mResults[i];
+			os << (i == 0 ? "\n" : ",\n");
+			os << "    {\"name\": \"" << r.Name << "\", \"mode\": \"" << r.Mode << "\", \"threads\": " << r.Threads
+				<< ", \"metric\": \"" << r.Metric << "\", \"unit\": \"" << r.Unit << "\", \"better\": \"" << r.Better
+				<< "\", \"median\": " << r.Median << ", \"min\": " << r.Min << ", \"max\": " << r.Max << "}";
+		}
+		os << "\n  ]\n}\n";
+	}
+
+private:
+	const Result* Find(const std::string& name, const std::string& mode, int threads) const {
+		for (const Result& r : mResults) {
+			if (r.Name == name && r.Mode == mode && r.Threads == threads) {
+				return &r;
+			}
+		}
+		return nullptr;
+	}
+
+	static std::string CompilerName() {
+#if defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#else
+		return "unknown";
+#endif
+	}
+
+	static int IsDebug() {
+#if defined(NDEBUG)
+		return 0;
+#else
+		return 1;
+#endif
+	}
+
+	Options mOptions;
+	std::vector<Result> mResults;
+};
+
+}
+
+
+int main(int argc, char* argv[]) {
+	Options options;
+	options.MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string arg = argv[i];
+		if (arg == "--json") {
+			options.JsonPath = argv[i + 1];
+		} else if (arg == "--threads") {
+			options.MaxThreads = std::max(1, atoi(argv[i + 1]));
+		} else if (arg == "--repeat") {
+			options.Repeat = std::max(1, atoi(argv[i + 1]));
+		} else if (arg == "--filter") {
+			options.Filter = argv[i + 1];
+		} else {
+			Log<LERROR>("unknown option", arg);
+			return 1;
+		}
+	}
+
+	std::vector<int> threadNums;
+	for (int n = 1; n < options.MaxThreads; n *= 2) {
+		threadNums.push_back(n);
+	}
+	threadNums.push_back(options.MaxThreads);
+	int pairThreads = std::min(2, options.MaxThreads);
+
+	auto perTask = [](int num) {
+		return [num](double seconds) { return seconds * 1e9 / num; };
+	};
+	auto rate = [](int num) {
+		return [num](double seconds) { return num / seconds; };
+	};
+
+	Suite suite(options);
+	for (sched::EServiceMode mode : { sched::SERVICE_SHARED_QUEUE, sched::SERVICE_WORK_STEALING }) {
+		suite.Run("empty_par", mode, options.MaxThreads, RunEmptyPar, "throughput", "tasks/s", "higher", rate(K_EMPTY_TASKS));
+		suite.Run("empty_strand", mode, options.MaxThreads, RunEmptyStrand, "throughput", "tasks/s", "higher", rate(K_EMPTY_TASKS));
+		suite.Run("pingpong", mode, pairThreads, RunPingPong, "latency", "ns/hop", "lower", perTask(K_PINGPONG_HOPS));
+
+		for (int n : threadNums) {
+			suite.Run("fanout", mode, n, RunFanOut, "time", "ns/task", "lower", perTask(K_FANOUT_TASKS));
+		}
+		suite.AddSpeedup("fanout", mode);
+
+		for (int n : threadNums) {
+			suite.Run("mixed", mode, n, RunMixed, "time", "ns/task", "lower", perTask(K_MIXED_STRANDS * K_MIXED_STRAND_TASKS + K_MIXED_PAR_TASKS));
+		}
+		suite.AddSpeedup("mixed", mode);
+
+		int cacheTasks = options.MaxThreads * K_CACHE_STRAND_TASKS;
+		suite.Run("cache_strands_unpinned", mode, options.MaxThreads, [](sched::EServiceMode mode, int threads) {
+			return RunCacheStrands(mode, threads, sched::PLACEMENT_NONE);
+		}, "time", "ns/task", "lower", perTask(cacheTasks));
+		suite.Run("cache_strands_spread", mode, options.MaxThreads, [](sched::EServiceMode mode, int threads) {
+			return RunCacheStrands(mode, threads, sched::PLACEMENT_SPREAD);
+		}, "time", "ns/task", "lower", perTask(cacheTasks));
+
+		struct ParCase {
+			const char* Name;
+			const char* Serial;
+			BenchFunc Par;
+			BenchFunc SerialFunc;
+			size_t Items;
+		};
+		const ParCase parCases[] = {
+			{ "par_for", "par_for_serial", RunParFor, RunForSerial, K_PAR_ITEMS },
+			{ "par_reduce", "par_reduce_serial", RunParReduce, RunReduceSerial, K_PAR_ITEMS },
+			{ "par_scan", "par_scan_serial", RunParScan, RunScanSerial, K_PAR_ITEMS },
+			{ "par_sort", "par_sort_serial", RunParSort, RunSortSerial, K_SORT_ITEMS },
+		};
+		for (const ParCase& c : parCases) {
+			suite.Run(c.Serial, mode, 1, c.SerialFunc, "time", "ns/item", "lower", perTask((int)c.Items));
+			for (int n : threadNums) {
+				suite.Run(c.Name, mode, n, c.Par, "time", "ns/item", "lower", perTask((int)c.Items));
+			}
+			suite.AddSpeedup(c.Name, mode);
+			suite.AddSpeedup(c.Name, c.Serial, "_vs_serial", mode);
+		}
+	}
+
+	if (!options.JsonPath.empty()) {
+		std::ofstream file(options.JsonPath);
+		if (!file) {
+			Log<LERROR>("can't write", options.JsonPath);
+			return 1;
+		}
+		suite.WriteJson(file);
+		Log<LINFO>("results written to", options.JsonPath);
+	}
+	return 0;
+}
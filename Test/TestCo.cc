@@ -0,0 +1,144 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+#if Z_SCHED_COROUTINE
+
+// count every heap allocation of the process
+static std::atomic<int64_t> GAllocCount{ 0 };
+
+void* operator new(size_t size) {
+	GAllocCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+namespace {
+
+struct LoaderContext {
+	sched::ParallelScheduler* Io;
+	sched::StrandScheduler* Render;
+	std::atomic<bool> InRender{ false };
+	std::atomic<int> Uploaded{ 0 };
+};
+
+typedef std::array<uint32_t, 64> Blob;
+
+Blob ReadBlob(int id) {
+	Blob blob;
+	uint32_t seed = id;
+	for (uint32_t& v : blob) {
+		seed = seed * 1664525u + 1013904223u;
+		v = seed;
+	}
+	return blob;
+}
+
+uint32_t DecodeBlob(const Blob& blob) {
+	uint32_t hash = 2166136261u;
+	for (uint32_t v : blob) {
+		hash = (hash ^ v) * 16777619u;
+	}
+	return hash;
+}
+
+// read, decode on workers, upload on the render strand
+sched::Co<uint32_t> LoadAsset(LoaderContext* ctx, int id) {
+	co_await ctx->Io->Schedule();
+	Blob blob = ReadBlob(id);
+
+	// already on the io queue, goes on in place
+	co_await ctx->Io->Schedule();
+	uint32_t decoded = DecodeBlob(blob);
+
+	co_await ctx->Render->Schedule();
+	CHECK(!ctx->InRender.exchange(true), "render strand entered twice");
+	ctx->Uploaded++;
+	ctx->InRender = false;
+	co_return decoded;
+}
+
+sched::Co<void> LoadAll(LoaderContext* ctx, int num, std::atomic<bool>* done) {
+	std::vector<sched::Co<uint32_t>> loads;
+	for (int i = 0; i < num; i++) {
+		loads.push_back(LoadAsset(ctx, i));
+	}
+	std::vector<uint32_t> results = co_await sched::WhenAll(std::move(loads));
+
+	CHECK((int)results.size() == num, "WhenAll lost results");
+	for (int i = 0; i < num; i++) {
+		CHECK(results[i] == DecodeBlob(ReadBlob(i)), "WhenAll result out of order");
+	}
+
+	// plain co_await on another coroutine
+	uint32_t last = co_await LoadAsset(ctx, num);
+	CHECK(last == DecodeBlob(ReadBlob(num)), "awaited result wrong");
+
+	*done = true;
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	sched::ThreadWorker worker(4);
+	worker.Run();
+	sched::ParallelScheduler io(&worker);
+	sched::StrandScheduler render(&worker);
+
+	LoaderContext ctx;
+	ctx.Io = &io;
+	ctx.Render = &render;
+
+	int num = 1000;
+	auto runAll = [&]() {
+		std::atomic<bool> done{ false };
+		ctx.Uploaded = 0;
+		LoadAll(&ctx, num, &done).Detach();
+		while (!done) {
+			std::this_thread::yield();
+		}
+		CHECK(ctx.Uploaded == num + 1, "upload count wrong");
+	};
+
+	// warm up frame pools and queues first
+	runAll();
+	int64_t before = GAllocCount.load();
+	auto begin = std::chrono::steady_clock::now();
+	runAll();
+	auto end = std::chrono::steady_clock::now();
+
+	Log<LINFO>("loaded", num + 1, "assets in", std::chrono::duration<double, std::milli>(end - begin).count(), "ms");
+	Log<LINFO>("heap allocations per asset", double(GAllocCount.load() - before) / (num + 1));
+
+	worker.Stop();
+	return 0;
+}
+
+#else
+
+int main(int argc, char* argv[]) {
+	Log<LINFO>("coroutines need c++20");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+namespace {
+
+// loaders on workers, results reduced on a strand, read from outside
+void CheckChain(sched::EServiceMode mode) {
+	sched::ThreadWorker worker(4, mode);
+	worker.Run();
+	sched::ParallelScheduler loaders(&worker);
+	sched::StrandScheduler reducer(&worker);
+
+	const int num = 1000;
+	std::atomic<int> reducing{ 0 };
+	long long total = 0;
+	std::vector<sched::Future<long long>> results;
+	for (int i = 0; i < num; i++) {
+		sched::Future<std::vector<int>> load = loaders.PostPar([i]() {
+			return std::vector<int>(i % 7 + 1, i);
+		});
+		results.push_back(load.Then(reducer, [&](std::vector<int> data) {
+			CHECK(reducing.fetch_add(1) == 0, "strand continuations overlapped");
+			long long sum = 0;
+			for (int v : data) {
+				sum += v;
+			}
+			total += sum;
+			reducing.fetch_sub(1);
+			return sum;
+		}));
+	}
+
+	long long expected = 0;
+	for (int i = 0; i < num; i++) {
+		long long sum = results[i].Get();
+		CHECK(sum == (long long)i * (i % 7 + 1), "wrong result");
+		expected += sum;
+	}
+	// the last continuation may still be returning on the strand
+	sched::Future<long long> last = loaders.PostPar([]() { return 0LL; }).Then(reducer, [&](long long) { return total; });
+	CHECK(last.Get() == expected, "strand saw a different total");
+	worker.Stop();
+}
+
+// one worker waiting on a future it has to run itself
+void CheckHelpingWait(sched::EServiceMode mode) {
+	sched::ThreadWorker worker(1, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+
+	sched::Future<int> outer = sc.PostPar([&sc]() {
+		sched::Future<int> inner = sc.PostPar([]() { return 20; });
+		return inner.Get() + 1;
+	});
+	CHECK(outer.Get() == 21, "nested wait went wrong");
+	worker.Stop();
+}
+
+// errors skip continuations and come out of Get, void results chain
+void CheckErrors() {
+	sched::ThreadWorker worker(2, sched::SERVICE_WORK_STEALING);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+	sched::StrandScheduler strand(&worker);
+
+	std::atomic<bool> skipped{ true };
+	sched::Future<int> failed = sc.PostPar([]() -> int {
+		throw std::runtime_error("load failed");
+	}).Then(strand, [&](int v) {
+		skipped = false;
+		return v;
+	});
+	bool caught = false;
+	try {
+		failed.Get();
+	} catch (const std::runtime_error&) {
+		caught = true;
+	}
+	CHECK(caught && skipped, "error didn't skip the continuation");
+
+	std::atomic<int> steps{ 0 };
+	sched::Future<void> done = sc.PostPar([]() { return 1; })
+		.Then(strand, [&](int v) { steps += v; })
+		.Then(sc, [&]() { steps += 2; });
+	done.Wait();
+	CHECK(done.IsReady() && steps == 3, "void chain didn't run");
+	worker.Stop();
+}
+
+// futures of tasks dropped with a cancelled service are broken, not left waiting
+void CheckBroken() {
+	sched::Future<int> dropped;
+	{
+		sched::ThreadWorker worker(1, sched::SERVICE_SHARED_QUEUE);
+		sched::ParallelScheduler sc(&worker);
+		dropped = sc.PostPar([]() { return 1; });
+		worker.Stop(false);
+	}
+
+	bool caught = false;
+	try {
+		dropped.Get();
+	} catch (const std::runtime_error&) {
+		caught = true;
+	}
+	CHECK(caught, "dropped task should break its future");
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	CheckChain(sched::SERVICE_SHARED_QUEUE);
+	CheckChain(sched::SERVICE_WORK_STEALING);
+	CheckHelpingWait(sched::SERVICE_SHARED_QUEUE);
+	CheckHelpingWait(sched::SERVICE_WORK_STEALING);
+	CheckErrors();
+	CheckBroken();
+	Log<LINFO>("future tests passed");
+	return 0;
+}
@@ -0,0 +1,680 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Client/Entity/Transform.h>
+
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace z;
+using namespace z::math;
+
+namespace {
+
+static_assert(alignof(Vector4F) == 16 && sizeof(Vector4F) == 16, "Vector4F layout");
+static_assert(alignof(Matrix4F) == 16 && sizeof(Matrix4F) == 64, "Matrix4F layout");
+
+const char* BackendName() {
+	switch (Z_MATH_SIMD) {
+	case Z_MATH_SIMD_AVX: return "avx";
+	case Z_MATH_SIMD_SSE: return "sse";
+	default: return "scalar";
+	}
+}
+
+Matrix4F RandomMatrix(std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	Matrix4F m;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			m[i][j] = dist(rng);
+		}
+	}
+	return m;
+}
+
+bool Same(const void* a, const void* b, size_t size) {
+	return memcmp(a, b, size) == 0;
+}
+
+// relative, absolute below 1
+bool Near(const float* a, const float* b, size_t num, float tolerance) {
+	for (size_t i = 0; i < num; i++) {
+		float scale = std::max(1.0f, std::max(std::abs(a[i]), std::abs(b[i])));
+		if (!(std::abs(a[i] - b[i]) <= tolerance * scale)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Near(const Matrix4F& a, const Matrix4F& b, float tolerance) {
+	return Near(reinterpret_cast<const float*>(&a), reinterpret_cast<const float*>(&b), 16, tolerance);
+}
+
+bool Near(const Affine3x4& a, const Affine3x4& b, float tolerance) {
+	return Near(a.ToMatrix4(), b.ToMatrix4(), tolerance);
+}
+
+// simd against scalar paths, equal up to rounding (see Simd.h)
+const float K_PATH_TOLERANCE = 1e-5f;
+
+void CheckExact() {
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	for (int i = 0; i < 10000; i++) {
+		Matrix4F a = RandomMatrix(rng);
+		Matrix4F b = RandomMatrix(rng);
+		Vector4F v(dist(rng), dist(rng), dist(rng), dist(rng));
+
+		Matrix4F mul = a * b;
+		Matrix4F mulScalar = a.MulScalar(b);
+		CHECK(Near(mul, mulScalar, K_PATH_TOLERANCE), "multiply differs from scalar");
+
+		Vector4F t = a * v;
+		Vector4F tScalar = a.TransformScalar(v);
+		CHECK(Near(&t.x, &tScalar.x, 4, K_PATH_TOLERANCE), "transform differs from scalar");
+
+		Matrix4F tr = a.GetTranspose();
+		Matrix4F trScalar = a.GetTransposeScalar();
+		CHECK(Same(&tr, &trScalar, sizeof(Matrix4F)), "transpose differs from scalar");
+		CHECK(tr[1][2] == a[2][1] && tr[3][0] == a[0][3], "transpose wrong");
+	}
+
+	// a * b applies a first
+	Matrix4F move = MatrixTransform(Vector3F(1, 2, 3));
+	Matrix4F turn = MatrixRotationZ(K_PIDIV2);
+	Vector4F p = (move * turn) * Vector4F(1, 0, 0, 1);
+	CHECK(std::abs(p.x + 2) < 1e-5f && std::abs(p.y - 2) < 1e-5f && std::abs(p.z - 3) < 1e-5f, "multiply order wrong");
+}
+
+// the simd inverse sums in another order, close to scalar and a real inverse
+void CheckInverse() {
+	std::mt19937 rng(19);
+	int tested = 0;
+	for (int i = 0; i < 10000; i++) {
+		Matrix4F a = RandomMatrix(rng);
+		Matrix4F inv = a.GetInverseScalar();
+		// badly conditioned ones say nothing about the backend
+		Matrix4F identity = a * inv;
+		if (!Near(identity, Matrix4F::Identity, 1e-3f)) {
+			continue;
+		}
+		tested++;
+		Matrix4F simdInv = a.GetInverse();
+		CHECK(Near(simdInv, inv, 1e-3f), "inverse differs from scalar");
+		CHECK(Near(a * simdInv, Matrix4F::Identity, 1e-3f), "inverse wrong");
+	}
+	CHECK(tested > 9000, "too few well conditioned matrices");
+
+	Matrix4F world = MatrixTransform(Vector3F(5, -3, 2)) * MatrixRotationAxis(Vector3F(1, 2, 3), 0.7f);
+	CHECK(Near(world * world.GetInverse(), Matrix4F::Identity, 1e-5f), "inverse of a transform wrong");
+}
+
+// soa arrays of num items, filled with random values
+struct SoAStorage {
+	explicit SoAStorage(size_t num) : Data(num * 6) {
+		for (size_t i = 0; i < 6; i++) {
+			Ptr[i] = Data.data() + i * num;
+		}
+	}
+
+	SoAVector3F Points() { return SoAVector3F{ Ptr[0], Ptr[1], Ptr[2] }; }
+	SoABoxF Boxes() { return SoABoxF{ Points(), SoAVector3F{ Ptr[3], Ptr[4], Ptr[5] } }; }
+
+	std::vector<float> Data;
+	float* Ptr[6];
+};
+
+bool SameBox(const Box& a, const Box& b) {
+	return Same(&a.MinP, &b.MinP, sizeof(Vector3F)) && Same(&a.MaxP, &b.MaxP, sizeof(Vector3F));
+}
+
+bool NearVector(const Vector3F& a, const Vector3F& b) {
+	return std::abs(a.x - b.x) < 1e-4f && std::abs(a.y - b.y) < 1e-4f && std::abs(a.z - b.z) < 1e-4f;
+}
+
+// batch kernels against their scalar versions, at sizes around the lane width
+void CheckBatch() {
+	std::mt19937 rng(29);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	const size_t sizes[] = { 0, 1, 3, 4, 7, 8, 9, 17, 1000, 1003 };
+	for (size_t num : sizes) {
+		Matrix4F m = MatrixTransform(Vector3F(dist(rng), dist(rng), dist(rng))) *
+			MatrixRotationAxis(Vector3F(dist(rng), dist(rng), dist(rng)), dist(rng));
+		m[0][0] *= 2.0f;
+		SoAStorage in(num), out(num), ref(num);
+		for (float& v : in.Data) {
+			v = dist(rng);
+		}
+		// boxes with min below max
+		SoABoxF boxes = in.Boxes();
+		for (size_t i = 0; i < num; i++) {
+			boxes.Set(i, [&]() {
+				Box b;
+				b.Union(boxes.Min.Get(i));
+				b.Union(boxes.Max.Get(i));
+				return b;
+			}());
+		}
+
+		TransformPoints(m, in.Points(), out.Points(), num);
+		TransformPointsScalar(m, in.Points(), ref.Points(), num);
+		CHECK(Near(out.Ptr[0], ref.Ptr[0], num * 3, K_PATH_TOLERANCE), "TransformPoints differs from scalar");
+		for (size_t i = 0; i < num; i++) {
+			Vector3F p = m * Vector4F(in.Points().Get(i), 1.0f);
+			CHECK(NearVector(out.Points().Get(i), p), "TransformPoints wrong");
+		}
+
+		TransformNormals(m, in.Points(), out.Points(), num);
+		TransformNormalsScalar(m, in.Points(), ref.Points(), num);
+		CHECK(Near(out.Ptr[0], ref.Ptr[0], num * 3, K_PATH_TOLERANCE), "TransformNormals differs from scalar");
+		for (size_t i = 0; i < num; i++) {
+			Vector3F n = m * Vector4F(in.Points().Get(i), 0.0f);
+			CHECK(NearVector(out.Points().Get(i), n), "TransformNormals wrong");
+		}
+
+		Box bounds, boundsScalar, boundsUnion;
+		ComputeBounds(in.Points(), num, bounds);
+		ComputeBoundsScalar(in.Points(), num, boundsScalar);
+		for (size_t i = 0; i < num; i++) {
+			boundsUnion.Union(in.Points().Get(i));
+		}
+		CHECK(SameBox(bounds, boundsScalar) && SameBox(bounds, boundsUnion), "ComputeBounds wrong");
+
+		TransformBoxes(m, in.Boxes(), out.Boxes(), num);
+		TransformBoxesScalar(m, in.Boxes(), ref.Boxes(), num);
+		CHECK(Near(out.Ptr[0], ref.Ptr[0], num * 6, K_PATH_TOLERANCE), "TransformBoxes differs from scalar");
+		// the new box holds all eight corners
+		for (size_t i = 0; i < num; i++) {
+			Box b = in.Boxes().Get(i);
+			Box nb = out.Boxes().Get(i);
+			for (int c = 0; c < 8; c++) {
+				Vector3F corner(c & 1 ? b.MaxP.x : b.MinP.x, c & 2 ? b.MaxP.y : b.MinP.y, c & 4 ? b.MaxP.z : b.MinP.z);
+				Vector3F p = m * Vector4F(corner, 1.0f);
+				CHECK(p.x >= nb.MinP.x - 1e-3f && p.x <= nb.MaxP.x + 1e-3f &&
+					p.y >= nb.MinP.y - 1e-3f && p.y <= nb.MaxP.y + 1e-3f &&
+					p.z >= nb.MinP.z - 1e-3f && p.z <= nb.MaxP.z + 1e-3f, "TransformBoxes misses a corner");
+			}
+		}
+
+		// in place
+		TransformPointsScalar(m, in.Points(), ref.Points(), num);
+		TransformPoints(m, in.Points(), in.Points(), num);
+		CHECK(Near(in.Ptr[0], ref.Ptr[0], num * 3, K_PATH_TOLERANCE), "TransformPoints in place wrong");
+	}
+}
+
+Quaternion RandomQuaternion(std::mt19937& rng) {
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	return Quaternion::FromAxisAngle(Vector3F(dist(rng), dist(rng), dist(rng)), dist(rng) * K_PI);
+}
+
+bool NearQuaternion(const Quaternion& a, const Quaternion& b) {
+	// q and -q are the same rotation
+	return std::abs(std::abs(Dot(a, b)) - 1.0f) < 1e-5f;
+}
+
+void CheckQuaternion() {
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (int i = 0; i < 10000; i++) {
+		Quaternion a = RandomQuaternion(rng);
+		Quaternion b = RandomQuaternion(rng);
+		Quaternion ab = a * b;
+		Quaternion abScalar = a.MulScalar(b);
+		CHECK(Near(&ab.x, &abScalar.x, 4, K_PATH_TOLERANCE), "compose differs from scalar");
+		// a first, like matrices
+		CHECK(Near(ab.ToMatrix(), a.ToMatrix() * b.ToMatrix(), 1e-5f), "compose order wrong");
+
+		Vector3F v(dist(rng), dist(rng), dist(rng));
+		CHECK(NearVector(a.Rotate(v), a.ToMatrix() * Vector4F(v, 0.0f)), "Rotate wrong");
+		CHECK(NearVector((a * a.GetConjugate()).Rotate(v), v), "conjugate wrong");
+		CHECK(NearQuaternion(Quaternion::FromMatrix(a.ToMatrix()), a), "FromMatrix wrong");
+
+		Vector3F axis(dist(rng), dist(rng), dist(rng));
+		float angle = dist(rng) * K_PI;
+		CHECK(Near(Quaternion::FromAxisAngle(axis, angle).ToMatrix(), MatrixRotationAxis(axis, angle), 1e-5f),
+			"FromAxisAngle differs from MatrixRotationAxis");
+
+		// the matrices Transform::SetRotator used to multiply
+		Vector3F rotator(dist(rng) * K_PIDIV2 * 0.99f, dist(rng) * K_PI, dist(rng) * K_PI);
+		Matrix4F euler = MatrixRotationY(rotator.y) * MatrixRotationX(rotator.x) * MatrixRotationZ(rotator.z);
+		Quaternion q = Quaternion::FromRotator(rotator);
+		CHECK(Near(q.ToMatrix(), euler, 1e-5f), "FromRotator wrong");
+		CHECK(Near(Quaternion::FromRotator(q.ToRotator()).ToMatrix(), euler, 1e-4f), "ToRotator wrong");
+
+		// slerp keeps unit length and turns at constant speed
+		float t = (dist(rng) + 1.0f) * 0.5f;
+		Quaternion s = Slerp(a, b, t);
+		CHECK(std::abs(Dot(s, s) - 1.0f) < 1e-5f, "Slerp not unit");
+		float total = std::acos(std::min(1.0f, std::abs(Dot(a, b))));
+		float part = std::acos(std::min(1.0f, std::abs(Dot(a, s))));
+		CHECK(std::abs(part - total * t) < 1e-3f, "Slerp speed wrong");
+		CHECK(NearQuaternion(Slerp(a, b, 0.0f), a) && NearQuaternion(Slerp(a, b, 1.0f), b), "Slerp ends wrong");
+		Quaternion n = Nlerp(a, b, t);
+		CHECK(std::abs(Dot(n, n) - 1.0f) < 1e-5f, "Nlerp not unit");
+		CHECK(NearQuaternion(Nlerp(a, b, 0.0f), a) && NearQuaternion(Nlerp(a, b, 1.0f), b), "Nlerp ends wrong");
+	}
+}
+
+void CheckTransform() {
+	static_assert(sizeof(Transform) == 40, "Transform grew");
+	std::mt19937 rng(37);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (int i = 0; i < 1000; i++) {
+		Transform child;
+		child.SetPostion(Vector3F(dist(rng), dist(rng), dist(rng)) * 10.0f);
+		child.SetRotator(Vector3F(dist(rng), dist(rng), dist(rng)));
+		child.SetScale(Vector3F(dist(rng) + 2.0f, dist(rng) + 2.0f, dist(rng) + 2.0f));
+
+		// round trip through a matrix, non uniform scale included
+		Transform copy;
+		copy.SetTransform(child.GetTransform());
+		CHECK(Near(copy.GetTransform(), child.GetTransform(), 1e-4f), "SetTransform round trip wrong");
+
+		Transform parent;
+		parent.SetPostion(Vector3F(dist(rng), dist(rng), dist(rng)) * 10.0f);
+		parent.SetRotator(Vector3F(dist(rng), dist(rng), dist(rng)));
+		parent.SetScale(Vector3F(dist(rng) + 2.0f));
+		CHECK(Near((child * parent).GetTransform(), child.GetTransform() * parent.GetTransform(), 1e-4f),
+			"Transform compose wrong");
+	}
+}
+
+// world transforms as Transform makes them, against Matrix4F
+void CheckAffine() {
+	std::mt19937 rng(53);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	auto random = [&]() {
+		Transform t;
+		t.SetPostion(Vector3F(dist(rng), dist(rng), dist(rng)) * 10.0f);
+		t.SetRotator(Vector3F(dist(rng), dist(rng), dist(rng)) * 3.0f);
+		t.SetScale(Vector3F(dist(rng) + 2.0f, dist(rng) + 2.0f, dist(rng) + 2.0f));
+		return t.GetTransform();
+	};
+	for (int i = 0; i < 10000; i++) {
+		Affine3x4 a = random(), b = random();
+		Affine3x4 ab = a * b;
+		Matrix4F ab4 = a.ToMatrix4() * b.ToMatrix4();
+		Vector4F w(0, 0, 0, 1);
+		CHECK(Near(ab, Affine3x4(ab4), K_PATH_TOLERANCE) && Same(&ab4.w, &w, sizeof(w)), "affine multiply differs from Matrix4F", i);
+		Affine3x4 abScalar = a.MulScalar(b);
+		CHECK(Near(ab, abScalar, K_PATH_TOLERANCE), "affine multiply differs from scalar", i);
+
+		Affine3x4 inv = a.GetInverse(), invScalar = a.GetInverseScalar();
+		CHECK(Near(inv, invScalar, K_PATH_TOLERANCE), "affine inverse differs from scalar", i);
+		CHECK(Near(inv, Affine3x4(a.ToMatrix4().GetInverseScalar()), 1e-4f), "affine inverse differs from Matrix4F", i);
+		CHECK(Near(a * inv, Affine3x4::Identity, 1e-5f), "affine inverse wrong", i);
+
+		Vector3F p(dist(rng), dist(rng), dist(rng)), out;
+		SoAVector3F in{ &p.x, &p.y, &p.z }, soa{ &out.x, &out.y, &out.z };
+		TransformPointsScalar(a.ToMatrix4(), in, soa, 1);
+		Vector3F point = a.TransformPoint(p);
+		CHECK(Near(&point.x, &out.x, 3, K_PATH_TOLERANCE), "affine point differs from TransformPoints");
+		TransformNormalsScalar(a.ToMatrix4(), in, soa, 1);
+		Vector3F normal = a.TransformNormal(p);
+		CHECK(Near(&normal.x, &out.x, 3, K_PATH_TOLERANCE), "affine normal differs from TransformNormals");
+		CHECK(NearVector(inv.TransformPoint(a.TransformPoint(p)), p), "affine point round trip wrong");
+	}
+
+	constexpr Affine3x4 K_MOVED = Affine3x4(MatrixTransform(Vector3F(1, 2, 3))) * Affine3x4::Identity;
+	static_assert(K_MOVED.x.w == 1.0f && K_MOVED.TransformPoint(Vector3F(1, 1, 1)).z == 4.0f, "constexpr affine");
+}
+
+// an item a rounding away from a plane, kernels may cull it or not (see Simd.h)
+bool OnPlane(const Frustum& frustum, const Box& box) {
+	for (const Plane& p : frustum.Planes) {
+		Point3D corner(
+			p.Normal.x > 0 ? box.MaxP.x : box.MinP.x,
+			p.Normal.y > 0 ? box.MaxP.y : box.MinP.y,
+			p.Normal.z > 0 ? box.MaxP.z : box.MinP.z);
+		if (std::abs(p.Distance(corner)) < 1e-3f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool OnPlane(const Frustum& frustum, const Point3D& center, float radius) {
+	for (const Plane& p : frustum.Planes) {
+		if (std::abs(p.Distance(center) + radius) < 1e-3f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// masks equal but for items onPlane(i), the padding bits included
+template<typename F>
+bool SameMask(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, size_t num, F onPlane) {
+	for (size_t i = 0; i < a.size() * 32; i++) {
+		if (IsMaskSet(a.data(), i) != IsMaskSet(b.data(), i) && !(i < num && onPlane(i))) {
+			return false;
+		}
+	}
+	return a.size() == b.size();
+}
+
+// a camera at the origin looking down z, 90 degrees each way
+void CheckFrustum() {
+	Camera cam(Vector3F(0, 0, 0), Vector3F(0, 0, 1));
+	cam.SetPerspective(K_PIDIV2, 1.0f, 1.0f, 100.0f);
+	Frustum frustum(cam.GetViewProjectMatrix());
+	Box box;
+	box.MinP = Vector3F(-1, -1, 10), box.MaxP = Vector3F(1, 1, 12);
+	CHECK(frustum.IsVisible(box), "box in front culled");
+	box.MinP = Vector3F(-1, -1, -12), box.MaxP = Vector3F(1, 1, -10);
+	CHECK(!frustum.IsVisible(box), "box behind visible");
+	box.MinP = Vector3F(20, -1, 10), box.MaxP = Vector3F(22, 1, 12);
+	CHECK(!frustum.IsVisible(box), "box right of the frustum visible");
+	box.MinP = Vector3F(-1, -1, 99), box.MaxP = Vector3F(1, 1, 101);
+	CHECK(frustum.IsVisible(box), "box on the far plane culled");
+	CHECK(frustum.IsVisible(Vector3F(11, 0, 10), 1.0f), "sphere across the right plane culled");
+	CHECK(!frustum.IsVisible(Vector3F(13, 0, 10), 1.0f), "sphere right of the frustum visible");
+	CHECK(!frustum.IsVisible(Vector3F(0, 0, 0.5f), 0.4f), "sphere before the near plane visible");
+
+	// kernels against the per item tests, odd counts for the tails
+	std::mt19937 rng(41);
+	std::uniform_real_distribution<float> dist(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> size(0.0f, 8.0f);
+	for (size_t num : { 0, 1, 7, 32, 33, 1000, 1029 }) {
+		std::vector<float> data(num * 7 + 1);
+		auto soa = [&](size_t first) {
+			return SoAVector3F{ &data[first * num], &data[(first + 1) * num], &data[(first + 2) * num] };
+		};
+		SoABoxF boxes{ soa(0), soa(3) };
+		float* radius = &data[num * 6];
+		for (size_t i = 0; i < num; i++) {
+			Vector3F p(dist(rng), dist(rng), dist(rng) + 50.0f);
+			Box b;
+			b.MinP = p, b.MaxP = p + Vector3F(size(rng), size(rng), size(rng));
+			boxes.Set(i, b);
+			radius[i] = size(rng);
+		}
+		std::vector<uint32_t> mask(GetMaskWords(num)), maskScalar(GetMaskWords(num), ~0u);
+		CullBoxes(frustum, boxes, num, mask.data());
+		CullBoxesScalar(frustum, boxes, num, maskScalar.data());
+		CHECK(SameMask(mask, maskScalar, num, [&](size_t i) { return OnPlane(frustum, boxes.Get(i)); }),
+			"CullBoxes differs from the scalar one");
+		for (size_t i = 0; i < num; i++) {
+			CHECK(IsMaskSet(maskScalar.data(), i) == frustum.IsVisible(boxes.Get(i)), "box mask bit wrong");
+		}
+		CullSpheres(frustum, boxes.Min, radius, num, mask.data());
+		CullSpheresScalar(frustum, boxes.Min, radius, num, maskScalar.data());
+		CHECK(SameMask(mask, maskScalar, num, [&](size_t i) { return OnPlane(frustum, boxes.Min.Get(i), radius[i]); }),
+			"CullSpheres differs from the scalar one");
+		for (size_t i = 0; i < num; i++) {
+			CHECK(IsMaskSet(maskScalar.data(), i) == frustum.IsVisible(boxes.Min.Get(i), radius[i]), "sphere mask bit wrong");
+		}
+	}
+}
+
+void CheckIntersect() {
+	// one triangle and box straight ahead
+	Ray ray(Vector3F(0.2f, 0.2f, 0), Vector3F(0, 0, 2));
+	float v[9];
+	SoATriangleF tri{ { &v[0], &v[1], &v[2] }, { &v[3], &v[4], &v[5] }, { &v[6], &v[7], &v[8] } };
+	tri.Set(0, Vector3F(0, 0, 5), Vector3F(1, 0, 5), Vector3F(0, 1, 5));
+	float t = K_MAXFLOAT;
+	size_t index = 7;
+	CHECK(IntersectTrianglesScalar(ray, tri, 1, t, index) && t == 2.5f && index == 0, "triangle ahead missed");
+	CHECK(!IntersectTrianglesScalar(ray, tri, 1, t, index), "hit not nearer than t");
+	t = K_MAXFLOAT;
+	CHECK(!IntersectTrianglesScalar(Ray(Vector3F(0.8f, 0.8f, 0), Vector3F(0, 0, 1)), tri, 1, t, index), "ray beside the triangle hit");
+	CHECK(!IntersectTrianglesScalar(Ray(Vector3F(0.2f, 0.2f, 6), Vector3F(0, 0, 1)), tri, 1, t, index), "triangle behind hit");
+
+	Box box;
+	box.MinP = Vector3F(-1, -1, 4), box.MaxP = Vector3F(1, 1, 6);
+	t = K_MAXFLOAT;
+	CHECK(IntersectBox(ray, box, t) && t == 2.0f, "box ahead missed");
+	t = K_MAXFLOAT;
+	CHECK(IntersectBox(Ray(Vector3F(0, 0, 5), Vector3F(1, 0, 0)), box, t) && t == 0.0f, "box around the origin missed");
+	t = K_MAXFLOAT;
+	CHECK(!IntersectBox(Ray(Vector3F(0, 0, 0), Vector3F(0, 0, -1)), box, t), "box behind hit");
+	CHECK(!IntersectBox(Ray(Vector3F(2, 0, 0), Vector3F(0, 0, 1)), box, t), "box beside hit");
+
+	// kernels against the scalar ones, rays through a cloud of items
+	std::mt19937 rng(43);
+	std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> size(0.0f, 2.0f);
+	for (size_t num : { 0, 1, 7, 33, 1000, 1029 }) {
+		std::vector<float> data(num * 9 + 1);
+		auto soa = [&](size_t first) {
+			return SoAVector3F{ &data[first * num], &data[(first + 1) * num], &data[(first + 2) * num] };
+		};
+		SoATriangleF tris{ soa(0), soa(3), soa(6) };
+		SoABoxF boxes{ soa(0), soa(3) };
+		for (int r = 0; r < 20; r++) {
+			for (size_t i = 0; i < num; i++) {
+				Vector3F p(dist(rng), dist(rng), dist(rng));
+				tris.Set(i, p, p + Vector3F(dist(rng), dist(rng), dist(rng)) * 0.2f, p + Vector3F(dist(rng), dist(rng), dist(rng)) * 0.2f);
+			}
+			Ray ray(Vector3F(dist(rng), dist(rng), -20.0f), Vector3F(dist(rng), dist(rng), 20.0f) * 0.05f);
+			float t0 = K_MAXFLOAT, t1 = K_MAXFLOAT;
+			size_t i0 = 0, i1 = 0;
+			bool hit0 = IntersectTriangles(ray, tris, num, t0, i0);
+			bool hit1 = IntersectTrianglesScalar(ray, tris, num, t1, i1);
+			CHECK(hit0 == hit1 && Near(&t0, &t1, 1, K_PATH_TOLERANCE) && i0 == i1, "IntersectTriangles differs from the scalar one");
+
+			for (size_t i = 0; i < num; i++) {
+				Box b;
+				b.MinP = Vector3F(dist(rng), dist(rng), dist(rng));
+				b.MaxP = b.MinP + Vector3F(size(rng), size(rng), size(rng));
+				boxes.Set(i, b);
+			}
+			t0 = t1 = K_MAXFLOAT;
+			hit0 = IntersectBoxes(ray, boxes, num, t0, i0);
+			hit1 = IntersectBoxesScalar(ray, boxes, num, t1, i1);
+			CHECK(hit0 == hit1 && Near(&t0, &t1, 1, K_PATH_TOLERANCE) && i0 == i1, "IntersectBoxes differs from the scalar one");
+			if (hit0) {
+				float t = K_MAXFLOAT;
+				CHECK(IntersectBox(ray, boxes.Get(i0), t) && Near(&t, &t0, 1, K_PATH_TOLERANCE), "nearest box wrong");
+			}
+		}
+	}
+}
+
+// folded at compile time: the scalar code, the series trig and SinCos
+constexpr Matrix4F K_MOVE = MatrixTransform(Vector3F(1, 2, 3));
+constexpr Matrix4F K_TURN = MatrixRotationAxis(Vector3F(0, 0, 2), K_PIDIV2);
+constexpr Matrix4F K_PROJ = MatrixPerspective(K_PIDIV4, 16.0f / 9.0f, 0.1f, 100.0f);
+constexpr Vector4F K_POINT = (K_TURN * K_MOVE) * Vector4F(1, 0, 0, 1);
+
+static_assert(Matrix4F::Identity.w.w == 1.0f && Vector3F::Identity.z == 1.0f, "constant statics");
+static_assert(Equal(K_POINT.x, 1.0f) && Equal(K_POINT.y, 3.0f) && Equal(K_POINT.z, 3.0f), "turn then move");
+static_assert(Equal(Cross(Vector3F(1, 0, 0), Vector3F(0, 1, 0)).z, 1.0f), "constexpr cross");
+static_assert(Equal(Sqrt(2.0f) * Sqrt(2.0f), 2.0f) && Equal(Cos(K_PI), -1.0f) && Equal(Sin(-K_2PI * 3), 0.0f), "constexpr trig");
+static_assert(K_MOVE.GetTranspose().w.x == 1.0f && (K_MOVE * Matrix4F::Identity).x.w == 1.0f, "constexpr matrix ops");
+
+// and the runtime simd or std:: result, within an ulp or two
+void CheckConstexpr() {
+	volatile float angle = K_PIDIV2, fov = K_PIDIV4;
+	Matrix4F move = MatrixTransform(Vector3F(1, 2, 3));
+	Matrix4F turn = MatrixRotationAxis(Vector3F(0, 0, 2), angle);
+	CHECK(Same(&move, &K_MOVE, sizeof(Matrix4F)), "constexpr MatrixTransform differs");
+	CHECK(Near(turn, K_TURN, 1e-6f), "constexpr MatrixRotationAxis differs");
+	CHECK(Near(MatrixPerspective(fov, 16.0f / 9.0f, 0.1f, 100.0f), K_PROJ, 1e-6f), "constexpr MatrixPerspective differs");
+	Vector4F p = (turn * move) * Vector4F(1, 0, 0, 1);
+	CHECK(std::abs(p.x - K_POINT.x) < 1e-6f && std::abs(p.y - K_POINT.y) < 1e-6f && std::abs(p.z - K_POINT.z) < 1e-6f,
+		"constexpr transform differs");
+	for (int i = -100; i <= 100; i++) {
+		constexpr float step = 0.173f;
+		volatile float x = i * step;
+		CHECK(std::abs(Sin(x) - (float)detail::SinSeries(detail::ReduceAngle(x))) < 1e-6f, "sin series wrong");
+		CHECK(std::abs(Cos(x) - (float)detail::CosSeries(detail::ReduceAngle(x))) < 1e-6f, "cos series wrong");
+		float v = std::abs(x) * 37.0f;
+		CHECK(Sqrt(v) == (float)detail::SqrtNewton(v), "sqrt newton wrong");
+	}
+}
+
+
+bool SameHalf(uint16_t a, uint16_t b) {
+	bool aNan = (a & 0x7c00) == 0x7c00 && (a & 0x3ff) != 0;
+	bool bNan = (b & 0x7c00) == 0x7c00 && (b & 0x3ff) != 0;
+	return aNan ? bNan : a == b;
+}
+
+void CheckPacking() {
+	// every half survives the round trip, nans stay nan
+	for (uint32_t h = 0; h < 0x10000; h++) {
+		uint16_t back = FloatToHalf(HalfToFloat((uint16_t)h));
+		CHECK(SameHalf(back, (uint16_t)h), "half round trip", h, back);
+	}
+	CHECK(FloatToHalf(1.0f) == 0x3c00 && FloatToHalf(-2.0f) == 0xc000 && FloatToHalf(65504.0f) == 0x7bff, "half values");
+	CHECK(FloatToHalf(65520.0f) == 0x7c00 && FloatToHalf(-1e10f) == 0xfc00, "half overflow");
+	CHECK(FloatToHalf(1.0f + 1.0f / 2048) == 0x3c00 && FloatToHalf(1.0f + 3.0f / 2048) == 0x3c02, "half ties to even");
+	CHECK(FloatToHalf(std::ldexp(1.0f, -25)) == 0 && FloatToHalf(std::ldexp(1.5f, -25)) == 1, "half denormal rounding");
+
+	CHECK(PackSnorm16(1.0f) == 32767 && PackSnorm16(-1.0f) == -32767 && PackSnorm16(-2.0f) == -32767, "snorm16 range");
+	CHECK(UnpackSnorm16(-32768) == -1.0f && UnpackSnorm16(PackSnorm16(0.5f)) == 16384 / 32767.0f, "snorm16 decode");
+	CHECK(PackSnorm8(0.5f) == 64 && UnpackSnorm8(-128) == -1.0f, "snorm8");
+	CHECK(PackUnorm16(2.0f) == 65535 && PackUnorm16(-1.0f) == 0 && UnpackUnorm16(65535) == 1.0f, "unorm16");
+
+	// bulk against the single value converters, specials and tails
+	std::mt19937 rng(47);
+	std::uniform_real_distribution<float> wide(-70000.0f, 70000.0f);
+	std::uniform_real_distribution<float> unit(-1.2f, 1.2f);
+	std::uniform_int_distribution<uint32_t> bits;
+	const float specials[] = { 0.0f, -0.0f, K_MAXFLOAT, -K_MAXFLOAT, std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::quiet_NaN(), std::ldexp(1.0f, -14), std::ldexp(1.0f, -24), 65519.0f, 1.0f, -1.0f };
+	for (size_t num : { 0, 1, 3, 4, 5, 17, 1000, 1027 }) {
+		std::vector<float> in(num), unitIn(num), back(num), backScalar(num);
+		std::vector<uint16_t> half(num + 1, 0xdead), halfScalar(num + 1, 0xdead);
+		std::vector<int16_t> snorm(num * 2 + 1, 77), snormScalar(num * 2 + 1, 77);
+		std::vector<float> normalData(num * 3);
+		SoAVector3F normals{ &normalData[0], &normalData[num], &normalData[num * 2] };
+		for (size_t i = 0; i < num; i++) {
+			in[i] = i % 5 == 4 ? detail::BitsFloat(bits(rng)) : wide(rng) * (i % 2 ? 1.0f : 1e-4f);
+			unitIn[i] = unit(rng);
+			Vector3F n(unit(rng), unit(rng), unit(rng));
+			normals.Set(i, i % 7 == 3 ? Vector3F(0, 0, -1) : Normalize(n + Vector3F(0, 0, 0.01f)));
+		}
+		for (size_t i = 0; i < num && i < sizeof(specials) / sizeof(specials[0]); i++) {
+			in[i] = specials[i];
+			unitIn[i] = specials[i];
+		}
+		FloatToHalf(in.data(), half.data(), num);
+		FloatToHalfScalar(in.data(), halfScalar.data(), num);
+		for (size_t i = 0; i <= num; i++) {
+			CHECK(SameHalf(half[i], halfScalar[i]), "bulk float to half differs", num, i, in[i]);
+		}
+		HalfToFloat(half.data(), back.data(), num);
+		HalfToFloatScalar(half.data(), backScalar.data(), num);
+		for (size_t i = 0; i < num; i++) {
+			CHECK(Same(&back[i], &backScalar[i], 4) || (std::isnan(back[i]) && std::isnan(backScalar[i])), "bulk half to float differs", num, i);
+		}
+		PackSnorm16(unitIn.data(), snorm.data(), num);
+		PackSnorm16Scalar(unitIn.data(), snormScalar.data(), num);
+		CHECK(snorm == snormScalar, "bulk snorm16 differs", num);
+		PackNormalsOct(normals, snorm.data(), num);
+		PackNormalsOctScalar(normals, snormScalar.data(), num);
+		CHECK(snorm == snormScalar, "bulk oct differs", num);
+		for (size_t i = 0; i < num; i++) {
+			Vector3F n = OctDecode(Vector2F(UnpackSnorm16(snorm[i * 2]), UnpackSnorm16(snorm[i * 2 + 1])));
+			CHECK(Dot(n, normals.Get(i)) > 0.99999f, "oct normal off", num, i, n);
+		}
+	}
+
+	// tangent frames of both hands through snorm16
+	for (int i = 0; i < 1000; i++) {
+		Vector3F n = Normalize(Vector3F(unit(rng), unit(rng), unit(rng)) + Vector3F(0, 0.01f, 0));
+		Vector3F t = Normalize(Cross(n, Vector3F(unit(rng), unit(rng), unit(rng)) + Vector3F(0.01f, 0, 0)));
+		Vector3F b = Cross(n, t) * (i % 2 ? -1.0f : 1.0f);
+		Quaternion q = TangentFrameToQuaternion(n, t, b);
+		q = Normalize(Quaternion(UnpackSnorm16(PackSnorm16(q.x)), UnpackSnorm16(PackSnorm16(q.y)),
+			UnpackSnorm16(PackSnorm16(q.z)), UnpackSnorm16(PackSnorm16(q.w))));
+		Vector3F n2, t2, b2;
+		QuaternionToTangentFrame(q, n2, t2, b2);
+		CHECK(Dot(n, n2) > 0.9999f && Dot(t, t2) > 0.9999f && Dot(b, b2) > 0.9999f, "qtangent off", i, n, n2, t, t2, b, b2);
+	}
+}
+
+
+constexpr float SinOf(float x) { float s = 0, c = 0; SinCos(x, s, c); return s; }
+constexpr float CosOf(float x) { float s = 0, c = 0; SinCos(x, s, c); return c; }
+static_assert(SinOf(0.0f) == 0.0f && CosOf(0.0f) == 1.0f, "constexpr SinCos");
+static_assert(SinOf(K_PIDIV2) == 1.0f && CosOf(K_PI) == -1.0f, "constexpr SinCos quadrants");
+
+// the error bounds of FastMath.h against double std::, bulk against the scalar ones
+void CheckFastMath() {
+	std::mt19937 rng(59);
+	std::uniform_real_distribution<float> angle(-8192.0f, 8192.0f);
+	std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> expo(-60.0f, 60.0f);
+	for (size_t num : { 0, 1, 3, 4, 5, 1027 }) {
+		std::vector<float> x(num), y(num), s(num + 1, 7.0f), c(num + 1, 7.0f), sScalar(num + 1, 7.0f), cScalar(num + 1, 7.0f);
+		for (size_t i = 0; i < num; i++) {
+			x[i] = i % 3 ? angle(rng) : angle(rng) / 4096.0f;
+			y[i] = coord(rng) * (i % 4 == 1 ? 1e-6f : 1.0f);
+		}
+		SinCos(x.data(), s.data(), c.data(), num);
+		SinCosScalar(x.data(), sScalar.data(), cScalar.data(), num);
+		CHECK(Near(s.data(), sScalar.data(), num + 1, K_PATH_TOLERANCE) && Near(c.data(), cScalar.data(), num + 1, K_PATH_TOLERANCE),
+			"bulk sincos differs", num);
+		for (size_t i = 0; i < num; i++) {
+			CHECK(std::abs(s[i] - std::sin((double)x[i])) < 1e-7 && std::abs(c[i] - std::cos((double)x[i])) < 1e-7,
+				"sincos off", x[i], s[i], c[i]);
+		}
+
+		// the angles as coordinates, some on the axes
+		for (size_t i = 0; i < num; i++) {
+			x[i] = i % 7 == 2 ? 0.0f : x[i] / 80.0f;
+			y[i] = i % 11 == 5 ? -0.0f : y[i];
+		}
+		Atan2(y.data(), x.data(), s.data(), num);
+		Atan2Scalar(y.data(), x.data(), sScalar.data(), num);
+		CHECK(Near(s.data(), sScalar.data(), num + 1, K_PATH_TOLERANCE), "bulk atan2 differs", num);
+		for (size_t i = 0; i < num; i++) {
+			CHECK(std::abs(s[i] - std::atan2((double)y[i], (double)x[i])) < 4e-7 || (x[i] == 0 && y[i] == 0), "atan2 off", y[i], x[i], s[i]);
+		}
+
+		for (size_t i = 0; i < num; i++) {
+			x[i] = std::exp2(expo(rng));
+		}
+		Rsqrt(x.data(), s.data(), num);
+		for (size_t i = 0; i < num; i++) {
+			double exact = 1.0 / std::sqrt((double)x[i]);
+			CHECK(std::abs(s[i] - exact) < 5e-7 * exact, "rsqrt off", x[i], s[i]);
+		}
+
+		std::vector<float> data(num * 6);
+		SoAVector3F in{ &data[0], &data[num], &data[num * 2] }, out{ &data[num * 3], &data[num * 4], &data[num * 5] };
+		for (size_t i = 0; i < num; i++) {
+			Vector3F v = Vector3F(coord(rng), coord(rng), coord(rng)) * std::exp2(expo(rng) * 0.75f);
+			in.Set(i, i % 9 == 4 ? Vector3F(0, 0, 0) : v);
+		}
+		NormalizeVectors(in, out, num);
+		for (size_t i = 0; i < num; i++) {
+			Vector3F n = out.Get(i);
+			double len = std::sqrt((double)n.x * n.x + (double)n.y * n.y + (double)n.z * n.z);
+			CHECK(i % 9 == 4 ? len == 0 : std::abs(len - 1.0) < 1e-6, "normalize off", in.Get(i), n);
+		}
+	}
+	float s = 0, c = 0;
+	SinCos(-K_PIDIV2, s, c);
+	CHECK(s == -1.0f && std::abs(c) < 1e-7f, "sincos -pi/2", s, c);
+	CHECK(Atan2(0.0f, -1.0f) == K_PI && Atan2(-0.0f, 1.0f) == 0.0f && std::signbit(Atan2(-0.0f, 1.0f)), "atan2 axes");
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	Log<LINFO>("math backend", BackendName());
+	CheckExact();
+	CheckInverse();
+	CheckBatch();
+	CheckQuaternion();
+	CheckTransform();
+	CheckAffine();
+	CheckFrustum();
+	CheckIntersect();
+	CheckConstexpr();
+	CheckPacking();
+	CheckFastMath();
+	Log<LINFO>("math tests passed");
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace z;
+
+namespace {
+
+// sizes around the grain and chunk edges
+const size_t K_SIZES[] = { 0, 1, 7, 1023, 1024, 1025, 4096, 100000, 1000003 };
+
+void CheckFor(sched::ParallelScheduler& sc) {
+	for (size_t num : K_SIZES) {
+		std::vector<std::atomic<int>> hits(num);
+		sched::ParallelFor(sc, 0, num, [&](size_t i) {
+			hits[i].fetch_add(1, std::memory_order_relaxed);
+		});
+		for (size_t i = 0; i < num; i++) {
+			CHECK(hits[i] == 1, "ParallelFor missed or repeated an index");
+		}
+	}
+
+	// nested loops on the same scheduler, the inner caller is a worker
+	std::atomic<size_t> total{ 0 };
+	sched::ParallelFor(sc, 0, 64, [&](size_t) {
+		sched::ParallelForRange(sc, 0, 10000, [&](size_t b, size_t e) {
+			total.fetch_add(e - b, std::memory_order_relaxed);
+		}, 100);
+	}, 1);
+	CHECK(total == 64 * 10000, "nested ParallelFor lost items");
+}
+
+void CheckReduce(sched::ParallelScheduler& sc) {
+	for (size_t num : K_SIZES) {
+		uint64_t sum = sched::ParallelReduce(sc, 0, num, uint64_t(0),
+			[](size_t b, size_t e, uint64_t acc) {
+				for (size_t i = b; i < e; i++) {
+					acc += i;
+				}
+				return acc;
+			},
+			[](uint64_t a, uint64_t b) { return a + b; });
+		CHECK(sum == (num == 0 ? 0 : uint64_t(num) * (num - 1) / 2), "ParallelReduce sum wrong");
+	}
+
+	// same chunking every run, float sums are bit exact
+	std::vector<float> values(1000003);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (float& v : values) {
+		v = dist(rng);
+	}
+	auto floatSum = [&]() {
+		return sched::ParallelReduce(sc, 0, values.size(), 0.0f,
+			[&](size_t b, size_t e, float acc) {
+				for (size_t i = b; i < e; i++) {
+					acc += values[i];
+				}
+				return acc;
+			},
+			[](float a, float b) { return a + b; });
+	};
+	float first = floatSum();
+	for (int i = 0; i < 10; i++) {
+		CHECK(floatSum() == first, "ParallelReduce not deterministic");
+	}
+}
+
+void CheckScan(sched::ParallelScheduler& sc) {
+	std::mt19937 rng(11);
+	for (size_t num : K_SIZES) {
+		std::vector<uint32_t> in(num);
+		for (uint32_t& v : in) {
+			v = rng() % 100;
+		}
+		std::vector<uint32_t> expected(num), out(num);
+		std::partial_sum(in.begin(), in.end(), expected.begin());
+		sched::ParallelScan(sc, in.begin(), in.end(), out.begin(), 0u, [](uint32_t a, uint32_t b) { return a + b; });
+		CHECK(out == expected, "ParallelScan wrong");
+
+		// in place
+		sched::ParallelScan(sc, in.begin(), in.end(), in.begin(), 0u, [](uint32_t a, uint32_t b) { return a + b; });
+		CHECK(in == expected, "ParallelScan in place wrong");
+	}
+}
+
+void CheckSort(sched::ParallelScheduler& sc) {
+	std::mt19937 rng(13);
+	for (size_t num : K_SIZES) {
+		std::vector<uint32_t> values(num);
+		for (uint32_t& v : values) {
+			// many duplicates
+			v = rng() % (uint32_t)(num / 4 + 1);
+		}
+		std::vector<uint32_t> expected = values;
+		std::sort(expected.begin(), expected.end());
+		sched::ParallelSort(sc, values.begin(), values.end(), std::less<uint32_t>());
+		CHECK(values == expected, "ParallelSort wrong");
+	}
+
+	// sorted and reversed inputs make skewed merges
+	std::vector<int> sorted(300000);
+	std::iota(sorted.begin(), sorted.end(), 0);
+	std::vector<int> reversed(sorted.rbegin(), sorted.rend());
+	sched::ParallelSort(sc, reversed.begin(), reversed.end(), std::less<int>());
+	CHECK(reversed == sorted, "ParallelSort of reversed input wrong");
+	sched::ParallelSort(sc, sorted.begin(), sorted.end(), std::greater<int>());
+	CHECK(std::is_sorted(sorted.begin(), sorted.end(), std::greater<int>()), "ParallelSort with greater wrong");
+}
+
+void CheckAll(sched::EServiceMode mode, int threads) {
+	sched::ThreadWorker worker(threads, mode);
+	worker.Run();
+	sched::ParallelScheduler sc(&worker);
+	CheckFor(sc);
+	CheckReduce(sc);
+	CheckScan(sc);
+	CheckSort(sc);
+	worker.Stop();
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	CheckAll(sched::SERVICE_SHARED_QUEUE, 4);
+	CheckAll(sched::SERVICE_WORK_STEALING, 4);
+	CheckAll(sched::SERVICE_WORK_STEALING, 1);
+	Log<LINFO>("parallel tests passed");
+	return 0;
+}
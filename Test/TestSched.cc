@@ -21,6 +21,29 @@ int main(int argc, char* argv[]) {
 	sched::ComplexScheduler sc(&worker);
 	sched::StrandScheduler sc2(&worker);
 
+	// schedulers gone with live and just fired timers, nothing posts to them later.
+	// on the heap, so a sanitizer sees a stale queue
+	for (int i = 0; i < 200; i++) {
+		auto timed = std::make_unique<sched::ComplexScheduler>(&worker);
+		timed->PostStrandEvery(1ms, []() {});
+		timed->PostParEvery(1ms, []() {});
+		timed->PostStrandAfter(std::chrono::microseconds(i % 20 * 100), []() {});
+		timed->PostParAfter(std::chrono::microseconds(i % 20 * 100), []() {});
+		std::this_thread::sleep_for(std::chrono::microseconds(i % 20 * 100));
+	}
+	std::this_thread::sleep_for(5ms);
+
+	// a handle outliving its service
+	sched::TimerHandle orphan;
+	{
+		auto other = std::make_unique<sched::ThreadWorker>(1);
+		other->Run();
+		sched::StrandScheduler timed(other.get());
+		orphan = timed.PostStrandAfter(1h, []() {});
+		CHECK(orphan.IsValid(), "timer handle invalid");
+	}
+	CHECK(!orphan.Cancel() && !orphan.IsValid(), "timer cancelled after its service is gone");
+
 	auto now = std::chrono::system_clock::now();
 	auto sleep_nms = [&now](int n) {
 		std::this_thread::sleep_for(std::chrono::milliseconds(n));
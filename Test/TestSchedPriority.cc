@@ -0,0 +1,99 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+namespace {
+
+int64_t NowMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// keep a worker busy without sleeping, like a texture decode
+void BusyFor(int64_t micros) {
+	int64_t end = NowMicros() + micros;
+	while (NowMicros() < end) {
+	}
+}
+
+/* flood background with long jobs, then post critical probes now and then.
+   return the worst time from posting a probe to it starting. */
+double RunCriticalLatency(sched::EServiceMode mode, int threads, int backgroundLimit) {
+	sched::ThreadWorker worker(threads, mode);
+	if (backgroundLimit > 0) {
+		worker.GetService().SetBackgroundWorkerLimit(backgroundLimit);
+	}
+	worker.Run();
+	sched::ParallelScheduler background(&worker, sched::PRIORITY_BACKGROUND);
+	sched::ParallelScheduler normal(&worker);
+	sched::StrandScheduler critical(&worker, sched::PRIORITY_CRITICAL);
+
+	const int backgroundJobs = 2000;
+	const int64_t backgroundMicros = 10000;
+	std::atomic<int> backgroundDone{ 0 };
+	for (int i = 0; i < backgroundJobs; i++) {
+		background.PostPar([&backgroundDone, backgroundMicros]() {
+			BusyFor(backgroundMicros);
+			backgroundDone++;
+		});
+	}
+
+	// normal work still gets through while background is saturated
+	std::atomic<int> normalDone{ 0 };
+	const int normalJobs = 100;
+	for (int i = 0; i < normalJobs; i++) {
+		normal.PostPar([&normalDone]() { normalDone++; });
+	}
+
+	const int probes = 50;
+	std::vector<int64_t> latency;
+	for (int i = 0; i < probes; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(3));
+		std::atomic<int64_t> started{ 0 };
+		int64_t posted = NowMicros();
+		critical.PostStrand([&started]() { started = NowMicros(); });
+		while (started == 0) {
+			std::this_thread::yield();
+		}
+		latency.push_back(started - posted);
+	}
+	CHECK(backgroundDone < backgroundJobs, "background finished before probes, not saturated");
+	CHECK(normalDone == normalJobs, "normal work starved by background");
+
+	// no need to wait for the whole flood
+	worker.Stop(false);
+	return *std::max_element(latency.begin(), latency.end()) / 1000.0;
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	int threads = 4;
+	// one core machines may need more, the reserved worker still has to be scheduled by the os
+	double boundMillis = 5.0;
+	if (argc > 1) {
+		boundMillis = atof(argv[1]);
+	}
+
+	for (sched::EServiceMode mode : { sched::SERVICE_SHARED_QUEUE, sched::SERVICE_WORK_STEALING }) {
+		const char* name = mode == sched::SERVICE_SHARED_QUEUE ? "shared" : "stealing";
+
+		// no reservation, critical waits for a background job to end
+		double unreserved = RunCriticalLatency(mode, threads, threads);
+		double reserved = RunCriticalLatency(mode, threads, 0);
+		Log<LINFO>(name, "critical start latency max(ms), all workers for background", unreserved,
+			"one reserved", reserved);
+		CHECK(reserved < boundMillis, "critical task started too late");
+	}
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+#include <Core/Scheduler/Stats.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace z;
+
+#if Z_SCHED_STATS
+
+namespace {
+
+void BusyFor(std::chrono::microseconds time) {
+	auto end = std::chrono::steady_clock::now() + time;
+	while (std::chrono::steady_clock::now() < end) {
+	}
+}
+
+void LogHistogram(const char* name, const sched::HistogramSnapshot& h) {
+	Log<LINFO>(name, "count", h.Count, "mean(us)", h.Mean() / 1000.0, "p50(us)", h.Percentile(50) / 1000.0,
+		"p99(us)", h.Percentile(99) / 1000.0, "max(us)", h.Max / 1000.0);
+}
+
+void CheckHistogram() {
+	sched::Histogram h;
+	for (uint64_t v = 1; v <= 1000; v++) {
+		h.Record(v);
+	}
+	sched::HistogramSnapshot s;
+	s.Add(h);
+	CHECK(s.Count == 1000 && s.Max == 1000 && s.Sum == 500500, "histogram totals wrong");
+	// buckets are within 25% of the value
+	uint64_t p50 = s.Percentile(50);
+	CHECK(p50 >= 500 && p50 < 625, "p50 out of bucket");
+	CHECK(s.Percentile(100) == 1000, "p100 should be max");
+
+	for (uint32_t b = 1; b < sched::Histogram::K_BUCKET_NUM; b++) {
+		uint64_t low = sched::Histogram::BucketLow(b);
+		CHECK(sched::Histogram::BucketOf(low) == b && sched::Histogram::BucketOf(low - 1) == b - 1, "bucket bounds wrong");
+	}
+}
+
+void RunFrame(sched::EServiceMode mode) {
+	sched::ThreadWorker worker(4, mode);
+	worker.Run();
+	sched::ParallelScheduler physics(&worker);
+	sched::StrandScheduler render(&worker, sched::PRIORITY_CRITICAL);
+	physics.SetParName("physics");
+	render.SetStrandName("render");
+
+	sched::Stats::Reset();
+	sched::Stats::StartTrace();
+
+	const int jobs = 400;
+	std::atomic<int> done{ 0 };
+	for (int i = 0; i < jobs; i++) {
+		physics.PostPar([&]() {
+			BusyFor(std::chrono::microseconds(50));
+			render.PostStrand([&]() { done++; });
+		});
+	}
+	while (done < jobs) {
+		std::this_thread::yield();
+	}
+	sched::Stats::StopTrace();
+
+	sched::StatsSnapshot snapshot = sched::Stats::Snapshot();
+	const char* name = mode == sched::SERVICE_SHARED_QUEUE ? "shared" : "stealing";
+	Log<LINFO>(name, "steals", snapshot.Steals, "misses", snapshot.StealMisses);
+	LogHistogram("  normal wait", snapshot.Wait[sched::PRIORITY_NORMAL]);
+	LogHistogram("  normal run", snapshot.Run[sched::PRIORITY_NORMAL]);
+	LogHistogram("  critical wait", snapshot.Wait[sched::PRIORITY_CRITICAL]);
+
+	CHECK(snapshot.Run[sched::PRIORITY_NORMAL].Count == jobs, "normal runs not counted");
+	CHECK(snapshot.Run[sched::PRIORITY_CRITICAL].Count == jobs, "critical runs not counted");
+	CHECK(snapshot.Run[sched::PRIORITY_NORMAL].Percentile(50) >= 40000, "run time too short");
+	bool found = false;
+	for (const sched::QueueSnapshot& q : snapshot.Queues) {
+		if (q.Name == "physics") {
+			found = true;
+			CHECK(q.Depth.Count == jobs && q.Depth.Max > 1, "physics depth not sampled");
+		}
+	}
+	CHECK(found, "named queue missing");
+
+	std::ostringstream trace;
+	sched::Stats::WriteChromeTrace(trace);
+	std::string json = trace.str();
+	CHECK(json.find("\"name\":\"physics\"") != std::string::npos, "trace misses physics");
+	CHECK(json.find("\"name\":\"render\"") != std::string::npos, "trace misses render");
+
+	std::string path = std::string("sched_trace_") + name + ".json";
+	std::ofstream(path) << json;
+	Log<LINFO>("  trace written to", path, "open it in chrome://tracing");
+
+	worker.Stop();
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	CheckHistogram();
+	RunFrame(sched::SERVICE_SHARED_QUEUE);
+	RunFrame(sched::SERVICE_WORK_STEALING);
+	return 0;
+}
+
+#else
+
+int main(int argc, char* argv[]) {
+	Log<LINFO>("scheduler stats are compiled out, build with Z_SCHED_STATS=1");
+	return 0;
+}
+
+#endif
@@ -0,0 +1,206 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/TaskGraph.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+namespace {
+
+/* random dag, edges only go from lower to higher ids. every node stamps its
+   start and end from a shared clock, a node must start after all its
+   predecessors ended. some nodes run on the caller.
+*/
+void CheckOrder(sched::EServiceMode mode) {
+	sched::ThreadWorker worker(4, mode);
+	worker.Run();
+	sched::TaskGraph graph(&worker);
+
+	const int num = 200;
+	std::mt19937 rng(1234);
+	std::atomic<int> clock{ 0 };
+	std::vector<int> starts(num), ends(num);
+	std::vector<std::vector<int>> preds(num);
+	std::atomic<int> offCaller{ 0 };
+	std::thread::id caller = std::this_thread::get_id();
+
+	for (int i = 0; i < num; i++) {
+		bool onCaller = rng() % 8 == 0;
+		graph.AddNode("node", [&, i, onCaller]() {
+			starts[i] = clock.fetch_add(1);
+			if (onCaller && std::this_thread::get_id() != caller) {
+				offCaller++;
+			}
+			ends[i] = clock.fetch_add(1);
+		}, onCaller);
+	}
+	for (int i = 1; i < num; i++) {
+		int edges = rng() % 4;
+		for (int e = 0; e < edges; e++) {
+			int from = rng() % i;
+			graph.AddEdge(from, i);
+			preds[i].push_back(from);
+		}
+	}
+	CHECK(graph.Build(), "acyclic graph failed to build");
+
+	// the order Build gives is a topological one
+	std::vector<int> position(num, -1);
+	const std::vector<sched::TaskNodeId>& order = graph.GetTopologicalOrder();
+	CHECK(order.size() == num, "order misses nodes");
+	for (int i = 0; i < num; i++) {
+		position[order[i]] = i;
+	}
+	for (int i = 0; i < num; i++) {
+		for (int p : preds[i]) {
+			CHECK(position[p] < position[i], "topological order broken");
+		}
+	}
+
+	// many runs of the same graph
+	for (int frame = 0; frame < 200; frame++) {
+		clock = 0;
+		graph.Run();
+		CHECK(graph.IsDone() && clock == num * 2, "not every node ran once");
+		for (int i = 0; i < num; i++) {
+			for (int p : preds[i]) {
+				CHECK(ends[p] < starts[i], "node started before its predecessor ended");
+			}
+		}
+	}
+	CHECK(offCaller == 0, "caller node ran on a worker");
+	worker.Stop();
+}
+
+// independent nodes overlap, the caller node waits for both
+void CheckOverlap() {
+	sched::ThreadWorker worker(2, sched::SERVICE_WORK_STEALING);
+	worker.Run();
+	sched::TaskGraph graph(&worker);
+
+	std::atomic<int> arrived{ 0 };
+	auto meet = [&arrived]() {
+		// both have to be in at once, or this never ends
+		arrived++;
+		while (arrived < 2) {
+			std::this_thread::yield();
+		}
+	};
+	sched::TaskNodeId a = graph.AddNode("a", meet);
+	sched::TaskNodeId b = graph.AddNode("b", meet);
+	bool joined = false;
+	sched::TaskNodeId join = graph.AddNode("join", [&]() { joined = arrived == 2; }, true);
+	graph.AddEdge(a, join);
+	graph.AddEdge(b, join);
+	graph.Run();
+	CHECK(joined, "join ran too early");
+	worker.Stop();
+}
+
+/* the frame of Director::SetPipelined: render draws last frame's snapshot on
+   the caller while the next one simulates on a worker, snapshots double
+   buffered and swapped after each run. a frame costs about max(sim, render)
+*/
+double RunFrames(sched::ThreadWorker& worker, bool pipelined, int frames) {
+	sched::TaskGraph graph(&worker);
+	int snapshots[2] = { -1, -1 };
+	int front = 0;
+	int frame = 0;
+	int rendered = -1;
+	bool inOrder = true;
+
+	sched::TaskNodeId sim = graph.AddNode("sim", [&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		snapshots[1 - front] = frame;
+		if (!pipelined) {
+			front = 1 - front;
+		}
+	});
+	sched::TaskNodeId render = graph.AddNode("render", [&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		// a frame behind when pipelined, nothing to draw on the first one
+		int expected = pipelined ? frame - 1 : frame;
+		inOrder = inOrder && snapshots[front] == expected;
+		rendered = snapshots[front];
+	}, true);
+	if (!pipelined) {
+		graph.AddEdge(sim, render);
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	for (frame = 0; frame < frames; frame++) {
+		graph.Run();
+		if (pipelined) {
+			front = 1 - front;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	CHECK(inOrder, "render saw the wrong snapshot");
+	CHECK(rendered == (pipelined ? frames - 2 : frames - 1), "last snapshot not rendered");
+	return seconds;
+}
+
+void CheckPipelined() {
+	sched::ThreadWorker worker(1, sched::SERVICE_WORK_STEALING);
+	worker.Run();
+	double serial = RunFrames(worker, false, 20);
+	double pipelined = RunFrames(worker, true, 20);
+	Log<LINFO>("20 frames of 10ms sim + 10ms render, serial", serial, "s pipelined", pipelined, "s");
+	CHECK(pipelined < serial * 0.75, "pipelined frames didn't overlap");
+	worker.Stop();
+}
+
+/* graphs made, run and destroyed back to back, as Director::SetPipelined does.
+   the worker running the last node is still in the graph's queue when Wait
+   returns, the queue has to outlive it (run under asan, and with Z_SCHED_STATS)
+*/
+void CheckChurn(sched::EServiceMode mode) {
+	sched::ThreadWorker worker(4, mode);
+	worker.Run();
+	std::atomic<int> ran{ 0 };
+	const int graphs = 2000;
+	for (int i = 0; i < graphs; i++) {
+		std::unique_ptr<sched::TaskGraph> graph(new sched::TaskGraph(&worker, sched::PRIORITY_CRITICAL));
+		sched::TaskNodeId root = graph->AddNode("root", [&ran]() { ran++; }, i % 2 == 0);
+		for (int n = 0; n < 4; n++) {
+			graph->AddEdge(root, graph->AddNode("leaf", [&ran]() { ran++; }));
+		}
+		graph->Run();
+	}
+	CHECK(ran == graphs * 5, "graph nodes lost");
+	worker.Stop();
+}
+
+void CheckCycle() {
+	sched::ThreadWorker worker(1);
+	sched::TaskGraph graph(&worker);
+	sched::TaskNodeId a = graph.AddNode("a", []() {});
+	sched::TaskNodeId b = graph.AddNode("b", []() {});
+	sched::TaskNodeId c = graph.AddNode("c", []() {});
+	graph.AddEdge(a, b);
+	graph.AddEdge(b, c);
+	graph.AddEdge(c, b);
+	CHECK(!graph.Build(), "cycle not found");
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	CheckOrder(sched::SERVICE_SHARED_QUEUE);
+	CheckOrder(sched::SERVICE_WORK_STEALING);
+	CheckOverlap();
+	CheckPipelined();
+	CheckChurn(sched::SERVICE_SHARED_QUEUE);
+	CheckChurn(sched::SERVICE_WORK_STEALING);
+	CheckCycle();
+	Log<LINFO>("task graph tests passed");
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+
+#include <Core/CoreHeader.h>
+#include <Core/Scheduler/Scheduler.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace z;
+
+namespace {
+
+// 2 nodes of 4 cores with 2 threads each, numbered like linux: siblings are cpu and cpu + 8
+sched::CpuTopology FakeTopology() {
+	std::vector<sched::CpuInfo> cpus;
+	std::vector<int> coreIds;
+	for (int cpu = 0; cpu < 16; cpu++) {
+		sched::CpuInfo info;
+		info.Cpu = cpu;
+		info.Package = (cpu % 8) / 4;
+		info.Node = info.Package;
+		cpus.push_back(info);
+		coreIds.push_back(cpu % 4);
+	}
+	return sched::CpuTopology(cpus, coreIds);
+}
+
+void CheckPlacement() {
+	sched::CpuTopology topology = FakeTopology();
+	CHECK(topology.GetCoreNum() == 8 && topology.GetNodeNum() == 2, "fake topology counts wrong");
+	for (const sched::CpuInfo& info : topology.GetCpus()) {
+		CHECK(info.Sibling == (info.Cpu < 8 ? 0 : 1), "sibling rank wrong");
+	}
+
+	// spread: 8 distinct cores first, nodes take turns
+	std::vector<int> spread = topology.Place(10, sched::PLACEMENT_SPREAD);
+	std::set<int> cores;
+	for (int i = 0; i < 8; i++) {
+		const sched::CpuInfo& info = topology.GetCpus()[spread[i]];
+		CHECK(info.Sibling == 0, "spread took a sibling before all cores");
+		CHECK(info.Node == i % 2, "spread didn't alternate nodes");
+		cores.insert(info.Core);
+	}
+	CHECK(cores.size() == 8, "spread reused a core");
+	CHECK(spread[8] >= 8 && spread[9] >= 8, "spread should go to siblings last");
+
+	// compact: siblings together, node 0 first
+	std::vector<int> compact = topology.Place(4, sched::PLACEMENT_COMPACT);
+	CHECK(compact[0] == 0 && compact[1] == 8 && compact[2] == 1 && compact[3] == 9, "compact order wrong");
+
+	std::vector<int> none = topology.Place(3, sched::PLACEMENT_NONE);
+	CHECK(none.size() == 3 && none[0] == -1, "none should not pin");
+}
+
+void CheckPinnedWorkers() {
+	const sched::CpuTopology& topology = sched::CpuTopology::Get();
+	Log<LINFO>("cpus", topology.GetCpus().size(), "cores", topology.GetCoreNum(), "numa nodes", topology.GetNodeNum());
+	for (const sched::CpuInfo& info : topology.GetCpus()) {
+		Log<LINFO>("  cpu", info.Cpu, "core", info.Core, "sibling", info.Sibling, "package", info.Package, "node", info.Node);
+	}
+
+	int threads = (int)topology.GetCpus().size();
+	sched::ThreadWorker worker(threads, sched::SERVICE_WORK_STEALING, sched::PLACEMENT_SPREAD);
+	worker.Run();
+	std::vector<int> pinned = worker.GetWorkerCpus();
+	std::set<int> allowed(pinned.begin(), pinned.end());
+
+	// every task has to run on one of the pinned cpus
+	sched::ParallelScheduler sc(&worker);
+	std::atomic<int> done{ 0 };
+	std::atomic<int> outside{ 0 };
+	const int tasks = 1000;
+	for (int i = 0; i < tasks; i++) {
+		sc.PostPar([&]() {
+			int cpu = sched::CpuTopology::GetCurrentCpu();
+			if (cpu >= 0 && allowed.count(cpu) == 0) {
+				outside++;
+			}
+			done++;
+		});
+	}
+	while (done < tasks) {
+		std::this_thread::yield();
+	}
+	worker.Stop();
+	CHECK(outside == 0, "task ran off the pinned cpus");
+}
+
+}
+
+
+int main(int argc, char* argv[]) {
+	CheckPlacement();
+	CheckPinnedWorkers();
+	return 0;
+}